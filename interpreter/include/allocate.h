@@ -0,0 +1,56 @@
+#ifndef ALLOCATE_H
+#define ALLOCATE_H
+
+#ifdef FORTH_ENABLE_ALLOCATE
+
+#include <stdint.h>
+
+#include "forth.h"
+
+// Memory-Allocation word set: a segregated free-list allocator whose blocks
+// are carved from the top of forth_memory, moving forth_end down. Sizes are
+// powers of two from 16 bytes up; small classes are carved a slab at a time.
+// Freed blocks merge with their free buddies.
+
+#define HEAP_MIN_SHIFT 4      // Smallest block is 16 bytes
+#define HEAP_CLASSES 13       // 16 bytes .. 64KB
+#define HEAP_HEADER_SIZE 8    // Tag cell + requested size cell
+#define HEAP_SLAB_SIZE 512    // Slab carved at once for small classes
+#define HEAP_SLAB_MAX_CLASS 3 // Classes up to 128-byte blocks use slabs
+#define HEAP_SLAB_CLASS 5     // Class of a whole slab
+
+// ANS Forth throw codes used as iors
+#define IOR_ALLOCATE -59
+#define IOR_FREE -60
+#define IOR_RESIZE -61
+
+typedef struct {
+  // Throughput counters
+  uint32_t allocations;
+  uint32_t frees;
+  uint32_t resizes;
+  uint32_t failures;
+  uint32_t splits;
+  uint32_t merges;
+  uint32_t slabs;
+
+  // Space accounting (bytes)
+  uint32_t arena_bytes;      // Carved from forth_memory so far
+  uint32_t live_blocks;      // Blocks currently allocated
+  uint32_t block_bytes;      // Total size of allocated blocks
+  uint32_t requested_bytes;  // Total size the program asked for
+  uint32_t free_bytes;       // Total size of blocks on free lists
+} heap_stats_t;
+
+extern heap_stats_t heap_stats;
+
+// C interface (addresses are Forth addresses, 0 on failure)
+forth_addr_t heap_allocate(cell_t size);
+cell_t heap_free(forth_addr_t addr);
+forth_addr_t heap_resize(forth_addr_t addr, cell_t size, cell_t* ior);
+void heap_reset(void);
+
+void create_allocate_primitives(void);
+
+#endif  // FORTH_ENABLE_ALLOCATE
+#endif  // ALLOCATE_H
@@ -0,0 +1,134 @@
+#ifndef AOT_H
+#define AOT_H
+
+#ifdef FORTH_ENABLE_AOT
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "core.h"
+#include "dictionary.h"
+#include "double.h"
+#include "error.h"
+#include "floating.h"
+#include "forth.h"
+#include "memory.h"
+#include "stack.h"
+#include "structure.h"
+
+// Ahead-of-time Forth-to-C compiler for deployed applications.
+//
+// aot_write() walks the words defined after dictionary_init (the same token
+// walk SEE does) and writes one C translation unit: a function per colon
+// definition, with common primitives inlined as C statements, BRANCH and
+// 0BRANCH as gotos, DO LOOP on the return stack, and calls between user
+// definitions as direct C calls. Data space above the builtins is saved as
+// an image, so variables, CREATE data and the token lists come along.
+//
+// The output is compiled with the application (-O2) and linked against the
+// interpreter library; aot_install() copies the image back and points each
+// header at its compiled function. Like the JIT, a compiled definition
+// resumes the inner interpreter whenever a call leaves ctx->ip somewhere
+// unexpected (DOES>, return address tricks), so the token list stays the
+// reference semantics. DOES> code itself stays threaded.
+
+#define AOT_MAX_TOKENS 4096  // Longer definitions stay threaded
+
+// One user word header in the image, oldest first
+typedef struct {
+  forth_addr_t header;  // Header address in forth_memory
+  forth_addr_t link;    // Previous word's header (0 for none)
+  void (*cfunc)(context_t* ctx, word_t* self);
+} aot_word_t;
+
+// Everything aot_write() saved from the compiling system
+typedef struct {
+  forth_addr_t base;    // HERE after dictionary_init; must match at install
+  forth_addr_t here;    // HERE when the program was written
+  const byte_t* image;  // forth_memory[base, here)
+  const aot_word_t* words;
+  int word_count;
+  forth_addr_t entry;  // Header of the word to run, 0 for none
+} aot_program_t;
+
+// Write the user dictionary as C; entry may be NULL. false on failure.
+bool aot_write(context_t* ctx, FILE* out, word_t* entry);
+
+// Restore a program into a freshly initialized system. false on mismatch.
+bool aot_install(context_t* ctx, const aot_program_t* program);
+
+// Defined by the file kisforth-aot generates
+extern const aot_program_t aot_program;
+
+// Helpers used by the generated code. ds and sp are the data stack and its
+// depth held in a local; they are written back around every call.
+
+#define AOT_W(addr) ((word_t*)&forth_memory[addr])
+
+#define AOT_ENTER()                                                            \
+  cell_t* ds = ctx->data_stack;                                                \
+  cell_t* rs = ctx->return_stack;                                              \
+  int frame = ctx->return_stack_ptr;                                           \
+  return_push(ctx, (cell_t)ctx->ip);                                           \
+  int sp = ctx->data_stack_ptr;                                                \
+  (void)self;                                                                  \
+  (void)ds;                                                                    \
+  (void)rs;                                                                    \
+  (void)frame
+
+// Room for a template: min cells present, grow more cells free
+#define AOT_FITS(min, grow) (sp >= (min) && sp <= DATA_STACK_SIZE - (grow))
+
+// Call a word's cfunc with ip just past its token (and operands)
+#define AOT_INVOKE(xt, at)                                                     \
+  do {                                                                         \
+    ctx->data_stack_ptr = sp;                                                  \
+    ctx->ip = (at);                                                            \
+    AOT_W(xt)->cfunc(ctx, AOT_W(xt));                                          \
+    sp = ctx->data_stack_ptr;                                                  \
+  } while (0)
+
+// Same for another compiled definition, called directly
+#define AOT_INVOKE_FN(fn, xt, at)                                              \
+  do {                                                                         \
+    ctx->data_stack_ptr = sp;                                                  \
+    ctx->ip = (at);                                                            \
+    fn(ctx, AOT_W(xt));                                                        \
+    sp = ctx->data_stack_ptr;                                                  \
+  } while (0)
+
+// EXIT: pop the caller's ip (0 at the top level) and return
+#define AOT_EXIT()                                                             \
+  do {                                                                         \
+    ctx->data_stack_ptr = sp;                                                  \
+    ctx->ip = ctx->return_stack_ptr > 0                                        \
+                  ? (forth_addr_t)rs[--ctx->return_stack_ptr]                  \
+                  : 0;                                                         \
+    return;                                                                    \
+  } while (0)
+
+// Wrapping arithmetic and Forth flags
+#define AOT_ADD(a, b) ((cell_t)((ucell_t)(a) + (ucell_t)(b)))
+#define AOT_SUB(a, b) ((cell_t)((ucell_t)(a) - (ucell_t)(b)))
+#define AOT_MUL(a, b) ((cell_t)((ucell_t)(a) * (ucell_t)(b)))
+#define AOT_SHL(a, n) ((cell_t)((ucell_t)(a) << (n)))
+#define AOT_FLAG(c) ((c) ? -1 : 0)
+
+// Addresses @ ! C@ C! handle inline; anything else goes through the word
+#define AOT_CELL_OK(a) ((ucell_t)(a) <= FORTH_MEMORY_SIZE - sizeof(cell_t))
+#define AOT_BYTE_OK(a) ((ucell_t)(a) < FORTH_MEMORY_SIZE)
+
+static inline cell_t aot_fetch(cell_t addr) {
+  cell_t value;
+  memcpy(&value, &forth_memory[(ucell_t)addr], sizeof(value));
+  return value;
+}
+
+static inline void aot_store(cell_t addr, cell_t value) {
+  memcpy(&forth_memory[(ucell_t)addr], &value, sizeof(value));
+}
+
+#endif  // FORTH_ENABLE_AOT
+
+#endif  // AOT_H
@@ -0,0 +1,19 @@
+#ifndef ARRAY_H
+#define ARRAY_H
+
+#include "forth.h"
+
+// Cell-array kernels: whole-array operations on contiguous cells, validated
+// once per call. Arithmetic wraps modulo 2^32 exactly like a loop of @ and +.
+// Uses SSE2 where the compiler targets it, plain C everywhere else (Pico).
+
+cell_t cells_sum(const cell_t* a, ucell_t n);
+cell_t cells_min(const cell_t* a, ucell_t n);  // n must be nonzero
+cell_t cells_max(const cell_t* a, ucell_t n);  // n must be nonzero
+cell_t cells_dot(const cell_t* a, const cell_t* b, ucell_t n);
+void cells_scale(cell_t* a, ucell_t n, cell_t factor);
+void cells_prefix_sum(cell_t* a, ucell_t n);
+
+void create_array_primitives(void);
+
+#endif  // ARRAY_H
@@ -0,0 +1,18 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#include "forth.h"
+
+// Micro-benchmarks for the interpreter, built alongside the unit tests.
+// Each case runs untimed setup code, then times a Forth snippet, so native
+// words can be compared with the equivalent loops written in Forth.
+
+#ifdef FORTH_ENABLE_TESTS
+
+void run_all_benchmarks(void);
+
+void create_bench_primitives(void);
+
+#endif  // FORTH_ENABLE_TESTS
+
+#endif  // BENCH_H
@@ -3,14 +3,37 @@
 
 #include "forth.h"
 
-#define FORTH_PAD_SIZE 1024
-
 // Global memory
 extern cell_t* state_ptr;  // C pointer to STATE variable for efficiency
 extern cell_t* base_ptr;   // BASE variable pointer
 
 void f_constant_runtime(context_t* ctx, word_t* self);
 void f_value_runtime(context_t* ctx, word_t* self);
+void f_does_runtime(context_t* ctx, word_t* self);
+void f_does_inline_runtime(context_t* ctx, word_t* self);
+
+// DO loops keep two cells on the return stack: below, the limit plus
+// LOOP_BIAS; on top, the index minus that. The index reaches the limit
+// exactly when adding to the top cell overflows, and I is the sum of the
+// two cells.
+#define LOOP_BIAS 0x80000000u
+
+// (SWITCH) table: the operand CASE ... ENDCASE compiles when every OF tests
+// a literal. These header cells follow its length cell, then the targets.
+#define SWITCH_KIND 0     // SWITCH_DENSE or SWITCH_SORTED
+#define SWITCH_COUNT 1    // Number of targets
+#define SWITCH_LOW 2      // Value selecting the first target (dense)
+#define SWITCH_DEFAULT 3  // Where other values go, still on the stack
+#define SWITCH_HEADER 4
+
+#define SWITCH_DENSE 0   // Targets for LOW, LOW+1, ...; holes go to DEFAULT
+#define SWITCH_SORTED 1  // COUNT ascending values, then their targets
+
+#define SWITCH_MIN_CASES 4     // Fewer OF tests stay a chain of tests
+#define SWITCH_MAX_CASES 256   // More stay a chain too
+#define SWITCH_MAX_SPAN 1024   // Dense only if also at most half holes
+
+forth_addr_t data_field(word_t* word);  // Works for CREATE and DOES> words
 
 void create_primitives(void);
 void create_builtin_definitions(void);
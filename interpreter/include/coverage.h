@@ -0,0 +1,48 @@
+#ifndef COVERAGE_H
+#define COVERAGE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "forth.h"
+
+// Word-level code coverage for the test runner
+// Marks each executed word and each branch target reached by 0BRANCH/BRANCH
+// in a bitset with one bit per cell-aligned Forth address.
+
+#ifdef FORTH_ENABLE_TESTS
+
+#define COVERAGE_BITSET_SIZE (FORTH_MEMORY_SIZE / sizeof(cell_t) / 8)
+
+extern bool coverage_enabled;
+extern uint8_t coverage_bits[COVERAGE_BITSET_SIZE];
+
+// Set the bit for a cell-aligned Forth address
+static inline void coverage_mark(forth_addr_t addr) {
+  forth_addr_t cell = addr / sizeof(cell_t);
+  coverage_bits[cell >> 3] |= (uint8_t)(1u << (cell & 7));
+}
+
+// Mark addr if coverage is being collected (one predictable branch otherwise)
+#define coverage_hit(addr)                                     \
+  do {                                                         \
+    if (coverage_enabled && (addr) < FORTH_MEMORY_SIZE) {      \
+      coverage_mark(addr);                                     \
+    }                                                          \
+  } while (0)
+
+bool coverage_marked(forth_addr_t addr);
+void coverage_start(void);
+void coverage_stop(void);
+void coverage_forget(forth_addr_t addr);
+void coverage_report(context_t* ctx);
+
+void create_coverage_primitives(void);
+
+#else
+
+#define coverage_hit(addr) ((void)0)
+
+#endif  // FORTH_ENABLE_TESTS
+
+#endif  // COVERAGE_H
@@ -1,16 +1,23 @@
 #ifndef DICTIONARY_H
 #define DICTIONARY_H
 
+#include <stdbool.h>
+
 #include "forth.h"
 
 // Dictionary head - points to most recently defined word
 extern word_t* dictionary_head;
 
+// Most recent word created by dictionary_init (older words are builtins)
+extern word_t* builtin_dictionary_head;
+extern forth_addr_t builtin_here;  // HERE at the same point
+
 // Core dictionary management functions (currently in dictionary.c)
 void dictionary_init(void);
 void link_word(word_t* word);
 word_t* find_word(context_t* ctx, const char* name);
 word_t* search_word(const char* name);
+int case_insensitive_strcmp(const char* a, const char* b);
 void compile_word(context_t* ctx, word_t* word);
 void compile_cell(context_t* ctx, cell_t value);
 
@@ -22,13 +29,23 @@ void create_area_word(const char* name);
 word_t* create_immediate_primitive_word(const char* name,
                                         void (*cfunc)(context_t* ctx,
                                                       word_t* self));
+word_t* create_operand_primitive_word(const char* name,
+                                      void (*cfunc)(context_t* ctx,
+                                                    word_t* self),
+                                      uint32_t operand_flags);
 
 word_t* defining_word(context_t* ctx,
                       void (*cfunc)(context_t* ctx, word_t* self));
 void execute_word(context_t* ctx, word_t* word);
 void execute_colon(context_t* ctx, word_t* self);
+void execute_tokens(context_t* ctx, int frame);  // Inner interpreter loop
+bool is_colon_definition(word_t* word);
 forth_addr_t store_counted_string(context_t* ctx, const char* str, int length);
 
+// Compiled code walking (for tools that inspect definitions)
+forth_addr_t next_token(context_t* ctx, forth_addr_t ip);
+forth_addr_t definition_end(word_t* word);
+
 // Word execution semantics
 void f_address(context_t* ctx, word_t* self);  // Variable execution ( -- addr )
 void f_param_field(context_t* ctx,
@@ -0,0 +1,17 @@
+#ifndef DOUBLE_H
+#define DOUBLE_H
+
+#ifdef FORTH_ENABLE_DOUBLE
+
+// Double-Number word set. A double is two cells on the data stack, low cell
+// first and high cell on top; the primitives work on it as one int64_t.
+
+#include "forth.h"
+
+void f_2constant_runtime(context_t* ctx, word_t* self);  // 2CONSTANT words
+
+void create_double_primitives(void);
+
+#endif  // FORTH_ENABLE_DOUBLE
+
+#endif  // DOUBLE_H
@@ -6,6 +6,9 @@
 // Error reporting function
 void error(context_t* ctx, const char* format, ...);
 
+// Errors reported so far (batch tools check it after loading a file)
+extern unsigned error_count;
+
 // Forth ABORT word - clear data stack and restart
 void f_abort(context_t* ctx, word_t* self);
 
@@ -0,0 +1,28 @@
+#ifndef FLOAT_ARRAY_H
+#define FLOAT_ARRAY_H
+
+#ifdef FORTH_ENABLE_FLOATING
+
+#include "forth.h"
+
+// Float-array kernels: whole-array operations on contiguous doubles in data
+// space, validated once per call. Uses SSE2, or AVX when the CPU reports it
+// at startup; plain C everywhere else (Pico). Vector sums add in a different
+// order than a Forth loop would, so the last bits of FSUM and FDOT may differ.
+
+double floats_sum(const double* a, ucell_t n);
+double floats_dot(const double* a, const double* b, ucell_t n);
+void floats_scale(double* a, ucell_t n, double r);
+void floats_axpy(double r, const double* x, double* y, ucell_t n);
+void floats_add(const double* a, const double* b, double* c, ucell_t n);
+void floats_mul(const double* a, const double* b, double* c, ucell_t n);
+
+// C (m x p) = A (m x n) * B (n x p), all row-major; C must not overlap A or B
+void floats_matmul(const double* a, const double* b, double* c, ucell_t m,
+                   ucell_t n, ucell_t p);
+
+void create_float_array_primitives(void);
+
+#endif  // FORTH_ENABLE_FLOATING
+
+#endif  // FLOAT_ARRAY_H
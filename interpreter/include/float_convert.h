@@ -0,0 +1,41 @@
+#ifndef FLOAT_CONVERT_H
+#define FLOAT_CONVERT_H
+
+#ifdef FORTH_ENABLE_FLOATING
+
+#include <stdbool.h>
+#include <stddef.h>
+
+// Text <-> double conversion without going through printf or (usually)
+// strtod.
+//
+// Parsing reads the string once. Up to 19 significant digits with a small
+// exponent are converted exactly with one multiply or divide (Clinger's
+// fast path); anything else is handed to strtod.
+//
+// Output uses Grisu2: the shortest digit string that reads back as the same
+// double (in rare cases one digit longer than the shortest).
+
+#define FLOAT_MAX_DIGITS 17  // Enough digits for any double
+
+// Accepted syntax: [sign] digits [. digits] [exponent]
+// exponent: (E|e) [sign] digits, as in the text interpreter, where a '.' or
+// 'E' is required so integers stay integers. With literal_syntax false the
+// ANS >FLOAT rules apply instead: D/d also mark an exponent, the exponent
+// digits may be empty, a bare sign may start the exponent, and no '.' or 'E'
+// is needed.
+bool float_parse(const char* text, size_t length, bool literal_syntax,
+                 double* result);
+
+// Shortest digits of a finite value (sign ignored) without a decimal point.
+// The value is 0.<digits> * 10^*point. Zero gives "0" with *point = 1.
+// Returns the digit count (1..FLOAT_MAX_DIGITS); digits is not terminated.
+int float_shortest_digits(double value, char* digits, int* point);
+
+// Round a digit string to count digits (half up), padding with zeros.
+// A carry out of the first digit gives "1000..." and increments *point.
+void float_round_digits(char* digits, int length, int count, int* point);
+
+#endif  // FORTH_ENABLE_FLOATING
+
+#endif  // FLOAT_CONVERT_H
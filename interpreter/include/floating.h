@@ -7,23 +7,57 @@
 
 #include "forth.h"
 
-// Float stack
-#define FLOAT_STACK_SIZE 32
-extern double float_stack[FLOAT_STACK_SIZE];
-extern int float_stack_ptr;
+#define FLOAT_SIZE 8  // Bytes per float in data space (two cells)
 
 // Float stack operations
-void float_stack_init(void);
-void float_push(context_t* ctx, double value);
-double float_pop(context_t* ctx);
-double float_peek(context_t* ctx);
-int float_depth(context_t* ctx);
+// Each context owns its float stack (context_t.float_stack), so FP code in a
+// timer handler never disturbs the main context. The checks are inline; only
+// the error report is out of line.
+void float_stack_error(context_t* ctx, const char* problem);
+
+static inline void float_push(context_t* ctx, double value) {
+  if (ctx->float_stack_ptr >= FLOAT_STACK_SIZE) {
+    float_stack_error(ctx, "overflow");
+    return;
+  }
+  ctx->float_stack[ctx->float_stack_ptr++] = value;
+}
+
+static inline double float_pop(context_t* ctx) {
+  if (ctx->float_stack_ptr <= 0) {
+    float_stack_error(ctx, "underflow");
+    return 0.0;
+  }
+  return ctx->float_stack[--ctx->float_stack_ptr];
+}
+
+static inline double float_peek(context_t* ctx) {
+  if (ctx->float_stack_ptr <= 0) {
+    float_stack_error(ctx, "underflow");
+    return 0.0;
+  }
+  return ctx->float_stack[ctx->float_stack_ptr - 1];
+}
+
+static inline int float_depth(context_t* ctx) { return ctx->float_stack_ptr; }
 
 void compile_float_literal(context_t* ctx, double value);
+void f_fconstant_runtime(context_t* ctx, word_t* self);  // FCONSTANT words
 
 // Float parsing
 bool try_parse_float(const char* token, double* result);
 
+// Float display: F., FS. and FE. print this text and a space
+typedef enum {
+  FLOAT_FIXED,
+  FLOAT_SCIENTIFIC,
+  FLOAT_ENGINEERING
+} float_style_t;
+
+#define FLOAT_FORMAT_SIZE 64
+void float_format(double value, float_style_t style,
+                  char out[FLOAT_FORMAT_SIZE]);
+
 // Initialization functions
 void create_floating_primitives(void);
 void create_floating_definitions(void);
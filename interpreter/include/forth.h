@@ -16,11 +16,24 @@ typedef uint32_t forth_addr_t;  // Forth address (always 32-bit)
 #define PAD_SIZE 1024
 #define WORD_BUFFER_SIZE 33
 #define PICTURED_BUFFER_SIZE 70
+#define FOLD_DEPTH 8  // Trailing literals constant folding remembers (text.c)
+#ifndef CONTROL_STACK_SIZE
+#define CONTROL_STACK_SIZE 64  // Override with -DCONTROL_STACK_SIZE=n
+#endif
 
 #ifdef FORTH_ENABLE_FLOATING
-#define FLOAT_STACK_SIZE 32
+#ifndef FLOAT_STACK_SIZE
+#define FLOAT_STACK_SIZE 32  // Override with -DFLOAT_STACK_SIZE=n
+#endif
 #endif
 
+// Control structure left open by the definition being compiled (core.c)
+typedef struct {
+  int kind;            // What opened it: IF, BEGIN, DO, CASE or OF
+  forth_addr_t addr;   // Branch operand to resolve, or target to branch back to
+  forth_addr_t chain;  // Last LEAVE or ENDOF operand; each holds the one before
+} control_entry_t;
+
 // Execution context structure
 typedef struct context {
   // Execution state
@@ -31,6 +44,19 @@ typedef struct context {
   cell_t return_stack[RETURN_STACK_SIZE];
   int data_stack_ptr;
   int return_stack_ptr;
+#ifdef FORTH_ENABLE_LOCALS
+  int locals_frame;  // Return stack index of local 0 (see locals.c)
+#endif
+
+  // Control-flow stack (per-context), used while compiling
+  control_entry_t control_stack[CONTROL_STACK_SIZE];
+  int control_stack_ptr;
+
+  // Literals just compiled that the next word may fold (per-context)
+  forth_addr_t fold_pending[FOLD_DEPTH];  // Where each LIT of the run is
+  int fold_pending_count;
+  forth_addr_t fold_pending_end;  // HERE just after the run
+  forth_addr_t fold_barrier;      // Literals before this can't fold
 
 #ifdef FORTH_ENABLE_FLOATING
   // Floating point stack (per-context)
@@ -38,10 +64,11 @@ typedef struct context {
   int float_stack_ptr;
 #endif
 
-  // Transient regions (per-context)
+  // Transient regions (per-context), contiguous and in address order
   byte_t pad_buffer[PAD_SIZE];
   byte_t word_buffer[WORD_BUFFER_SIZE];
   byte_t pictured_buffer[PICTURED_BUFFER_SIZE];
+  cell_t hold_index;  // Start of the pictured string, which grows down
 
   // Input parsing state (per-context)
   const char* source_buffer;
@@ -58,6 +85,10 @@ typedef struct word {
   struct word* link;  // Link to previous word (C pointer)
   char name[32];      // Word name (31 chars max per standard)
   uint32_t flags;     // Immediate flag, etc.
+  // Stack effect of a WORD_FLAG_VERIFIED definition (verify.c)
+  uint8_t stack_in;    // Cells taken
+  uint8_t stack_out;   // Cells left
+  uint8_t stack_peak;  // Most cells held above the entry depth
   void (*cfunc)(context_t* ctx,
                 struct word* self);  // C function for ALL word types
   // DUAL-PURPOSE PARAMETER FIELD:
@@ -68,23 +99,48 @@ typedef struct word {
     forth_addr_t address;  // Colon definitions, CREATE words point to data
   } param;
   uint8_t param_type;  // PARAM_VALUE, PARAM_ADDRESS
+#ifdef FORTH_ENABLE_JIT
+  uint16_t jit_calls;  // Threaded calls so far (JIT_THRESHOLD)
+#endif
 } word_t;
 
 #define PARAM_VALUE 1    // param.value contains the actual value (variables)
 #define PARAM_ADDRESS 2  // param.address points to data space (definitions)
+#define PARAM_DOES 3     // param.address is DOES> code, data follows the header
 
 // Word flags
 #define WORD_FLAG_IMMEDIATE 0x01
 
+// Inline operands compiled after a token (lets tools walk a definition)
+#define WORD_FLAG_OPERAND_CELL 0x02    // One inline cell (LIT, (TO), ...)
+#define WORD_FLAG_OPERAND_FLOAT 0x04   // Two inline cells holding a double
+#define WORD_FLAG_OPERAND_STRING 0x08  // Length cell plus aligned characters
+#define WORD_FLAG_BRANCH 0x10          // The inline cell is a branch target
+
+// Inlining of colon definitions into their callers (compile_inline)
+#define WORD_FLAG_INLINE 0x20    // Inline even above INLINE_MAX_TOKENS
+#define WORD_FLAG_NOINLINE 0x40  // Always compile a call
+
+#define WORD_FLAG_VERIFIED 0x80  // Stack effect known, runs unchecked
+#define WORD_FLAG_RETURN_STACK 0x100  // Uses its caller's return frames
+
 // Forth virtual memory size (could be redefined elsewhere)
 #ifndef FORTH_MEMORY_SIZE
 #define FORTH_MEMORY_SIZE (64 * 1024)  // 64KB virtual memory (default)
 #endif
 
+// Forth addresses of the transient regions, just past main memory. They
+// mirror the context layout, so translation is one subtract and compare.
+#define PAD_ADDR FORTH_MEMORY_SIZE
+#define WORD_BUFFER_ADDR (PAD_ADDR + PAD_SIZE)
+#define PICTURED_BUFFER_ADDR (WORD_BUFFER_ADDR + WORD_BUFFER_SIZE)
+#define TRANSIENT_SIZE (PAD_SIZE + WORD_BUFFER_SIZE + PICTURED_BUFFER_SIZE)
+
 extern context_t main_context;
 
 // Context management functions
 void context_init(context_t* ctx, const char* name, bool is_interrupt_handler);
 void* addr_to_ptr(context_t* ctx, forth_addr_t addr);
+void* addr_range_to_ptr(context_t* ctx, forth_addr_t addr, ucell_t size);
 
 #endif  // CONTEXT_H
\ No newline at end of file
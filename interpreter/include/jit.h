@@ -0,0 +1,51 @@
+#ifndef JIT_H
+#define JIT_H
+
+#ifdef FORTH_ENABLE_JIT
+
+#include <stdbool.h>
+
+#include "forth.h"
+
+// Template JIT for colon definitions (x86-64 System V only).
+//
+// A compiled definition becomes one native function with the same signature
+// as any cfunc, so callers need no changes. Common primitives (stack shuffles,
+// arithmetic, comparisons, @ !, >R R>, DO LOOP and the branches) are stitched
+// in as inline templates; every other token is a native call to the word's
+// cfunc, bound when the definition is compiled. The data stack depth lives in
+// a register between calls and the cells stay in the context, so a call
+// costs one store and one reload.
+//
+// With JIT_SUBROUTINE_THREADED (ENABLE_STC) only LIT, DUP, DROP and + are
+// inlined, along with EXIT and the branches: subroutine-threaded code, one
+// call and return per token, which the return stack predictor follows.
+//
+// The token list is kept as-is, so SEE, FIND and the coverage tools see an
+// ordinary colon definition. Native code falls back to the threaded form
+// whenever it can't follow along: a call that leaves ctx->ip somewhere
+// unexpected (DOES>, return address tricks) resumes the inner interpreter
+// at that ip, and while coverage is being collected the whole definition
+// runs threaded.
+
+#ifndef JIT_THRESHOLD
+#define JIT_THRESHOLD 0  // Calls before compiling; 0 compiles at ;
+#endif
+
+#ifndef JIT_CODE_SIZE
+#define JIT_CODE_SIZE (1024 * 1024)  // Executable bytes, reset with the system
+#endif
+
+#define JIT_MAX_TOKENS 512  // Longer definitions stay threaded
+
+void jit_reset(void);  // Drop all native code (dictionary_init starts over)
+void jit_init(void);   // Builtins exist: resolve templates, compile them
+bool jit_compile(word_t* word);  // false leaves the word threaded
+bool jit_compiled(word_t* word);
+
+// Words with an inline template; the text interpreter keeps calls to them
+bool jit_has_template(const char* name);
+
+#endif  // FORTH_ENABLE_JIT
+
+#endif  // JIT_H
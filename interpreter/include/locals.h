@@ -0,0 +1,29 @@
+#ifndef LOCALS_H
+#define LOCALS_H
+
+#ifdef FORTH_ENABLE_LOCALS
+
+#include <stdbool.h>
+
+#include "forth.h"
+
+// Locals word set: {: ... :} and LOCALS|. A definition's locals live in a
+// frame on the return stack, entered by (LOCALS) and dropped by (UNLOCALS)
+// before every exit. Each local compiles to one (LOCAL@n) or (LOCAL!n)
+// token with the slot number in the word itself, so access takes no
+// inline operand.
+
+#define MAX_LOCALS 16
+
+// Compile-time hooks for the text interpreter, ; EXIT DOES> and TO
+bool compile_local(context_t* ctx, const char* name);  // false if not a local
+bool compile_local_store(context_t* ctx, const char* name);
+bool locals_active(void);
+void end_locals(context_t* ctx);  // Compile (UNLOCALS) if there are locals
+void forget_locals(void);         // New definition, or compilation aborted
+
+void create_locals_primitives(void);
+
+#endif  // FORTH_ENABLE_LOCALS
+
+#endif  // LOCALS_H
@@ -18,6 +18,7 @@ extern forth_addr_t input_length_addr;
 
 // Memory management functions
 forth_addr_t forth_allot(context_t* ctx, size_t bytes);
+bool forth_room(context_t* ctx, size_t bytes);
 void forth_align(void);
 forth_addr_t ptr_to_addr(context_t* ctx, word_t* word);
 uintptr_t align_up(uintptr_t addr, size_t alignment);
@@ -25,6 +26,22 @@ forth_addr_t forth_allot_high(context_t* ctx, size_t bytes);
 void forth_reset_high_memory(void);
 void forth_align_down(forth_addr_t* addr);
 
+// Translate [addr, addr+size) to a pointer without reporting errors: main
+// memory, or the transient regions of ctx. NULL if the span is not entirely
+// inside one of the two. addr_range_to_ptr() is the checked version.
+static inline byte_t* forth_span_ptr(context_t* ctx, forth_addr_t addr,
+                                     ucell_t size) {
+  if (addr < FORTH_MEMORY_SIZE) {
+    return size <= FORTH_MEMORY_SIZE - addr ? &forth_memory[addr] : NULL;
+  }
+
+  forth_addr_t offset = addr - PAD_ADDR;
+  if (offset < TRANSIENT_SIZE && size <= TRANSIENT_SIZE - offset) {
+    return (byte_t*)ctx + offsetof(context_t, pad_buffer) + offset;
+  }
+  return NULL;
+}
+
 // Memory access functions
 void forth_store(context_t* ctx, forth_addr_t addr, cell_t value);    // !
 cell_t forth_fetch(context_t* ctx, forth_addr_t addr);                // @
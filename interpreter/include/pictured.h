@@ -0,0 +1,11 @@
+#ifndef PICTURED_H
+#define PICTURED_H
+
+// Pictured numeric output: <# # #S #> HOLD HOLDS SIGN, plus U. .R U.R.
+// The string is built right to left in the context's pictured buffer, so
+// each context (REPL, interrupt handler) formats independently. #S emits two
+// decimal digits per division.
+
+void create_pictured_primitives(void);
+
+#endif  // PICTURED_H
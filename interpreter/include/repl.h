@@ -5,6 +5,7 @@
 
 // Main REPL system
 void repl(void);
+bool repl_execute(context_t* ctx, word_t* word);  // false if ended early
 
 // REPL control primitives
 void f_quit(context_t* ctx, word_t* self);  // QUIT ( -- ) Restart REPL loop
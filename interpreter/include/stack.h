@@ -11,6 +11,10 @@ cell_t data_peek_at(context_t* ctx,
                     int offset);  // Peek at stack[depth-1-offset]
 int data_depth(context_t* ctx);
 
+// Double-cell values: low cell pushed first, high cell on top
+void data_push_double(context_t* ctx, int64_t value);
+int64_t data_pop_double(context_t* ctx);
+
 // Return stack operations
 void return_push(context_t* ctx, cell_t value);
 cell_t return_pop(context_t* ctx);
@@ -0,0 +1,14 @@
+#ifndef STRING_WORDS_H
+#define STRING_WORDS_H
+
+#ifdef FORTH_ENABLE_STRING
+
+// String word set: COMPARE, SEARCH, -TRAILING, /STRING, BLANK, SLITERAL.
+// Byte scans use SSE2, or AVX2 when the CPU reports it at startup; other
+// targets (Pico) use plain C.
+
+void create_string_primitives(void);
+
+#endif  // FORTH_ENABLE_STRING
+
+#endif  // STRING_WORDS_H
@@ -0,0 +1,16 @@
+#ifndef STRUCTURE_H
+#define STRUCTURE_H
+
+#include "forth.h"
+
+// Forth-200x structures: BEGIN-STRUCTURE, +FIELD, FIELD:, CFIELD:,
+// END-STRUCTURE. A field word adds its offset to an address. When compiled,
+// the offset is folded into one (+FIELD) token, or nothing for offset 0, so
+// record access costs no nested call.
+
+void f_field_runtime(context_t* ctx, word_t* self);
+void compile_field(context_t* ctx, word_t* field);
+
+void create_structure_primitives(void);
+
+#endif  // STRUCTURE_H
@@ -16,7 +16,9 @@ void set_current_to_in(context_t* ctx, cell_t value);
 void skip_spaces(context_t* ctx);
 char* parse_name(context_t* ctx, char* dest, size_t max_len);
 int parse_string(context_t* ctx, char quote_char, char* dest, size_t max_len);
-bool try_parse_number(const char* token, cell_t* result);
+
+typedef enum { NUMBER_NONE, NUMBER_SINGLE, NUMBER_DOUBLE } number_kind_t;
+number_kind_t parse_number(const char* token, int64_t* result);
 
 // Text interpreter (ANS Forth compliant)
 void interpret(context_t* ctx);
@@ -26,6 +28,28 @@ void interpret_text(context_t* ctx, const char* text);
 void compile_token(context_t* ctx, forth_addr_t token);
 void compile_literal(context_t* ctx, cell_t value);
 
+// Constant folding: a pure word compiled right after enough literals runs
+// at compile time, and its results replace the literals and the call
+// (FOLD_DEPTH, and the run of literals itself, are in context_t)
+#define FOLD_NESTING 4  // Colon definitions looked into for purity
+
+bool compile_folded(context_t* ctx, word_t* word);
+
+// Inlining: a call to a short straight-line colon definition compiles its
+// body instead, saving the nest and EXIT. Words marked INLINE may be longer.
+#define INLINE_MAX_TOKENS 3     // Longest body inlined without INLINE
+#define INLINE_LIMIT_TOKENS 16  // Longest body INLINE accepts
+
+forth_addr_t inline_body_end(context_t* ctx, word_t* word, int max_tokens);
+bool compile_inline(context_t* ctx, word_t* word);
+
+// Called by ; before its EXIT: a trailing call to a threaded colon
+// definition becomes a jump, so tail recursion runs in constant return
+// stack space. A callee that reaches under its own return frame (R> and
+// such, directly or through the words it calls) keeps its call, since a
+// jump would leave it one frame short.
+void compile_tail_call(context_t* ctx, word_t* word);
+
 // Test accessor functions (for unit tests)
 cell_t get_current_to_in(context_t* ctx);
 cell_t get_current_input_length(context_t* ctx);
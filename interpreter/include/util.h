@@ -1,13 +1,19 @@
 #ifndef UTIL_H
 #define UTIL_H
 
+#include <stddef.h>
+
 #include "forth.h"
 
 // Character/digit conversion utilities
 char digit_to_char(int digit);
 int char_to_digit(char c, int base);
+size_t accumulate_digits(const char* text, size_t length, unsigned base,
+                         uint64_t* value, bool* overflow);
 
 // Number formatting
+char* format_unsigned(uint64_t value, unsigned base, char* end);
 void print_number_in_base(cell_t value, cell_t base);
+void print_double_in_base(int64_t value, cell_t base);
 
 #endif  // UTIL_H
\ No newline at end of file
@@ -0,0 +1,37 @@
+#ifndef VERIFY_H
+#define VERIFY_H
+
+#include <stdbool.h>
+
+#include "forth.h"
+
+// Static stack effects for colon definitions.
+//
+// At ; the new body is walked along every path with the data stack depth
+// relative to entry. A definition passes when each token's effect is known
+// (a builtin from the effects table, a constant or variable, or a colon
+// definition that passed itself), the paths agree on the depth wherever they
+// meet, and it leaves the return stack as it found it. The word is then
+// marked WORD_FLAG_VERIFIED with the cells it takes (stack_in), the cells it
+// leaves (stack_out) and the most it ever holds above its entry depth
+// (stack_peak).
+//
+// execute_colon() checks the entry depth of a verified word once against
+// stack_in and stack_peak, and then runs the body with the common primitives
+// done in place, without the per-operation underflow and overflow checks.
+// Anything else, and any call whose entry depth falls short, runs the usual
+// checked path, so errors read exactly as before.
+
+#define VERIFY_MAX_TOKENS 512  // Longer definitions stay unverified
+
+void verify_init(void);  // Builtins exist: find the primitives run in place
+
+// Infer the stack effect of word, just finished by ;. false leaves it
+// unverified.
+bool verify_definition(context_t* ctx, word_t* word);
+
+// Run a verified word's body from ctx->ip until its frame is popped. false,
+// having done nothing, if the entry depth doesn't allow it.
+bool execute_verified(context_t* ctx, word_t* word, int frame);
+
+#endif  // VERIFY_H
@@ -0,0 +1,356 @@
+#include "allocate.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include "debug.h"
+#include "dictionary.h"
+#include "memory.h"
+#include "stack.h"
+
+#ifdef FORTH_ENABLE_ALLOCATE
+
+/*
+ * Heap layout
+ * ===========
+ * Every block is a power of two in size and starts with a two-cell header:
+ *   [tag | class] [requested size] [payload ...]
+ * The tag tells used blocks from free ones, so FREE and RESIZE can reject
+ * addresses that were never returned by ALLOCATE (or were already freed).
+ * A free block keeps the next free block of its class in its second cell.
+ *
+ * Blocks are aligned to their own size, so a block's buddy (the other half
+ * of the block it was split from) is at its address XOR its size. FREE
+ * merges a block with its buddy while that is free too, so space freed in
+ * small blocks can be handed out again as a large one. Free blocks at the
+ * bottom of the heap go back to the dictionary, raising forth_end.
+ */
+#define HEAP_TAG_USED 0xA1100000u
+#define HEAP_TAG_FREE 0xF4EE0000u
+#define HEAP_TAG_MASK 0xFFFF0000u
+#define HEAP_ALIGN 8
+
+heap_stats_t heap_stats;
+
+// Free list heads per size class (0 = empty; the heap never reaches address 0)
+static forth_addr_t free_lists[HEAP_CLASSES];
+
+static inline ucell_t class_size(int class_index) {
+  return (ucell_t)1 << (class_index + HEAP_MIN_SHIFT);
+}
+
+static inline ucell_t* heap_cell(forth_addr_t addr) {
+  return (ucell_t*)&forth_memory[addr];
+}
+
+// Smallest class whose payload holds size bytes, or -1 if none does
+static int size_to_class(cell_t size) {
+  for (int c = 0; c < HEAP_CLASSES; c++) {
+    if ((ucell_t)size <= class_size(c) - HEAP_HEADER_SIZE) return c;
+  }
+  return -1;
+}
+
+static void push_free(forth_addr_t block, int class_index) {
+  heap_cell(block)[0] = HEAP_TAG_FREE | (ucell_t)class_index;
+  heap_cell(block)[1] = free_lists[class_index];
+  free_lists[class_index] = block;
+  heap_stats.free_bytes += class_size(class_index);
+}
+
+// Take block off its class's free list; false if it isn't on it
+static bool unlink_free(forth_addr_t block, int class_index) {
+  forth_addr_t prev = 0;
+  for (forth_addr_t current = free_lists[class_index]; current != 0;
+       prev = current, current = heap_cell(current)[1]) {
+    if (current != block) continue;
+    if (prev != 0) {
+      heap_cell(prev)[1] = heap_cell(current)[1];
+    } else {
+      free_lists[class_index] = heap_cell(current)[1];
+    }
+    heap_stats.free_bytes -= class_size(class_index);
+    return true;
+  }
+  return false;
+}
+
+static forth_addr_t pop_free(int class_index) {
+  forth_addr_t block = free_lists[class_index];
+  if (block != 0) {
+    free_lists[class_index] = heap_cell(block)[1];
+    heap_stats.free_bytes -= class_size(class_index);
+  }
+  return block;
+}
+
+// Free [low, high) as the largest aligned blocks that fit
+static void free_range(forth_addr_t low, forth_addr_t high) {
+  while (high - low >= class_size(0)) {
+    int c = 0;
+    while (c + 1 < HEAP_CLASSES && low % class_size(c + 1) == 0 &&
+           low + class_size(c + 1) <= high) {
+      c++;
+    }
+    push_free(low, c);
+    low += class_size(c);
+  }
+}
+
+// Take an aligned block of bytes (a power of two) from the top of the
+// dictionary gap (below forth_end); what aligning it skips is freed
+static forth_addr_t carve(ucell_t bytes) {
+  if (bytes > forth_end) return 0;
+
+  forth_addr_t new_end = (forth_end - bytes) & ~(forth_addr_t)(bytes - 1);
+  if (new_end < here) return 0;
+
+  forth_addr_t old_end = forth_end;
+  forth_end = new_end;
+  heap_stats.arena_bytes += old_end - new_end;
+  free_range(new_end + bytes, old_end);
+  return new_end;
+}
+
+// Give free blocks at forth_end back to the dictionary, and any that doing
+// so brings to the edge
+static void release_edge(void) {
+  while (forth_end < FORTH_MEMORY_SIZE) {
+    ucell_t tag = heap_cell(forth_end)[0];
+    int c = (int)(tag & ~HEAP_TAG_MASK);
+    if ((tag & HEAP_TAG_MASK) != HEAP_TAG_FREE || c >= HEAP_CLASSES ||
+        !unlink_free(forth_end, c)) {
+      break;
+    }
+    forth_end += class_size(c);
+    heap_stats.arena_bytes -= class_size(c);
+  }
+}
+
+// Split the smallest larger free block, halving down to this class
+static bool split_larger(int class_index) {
+  for (int c = class_index + 1; c < HEAP_CLASSES; c++) {
+    forth_addr_t block = pop_free(c);
+    if (block == 0) continue;
+
+    while (c > class_index) {
+      c--;
+      push_free(block + class_size(c), c);  // Upper half stays free
+      heap_stats.splits++;
+    }
+    push_free(block, class_index);
+    return true;
+  }
+
+  return false;
+}
+
+// Refill an empty class: split a larger free block, else carve new space
+static bool refill(int class_index) {
+  if (split_larger(class_index)) return true;
+
+  // Small classes carve a whole slab, split like any larger block
+  if (class_index <= HEAP_SLAB_MAX_CLASS) {
+    forth_addr_t slab = carve(HEAP_SLAB_SIZE);
+    if (slab != 0) {
+      push_free(slab, HEAP_SLAB_CLASS);
+      heap_stats.slabs++;
+      return split_larger(class_index);
+    }
+  }
+
+  forth_addr_t block = carve(class_size(class_index));
+  if (block == 0) return false;
+
+  push_free(block, class_index);
+  return true;
+}
+
+// Validate a payload address; returns its block address or 0
+static forth_addr_t used_block(forth_addr_t addr) {
+  if (addr < forth_end + HEAP_HEADER_SIZE || addr >= FORTH_MEMORY_SIZE ||
+      addr % HEAP_ALIGN != 0) {
+    return 0;
+  }
+
+  forth_addr_t block = addr - HEAP_HEADER_SIZE;
+  ucell_t tag = heap_cell(block)[0];
+  if ((tag & HEAP_TAG_MASK) != HEAP_TAG_USED ||
+      (tag & ~HEAP_TAG_MASK) >= HEAP_CLASSES) {
+    return 0;
+  }
+
+  return block;
+}
+
+// Allocate size bytes; returns the payload address or 0 if out of memory
+forth_addr_t heap_allocate(cell_t size) {
+  int class_index = size < 0 ? -1 : size_to_class(size);
+
+  if (class_index < 0 ||
+      (free_lists[class_index] == 0 && !refill(class_index))) {
+    heap_stats.failures++;
+    return 0;
+  }
+
+  forth_addr_t block = pop_free(class_index);
+  heap_cell(block)[0] = HEAP_TAG_USED | (ucell_t)class_index;
+  heap_cell(block)[1] = (ucell_t)size;
+
+  heap_stats.allocations++;
+  heap_stats.live_blocks++;
+  heap_stats.block_bytes += class_size(class_index);
+  heap_stats.requested_bytes += (ucell_t)size;
+
+  debug("ALLOCATE %d bytes: class %d block at %u", size, class_index, block);
+  return block + HEAP_HEADER_SIZE;
+}
+
+// Release a block; returns 0 or IOR_FREE for an invalid address
+cell_t heap_free(forth_addr_t addr) {
+  forth_addr_t block = used_block(addr);
+  if (block == 0) {
+    heap_stats.failures++;
+    return IOR_FREE;
+  }
+
+  int class_index = (int)(heap_cell(block)[0] & ~HEAP_TAG_MASK);
+
+  heap_stats.frees++;
+  heap_stats.live_blocks--;
+  heap_stats.block_bytes -= class_size(class_index);
+  heap_stats.requested_bytes -= heap_cell(block)[1];
+
+  // Merge with the buddy while it is free, above the dictionary and whole
+  while (class_index + 1 < HEAP_CLASSES) {
+    forth_addr_t buddy = block ^ class_size(class_index);
+    if (buddy < forth_end ||
+        buddy + class_size(class_index) > FORTH_MEMORY_SIZE ||
+        heap_cell(buddy)[0] != (HEAP_TAG_FREE | (ucell_t)class_index) ||
+        !unlink_free(buddy, class_index)) {
+      break;
+    }
+    if (buddy < block) block = buddy;
+    class_index++;
+    heap_stats.merges++;
+  }
+
+  push_free(block, class_index);
+  release_edge();
+
+  debug("FREE block at %u (class %d)", block, class_index);
+  return 0;
+}
+
+// Resize a block in place when it fits its class, otherwise move it.
+// On failure the original block is untouched and returned.
+forth_addr_t heap_resize(forth_addr_t addr, cell_t size, cell_t* ior) {
+  forth_addr_t block = used_block(addr);
+  if (block == 0 || size < 0) {
+    heap_stats.failures++;
+    *ior = IOR_RESIZE;
+    return addr;
+  }
+
+  int class_index = (int)(heap_cell(block)[0] & ~HEAP_TAG_MASK);
+  ucell_t old_size = heap_cell(block)[1];
+
+  heap_stats.resizes++;
+  *ior = 0;
+
+  if ((ucell_t)size <= class_size(class_index) - HEAP_HEADER_SIZE) {
+    heap_cell(block)[1] = (ucell_t)size;
+    heap_stats.requested_bytes += (ucell_t)size - old_size;
+    return addr;
+  }
+
+  forth_addr_t new_addr = heap_allocate(size);
+  if (new_addr == 0) {
+    *ior = IOR_RESIZE;
+    return addr;
+  }
+
+  memcpy(&forth_memory[new_addr], &forth_memory[addr], old_size);
+  heap_free(addr);
+
+  // The move is one resize, not an extra allocate/free pair
+  heap_stats.allocations--;
+  heap_stats.frees--;
+
+  return new_addr;
+}
+
+// Forget every block (memory above forth_end is reclaimed by the caller)
+void heap_reset(void) {
+  memset(free_lists, 0, sizeof(free_lists));
+  memset(&heap_stats, 0, sizeof(heap_stats));
+}
+
+// ALLOCATE ( u -- a-addr ior )
+static void f_allocate(context_t* ctx, word_t* self) {
+  (void)self;
+
+  cell_t size = data_pop(ctx);
+  forth_addr_t addr = heap_allocate(size);
+
+  data_push(ctx, (cell_t)addr);
+  data_push(ctx, addr ? 0 : IOR_ALLOCATE);
+}
+
+// FREE ( a-addr -- ior )
+static void f_free(context_t* ctx, word_t* self) {
+  (void)self;
+
+  forth_addr_t addr = (forth_addr_t)data_pop(ctx);
+  data_push(ctx, heap_free(addr));
+}
+
+// RESIZE ( a-addr1 u -- a-addr2 ior )
+static void f_resize(context_t* ctx, word_t* self) {
+  (void)self;
+
+  cell_t size = data_pop(ctx);
+  forth_addr_t addr = (forth_addr_t)data_pop(ctx);
+  cell_t ior;
+
+  data_push(ctx, (cell_t)heap_resize(addr, size, &ior));
+  data_push(ctx, ior);
+}
+
+// HEAP-STATS ( -- ) Display allocator throughput and fragmentation
+static void f_heap_stats(context_t* ctx, word_t* self) {
+  (void)ctx;
+  (void)self;
+
+  heap_stats_t* s = &heap_stats;
+
+  printf("\nHeap: %u bytes carved, %u bytes left above HERE\n",
+         s->arena_bytes, forth_end - here);
+  printf("  Operations: %u allocate, %u free, %u resize, %u failed\n",
+         s->allocations, s->frees, s->resizes, s->failures);
+  printf("  Blocks: %u live (%u bytes), %u splits, %u merges, %u slabs\n",
+         s->live_blocks, s->block_bytes, s->splits, s->merges, s->slabs);
+
+  // Internal: block space not asked for; external: carved space sitting free
+  unsigned internal =
+      s->block_bytes ? 100u * (s->block_bytes - s->requested_bytes) /
+                           s->block_bytes
+                     : 0;
+  unsigned external =
+      s->arena_bytes ? 100u * s->free_bytes / s->arena_bytes : 0;
+  printf("  Fragmentation: %u%% internal, %u%% external (%u bytes free)\n",
+         internal, external, s->free_bytes);
+
+  fflush(stdout);
+}
+
+void create_allocate_primitives(void) {
+  create_primitive_word("ALLOCATE", f_allocate);
+  create_primitive_word("FREE", f_free);
+  create_primitive_word("RESIZE", f_resize);
+  create_primitive_word("HEAP-STATS", f_heap_stats);
+
+  debug("Memory-Allocation primitives created");
+}
+
+#endif  // FORTH_ENABLE_ALLOCATE
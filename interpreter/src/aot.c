@@ -0,0 +1,665 @@
+#include "aot.h"
+
+#include <inttypes.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "debug.h"
+
+#ifdef FORTH_ENABLE_AOT
+
+/*
+ * Generated functions
+ * ===================
+ * Each colon definition becomes
+ *
+ *   static void aot_XXXX(context_t* ctx, word_t* self)
+ *
+ * named after its header address. AOT_ENTER pushes the caller's ip as
+ * execute_colon() does and caches the data stack depth in sp. Tokens are
+ * written in order, each under a comment naming the word:
+ *
+ *   - templates are C statements on ds[] and sp, guarded by depth (and
+ *     return depth or address) checks; a failed guard calls the real word,
+ *     so errors read exactly as in threaded code
+ *   - other words are called through their cfunc, or directly for compiled
+ *     user definitions, with ctx->ip just past the token; afterwards ip must
+ *     be on the next token (or a branch target), otherwise the rest of the
+ *     body runs in execute_tokens() from the deopt label
+ *   - BRANCH, 0BRANCH and (LOOP) are gotos to labels on landing tokens
+ *   - the (SWITCH) table CASE compiles becomes a C switch on the top cell
+ *   - (TAIL) calls a compiled callee directly, as if the call were followed
+ *     by the EXIT it replaced
+ *   - constants, variables and CREATE words push their value or address as
+ *     a literal
+ */
+
+typedef enum {
+  OP_CALL,  // No template: call the word
+  OP_LIT,
+  OP_EXIT,
+  OP_BRANCH,
+  OP_0BRANCH,
+  OP_LOOP,
+  OP_TAIL,    // Tail call compiled by ;
+  OP_SWITCH,  // CASE dispatch table
+  OP_INLINE,  // C statement from inline_templates
+  OP_PUSH,    // Constant, variable or CREATE word: its cell is known now
+} aot_op_t;
+
+typedef struct {
+  const char* name;
+  int min, grow;      // Data stack cells needed and added
+  const char* check;  // Extra guard, or NULL
+  const char* code;
+} aot_template_t;
+
+// Words written as C statements. Several are colon definitions (DUP, 1+,
+// 0<); their meaning is fixed and inlining saves the nested call.
+static const aot_template_t inline_templates[] = {
+    {"DUP", 1, 1, NULL, "ds[sp] = ds[sp - 1]; sp++;"},
+    {"DROP", 1, 0, NULL, "sp--;"},
+    {"SWAP", 2, 0, NULL,
+     "cell_t t = ds[sp - 1]; ds[sp - 1] = ds[sp - 2]; ds[sp - 2] = t;"},
+    {"OVER", 2, 1, NULL, "ds[sp] = ds[sp - 2]; sp++;"},
+    {"NIP", 2, 0, NULL, "ds[sp - 2] = ds[sp - 1]; sp--;"},
+    {"TUCK", 2, 1, NULL,
+     "ds[sp] = ds[sp - 1]; ds[sp - 1] = ds[sp - 2]; ds[sp - 2] = ds[sp]; "
+     "sp++;"},
+    {"ROT", 3, 0, NULL,
+     "cell_t t = ds[sp - 3]; ds[sp - 3] = ds[sp - 2]; "
+     "ds[sp - 2] = ds[sp - 1]; ds[sp - 1] = t;"},
+    {"2DUP", 2, 2, NULL,
+     "ds[sp] = ds[sp - 2]; ds[sp + 1] = ds[sp - 1]; sp += 2;"},
+    {"2DROP", 2, 0, NULL, "sp -= 2;"},
+    {"PICK", 1, 0, "(ucell_t)ds[sp - 1] < (ucell_t)(sp - 1)",
+     "ds[sp - 1] = ds[sp - 2 - ds[sp - 1]];"},
+    {"+", 2, 0, NULL, "ds[sp - 2] = AOT_ADD(ds[sp - 2], ds[sp - 1]); sp--;"},
+    {"-", 2, 0, NULL, "ds[sp - 2] = AOT_SUB(ds[sp - 2], ds[sp - 1]); sp--;"},
+    {"*", 2, 0, NULL, "ds[sp - 2] = AOT_MUL(ds[sp - 2], ds[sp - 1]); sp--;"},
+    {"AND", 2, 0, NULL, "ds[sp - 2] &= ds[sp - 1]; sp--;"},
+    {"OR", 2, 0, NULL, "ds[sp - 2] |= ds[sp - 1]; sp--;"},
+    {"XOR", 2, 0, NULL, "ds[sp - 2] ^= ds[sp - 1]; sp--;"},
+    {"INVERT", 1, 0, NULL, "ds[sp - 1] = ~ds[sp - 1];"},
+    {"NEGATE", 1, 0, NULL, "ds[sp - 1] = AOT_SUB(0, ds[sp - 1]);"},
+    {"1+", 1, 0, NULL, "ds[sp - 1] = AOT_ADD(ds[sp - 1], 1);"},
+    {"1-", 1, 0, NULL, "ds[sp - 1] = AOT_SUB(ds[sp - 1], 1);"},
+    {"CELL+", 1, 0, NULL, "ds[sp - 1] = AOT_ADD(ds[sp - 1], 4);"},
+    {"2*", 1, 0, NULL, "ds[sp - 1] = AOT_SHL(ds[sp - 1], 1);"},
+    {"CELLS", 1, 0, NULL, "ds[sp - 1] = AOT_SHL(ds[sp - 1], 2);"},
+    {"=", 2, 0, NULL, "ds[sp - 2] = AOT_FLAG(ds[sp - 2] == ds[sp - 1]); sp--;"},
+    {"<>", 2, 0, NULL,
+     "ds[sp - 2] = AOT_FLAG(ds[sp - 2] != ds[sp - 1]); sp--;"},
+    {"<", 2, 0, NULL, "ds[sp - 2] = AOT_FLAG(ds[sp - 2] < ds[sp - 1]); sp--;"},
+    {">", 2, 0, NULL, "ds[sp - 2] = AOT_FLAG(ds[sp - 2] > ds[sp - 1]); sp--;"},
+    {"<=", 2, 0, NULL,
+     "ds[sp - 2] = AOT_FLAG(ds[sp - 2] <= ds[sp - 1]); sp--;"},
+    {">=", 2, 0, NULL,
+     "ds[sp - 2] = AOT_FLAG(ds[sp - 2] >= ds[sp - 1]); sp--;"},
+    {"U<", 2, 0, NULL,
+     "ds[sp - 2] = AOT_FLAG((ucell_t)ds[sp - 2] < (ucell_t)ds[sp - 1]); "
+     "sp--;"},
+    {"U>", 2, 0, NULL,
+     "ds[sp - 2] = AOT_FLAG((ucell_t)ds[sp - 2] > (ucell_t)ds[sp - 1]); "
+     "sp--;"},
+    {"0=", 1, 0, NULL, "ds[sp - 1] = AOT_FLAG(ds[sp - 1] == 0);"},
+    {"0<>", 1, 0, NULL, "ds[sp - 1] = AOT_FLAG(ds[sp - 1] != 0);"},
+    {"0<", 1, 0, NULL, "ds[sp - 1] = AOT_FLAG(ds[sp - 1] < 0);"},
+    {"0>", 1, 0, NULL, "ds[sp - 1] = AOT_FLAG(ds[sp - 1] > 0);"},
+    {"@", 1, 0, "AOT_CELL_OK(ds[sp - 1])",
+     "ds[sp - 1] = aot_fetch(ds[sp - 1]);"},
+    {"!", 2, 0, "AOT_CELL_OK(ds[sp - 1])",
+     "aot_store(ds[sp - 1], ds[sp - 2]); sp -= 2;"},
+    {"C@", 1, 0, "AOT_BYTE_OK(ds[sp - 1])",
+     "ds[sp - 1] = forth_memory[(ucell_t)ds[sp - 1]];"},
+    {"C!", 2, 0, "AOT_BYTE_OK(ds[sp - 1])",
+     "forth_memory[(ucell_t)ds[sp - 1]] = (byte_t)ds[sp - 2]; sp -= 2;"},
+    {">R", 1, 0, "ctx->return_stack_ptr < RETURN_STACK_SIZE",
+     "rs[ctx->return_stack_ptr++] = ds[--sp];"},
+    {"R>", 0, 1, "ctx->return_stack_ptr > 0",
+     "ds[sp++] = rs[--ctx->return_stack_ptr];"},
+    {"R@", 0, 1, "ctx->return_stack_ptr > 0",
+     "ds[sp++] = rs[ctx->return_stack_ptr - 1];"},
+    {"I", 0, 1, "ctx->return_stack_ptr >= 2",
+     "ds[sp++] = AOT_ADD(rs[ctx->return_stack_ptr - 1], "
+     "rs[ctx->return_stack_ptr - 2]);"},
+    {"(DO)", 2, 0, "ctx->return_stack_ptr <= RETURN_STACK_SIZE - 2",
+     "rs[ctx->return_stack_ptr] = AOT_ADD(ds[sp - 2], LOOP_BIAS); "
+     "rs[ctx->return_stack_ptr + 1] = "
+     "AOT_SUB(ds[sp - 1], rs[ctx->return_stack_ptr]); "
+     "ctx->return_stack_ptr += 2; sp -= 2;"},
+};
+
+#define INLINE_COUNT (sizeof(inline_templates) / sizeof(inline_templates[0]))
+
+// Words with their own code, and the words behind inline_templates, found
+// among the builtins so user redefinitions don't shadow them
+static const struct {
+  const char* name;
+  aot_op_t op;
+} special_names[] = {
+    {"LIT", OP_LIT},         {"EXIT", OP_EXIT},   {"BRANCH", OP_BRANCH},
+    {"0BRANCH", OP_0BRANCH}, {"(LOOP)", OP_LOOP},   {"(TAIL)", OP_TAIL},
+    {"(SWITCH)", OP_SWITCH},
+};
+
+#define SPECIAL_COUNT (sizeof(special_names) / sizeof(special_names[0]))
+
+static word_t* special_words[SPECIAL_COUNT];
+static word_t* inline_words[INLINE_COUNT];
+
+// Runtimes a saved header may use, by name for the generated file
+static const struct {
+  void (*cfunc)(context_t* ctx, word_t* self);
+  const char* name;
+} runtimes[] = {
+    {execute_colon, "execute_colon"},
+    {f_param_field, "f_param_field"},
+    {f_address, "f_address"},
+    {f_constant_runtime, "f_constant_runtime"},
+    {f_value_runtime, "f_value_runtime"},
+    {f_does_runtime, "f_does_runtime"},
+    {f_does_inline_runtime, "f_does_inline_runtime"},
+    {f_field_runtime, "f_field_runtime"},
+#ifdef FORTH_ENABLE_DOUBLE
+    {f_2constant_runtime, "f_2constant_runtime"},
+#endif
+#ifdef FORTH_ENABLE_FLOATING
+    {f_fconstant_runtime, "f_fconstant_runtime"},
+#endif
+};
+
+#define RUNTIME_COUNT (sizeof(runtimes) / sizeof(runtimes[0]))
+
+typedef struct {
+  forth_addr_t addr;  // Token address
+  forth_addr_t next;  // Address of the following token
+  word_t* word;
+  aot_op_t op;
+  const aot_template_t* inline_template;
+  cell_t operand;  // First inline cell: literal or branch target
+  bool landing;    // Some branch lands on this token
+} aot_token_t;
+
+static aot_token_t tokens[AOT_MAX_TOKENS];
+static int token_count;
+
+static FILE* out;
+static bool deopt_used;
+
+// Words defined after the builtins, oldest first, and which are compiled
+static word_t** user_words;
+static bool* compiled;
+static int user_count;
+
+static word_t* find_builtin(const char* name) {
+  for (word_t* word = builtin_dictionary_head; word; word = word->link) {
+    if (case_insensitive_strcmp(word->name, name) == 0) return word;
+  }
+  return NULL;
+}
+
+static forth_addr_t header_addr(word_t* word) {
+  return (forth_addr_t)((byte_t*)word - forth_memory);
+}
+
+static int user_index(word_t* word) {
+  for (int i = 0; i < user_count; i++) {
+    if (user_words[i] == word) return i;
+  }
+  return -1;
+}
+
+static void classify(aot_token_t* token) {
+  token->op = OP_CALL;
+  token->inline_template = NULL;
+
+  for (size_t i = 0; i < SPECIAL_COUNT; i++) {
+    if (special_words[i] && token->word == special_words[i]) {
+      token->op = special_names[i].op;
+      return;
+    }
+  }
+  for (size_t i = 0; i < INLINE_COUNT; i++) {
+    if (inline_words[i] && token->word == inline_words[i]) {
+      token->op = OP_INLINE;
+      token->inline_template = &inline_templates[i];
+      return;
+    }
+  }
+
+  word_t* word = token->word;
+  if (word->cfunc == f_constant_runtime) {
+    token->op = OP_PUSH;
+    token->operand = word->param.value;
+  } else if (word->cfunc == f_param_field) {
+    token->op = OP_PUSH;
+    token->operand = (cell_t)word->param.address;
+  } else if (word->cfunc == f_address) {
+    token->op = OP_PUSH;
+    token->operand = (cell_t)(header_addr(word) + offsetof(word_t, param));
+  }
+}
+
+// Cell i of a (SWITCH) token's table, just past its length cell
+static cell_t switch_cell(const aot_token_t* token, cell_t i) {
+  cell_t cell;
+  memcpy(&cell, &forth_memory[token->addr + (2 + i) * sizeof(cell_t)],
+         sizeof(cell));
+  return cell;
+}
+
+// Target n of a (SWITCH); n == count is the default
+static forth_addr_t switch_target(const aot_token_t* token, cell_t n) {
+  cell_t count = switch_cell(token, SWITCH_COUNT);
+  if (n == count) return (forth_addr_t)switch_cell(token, SWITCH_DEFAULT);
+  if (switch_cell(token, SWITCH_KIND) == SWITCH_SORTED) n += count;
+  return (forth_addr_t)switch_cell(token, SWITCH_HEADER + n);
+}
+
+static int token_index(forth_addr_t addr) {
+  for (int i = 0; i < token_count; i++) {
+    if (tokens[i].addr == addr) return i;
+  }
+  return -1;
+}
+
+// Split a body into tokens, stopping at the EXIT or BRANCH that no forward
+// branch jumps past. Anything that doesn't look like compiled code gives up.
+static bool decode_body(word_t* word) {
+  forth_addr_t ip = word->param.address;
+  forth_addr_t end = definition_end(word);
+  forth_addr_t reach = ip;  // Furthest forward branch target
+  token_count = 0;
+
+  for (;;) {
+    if (token_count == AOT_MAX_TOKENS) return false;
+    if (ip + sizeof(cell_t) > end) return false;
+
+    forth_addr_t xt;
+    memcpy(&xt, &forth_memory[ip], sizeof(xt));
+    if (xt > FORTH_MEMORY_SIZE - sizeof(word_t)) return false;
+
+    aot_token_t* token = &tokens[token_count++];
+    token->addr = ip;
+    token->word = AOT_W(xt);
+    token->landing = false;
+    token->operand = 0;
+    classify(token);
+
+    uint32_t flags = token->word->flags;
+    ip += sizeof(cell_t);
+    if (flags & (WORD_FLAG_OPERAND_CELL | WORD_FLAG_OPERAND_FLOAT |
+                 WORD_FLAG_OPERAND_STRING)) {
+      if (ip + sizeof(cell_t) > end) return false;
+      memcpy(&token->operand, &forth_memory[ip], sizeof(cell_t));
+    }
+
+    if (flags & WORD_FLAG_OPERAND_CELL) {
+      ip += sizeof(cell_t);
+    } else if (flags & WORD_FLAG_OPERAND_FLOAT) {
+      ip += 2 * sizeof(cell_t);
+    } else if (flags & WORD_FLAG_OPERAND_STRING) {
+      if ((ucell_t)token->operand > end) return false;
+      ip = (forth_addr_t)align_up(ip + sizeof(cell_t) + token->operand,
+                                  sizeof(cell_t));
+    }
+    token->next = ip;
+
+    if ((flags & WORD_FLAG_BRANCH) && (forth_addr_t)token->operand > reach) {
+      reach = (forth_addr_t)token->operand;
+    }
+
+    if ((token->op == OP_EXIT || token->op == OP_BRANCH) && reach < ip) break;
+  }
+
+  // Every branch must land on a token of this body
+  for (int i = 0; i < token_count; i++) {
+    if (!(tokens[i].word->flags & WORD_FLAG_BRANCH)) continue;
+    int target = token_index((forth_addr_t)tokens[i].operand);
+    if (target < 0) return false;
+    tokens[target].landing = true;
+  }
+
+  // So must every target of a dispatch table, or it stays a call
+  for (int i = 0; i < token_count; i++) {
+    if (tokens[i].op != OP_SWITCH) continue;
+    cell_t count = switch_cell(&tokens[i], SWITCH_COUNT);
+    for (cell_t n = 0; n <= count; n++) {
+      if (token_index(switch_target(&tokens[i], n)) < 0) {
+        tokens[i].op = OP_CALL;
+      }
+    }
+    if (tokens[i].op != OP_SWITCH) continue;
+    for (cell_t n = 0; n <= count; n++) {
+      tokens[token_index(switch_target(&tokens[i], n))].landing = true;
+    }
+  }
+
+  return true;
+}
+
+// Word names go in comments; keep them from closing one
+static void write_name(const char* name) {
+  fputs("/* ", out);
+  for (const char* c = name; *c; c++) {
+    fputc(*c, out);
+    if (*c == '*' && c[1] == '/') fputc(' ', out);
+  }
+  fputs(" */", out);
+}
+
+// Call the token's word; branch words may also land on their target
+static void write_call(const aot_token_t* token, const char* indent) {
+  int user = user_index(token->word);
+  if (user >= 0 && compiled[user]) {
+    fprintf(out, "%sAOT_INVOKE_FN(aot_%04x, 0x%04x, 0x%04x);\n", indent,
+            header_addr(token->word), header_addr(token->word),
+            token->addr + (forth_addr_t)sizeof(cell_t));
+  } else {
+    fprintf(out, "%sAOT_INVOKE(0x%04x, 0x%04x);\n", indent,
+            header_addr(token->word),
+            token->addr + (forth_addr_t)sizeof(cell_t));
+  }
+
+  if (token->word->flags & WORD_FLAG_BRANCH) {
+    fprintf(out, "%sif (ctx->ip == 0x%04x) goto L%04x;\n", indent,
+            (forth_addr_t)token->operand, (forth_addr_t)token->operand);
+  }
+  fprintf(out, "%sif (ctx->ip != 0x%04x) goto deopt;\n", indent, token->next);
+  deopt_used = true;
+}
+
+// Fast path under a guard, the real word otherwise
+static void write_guarded(const aot_token_t* token, const char* guard,
+                          const char* code) {
+  fprintf(out, "  if (%s) {\n    ", guard);
+  for (const char* c = code; *c; c++) {
+    if (*c == ' ' && c > code && c[-1] == ';') {
+      fputs("\n    ", out);  // One statement per line
+    } else {
+      fputc(*c, out);
+    }
+  }
+  fputs("\n  } else {\n", out);
+  write_call(token, "    ");
+  fputs("  }\n", out);
+}
+
+static void write_token(const aot_token_t* token) {
+  char guard[128];
+  char code[64];
+  forth_addr_t target = (forth_addr_t)token->operand;
+
+  if (token->landing) fprintf(out, "L%04x:\n", token->addr);
+  fputs("  ", out);
+  write_name(token->word->name);
+  fputc('\n', out);
+
+  switch (token->op) {
+    case OP_LIT:
+    case OP_PUSH:
+      snprintf(code, sizeof(code), "ds[sp++] = %" PRId32 ";", token->operand);
+      write_guarded(token, "AOT_FITS(0, 1)", code);
+      break;
+
+    case OP_EXIT:
+      fputs("  AOT_EXIT();\n", out);
+      break;
+
+    case OP_BRANCH:
+      fprintf(out, "  goto L%04x;\n", target);
+      break;
+
+    case OP_0BRANCH:
+      snprintf(code, sizeof(code), "if (ds[--sp] == 0) goto L%04x;", target);
+      write_guarded(token, "AOT_FITS(1, 0)", code);
+      break;
+
+    case OP_LOOP:
+      fprintf(out,
+              "  if (ctx->return_stack_ptr >= 2) {\n"
+              "    if (rs[ctx->return_stack_ptr - 1] != INT32_MAX) {\n"
+              "      rs[ctx->return_stack_ptr - 1]++;\n"
+              "      goto L%04x;\n"
+              "    }\n"
+              "    ctx->return_stack_ptr -= 2;\n"
+              "  } else {\n",
+              target);
+      write_call(token, "    ");
+      fputs("  }\n", out);
+      break;
+
+    case OP_INLINE: {
+      const aot_template_t* t = token->inline_template;
+      int length = snprintf(guard, sizeof(guard), "AOT_FITS(%d, %d)", t->min,
+                            t->grow);
+      if (t->check) {
+        snprintf(guard + length, sizeof(guard) - length, " && %s", t->check);
+      }
+      write_guarded(token, guard, t->code);
+      break;
+    }
+
+    case OP_TAIL: {
+      // Straight to the callee, which returns just past the operand
+      word_t* callee = AOT_W((forth_addr_t)token->operand);
+      int user = user_index(callee);
+      if (user >= 0 && compiled[user]) {
+        fprintf(out,
+                "  AOT_INVOKE_FN(aot_%04x, 0x%04x, 0x%04x);\n"
+                "  if (ctx->ip != 0x%04x) goto deopt;\n",
+                header_addr(callee), header_addr(callee), token->next,
+                token->next);
+        deopt_used = true;
+      } else {
+        write_call(token, "  ");
+      }
+      break;
+    }
+
+    case OP_SWITCH: {
+      // Matches drop the value; the default and holes keep it
+      cell_t count = switch_cell(token, SWITCH_COUNT);
+      forth_addr_t otherwise = switch_target(token, count);
+      fputs("  if (AOT_FITS(1, 0)) {\n    switch (ds[sp - 1]) {\n", out);
+      for (cell_t n = 0; n < count; n++) {
+        if (switch_target(token, n) == otherwise) continue;
+        cell_t value = switch_cell(token, SWITCH_KIND) == SWITCH_SORTED
+                           ? switch_cell(token, SWITCH_HEADER + n)
+                           : (cell_t)((ucell_t)switch_cell(token, SWITCH_LOW) +
+                                      (ucell_t)n);
+        fprintf(out, "      case %" PRId32 ": sp--; goto L%04x;\n", value,
+                switch_target(token, n));
+      }
+      fprintf(out, "      default: goto L%04x;\n    }\n  } else {\n",
+              otherwise);
+      write_call(token, "    ");
+      fputs("  }\n", out);
+      break;
+    }
+
+    case OP_CALL:
+      write_call(token, "  ");
+      break;
+  }
+}
+
+static void write_definition(word_t* word) {
+  decode_body(word);
+  deopt_used = false;
+
+  fputc('\n', out);
+  write_name(word->name);
+  fprintf(out, "\nstatic void aot_%04x(context_t* ctx, word_t* self) {\n",
+          header_addr(word));
+  fputs("  AOT_ENTER();\n\n", out);
+
+  for (int i = 0; i < token_count; i++) {
+    write_token(&tokens[i]);
+  }
+
+  if (deopt_used) {
+    fputs(
+        "\ndeopt:\n"
+        "  ctx->data_stack_ptr = sp;\n"
+        "  execute_tokens(ctx, frame);\n",
+        out);
+  }
+  fputs("}\n", out);
+}
+
+// Name of the function a saved header points at, NULL if there is none
+static const char* cfunc_name(word_t* word, char* buffer, size_t size) {
+  int user = user_index(word);
+  if (user >= 0 && compiled[user]) {
+    snprintf(buffer, size, "aot_%04x", header_addr(word));
+    return buffer;
+  }
+  if (is_colon_definition(word)) return "execute_colon";
+
+  for (size_t i = 0; i < RUNTIME_COUNT; i++) {
+    if (word->cfunc == runtimes[i].cfunc) return runtimes[i].name;
+  }
+  return NULL;
+}
+
+static void write_image(forth_addr_t base) {
+  fputs("\nstatic const byte_t aot_image[] = {", out);
+  for (forth_addr_t addr = base; addr < here; addr++) {
+    if ((addr - base) % 12 == 0) fputs("\n   ", out);
+    fprintf(out, " 0x%02x,", forth_memory[addr]);
+  }
+  if (here == base) fputs("0", out);
+  fputs("\n};\n", out);
+}
+
+static void write_words(void) {
+  char buffer[16];
+
+  fputs("\nstatic const aot_word_t aot_words[] = {\n", out);
+  for (int i = 0; i < user_count; i++) {
+    word_t* word = user_words[i];
+    fprintf(out, "    {0x%04x, 0x%04x, %s},  ", header_addr(word),
+            word->link ? header_addr(word->link) : 0,
+            cfunc_name(word, buffer, sizeof(buffer)));
+    write_name(word->name);
+    fputc('\n', out);
+  }
+  if (user_count == 0) fputs("    {0, 0, NULL},\n", out);
+  fputs("};\n", out);
+}
+
+bool aot_write(context_t* ctx, FILE* file, word_t* entry) {
+  for (size_t i = 0; i < SPECIAL_COUNT; i++) {
+    special_words[i] = find_builtin(special_names[i].name);
+  }
+  for (size_t i = 0; i < INLINE_COUNT; i++) {
+    inline_words[i] = find_builtin(inline_templates[i].name);
+  }
+
+  // The dictionary links newest first; the image lists oldest first
+  user_count = 0;
+  for (word_t* word = dictionary_head; word && word != builtin_dictionary_head;
+       word = word->link) {
+    user_count++;
+  }
+  user_words = malloc((user_count + 1) * sizeof(*user_words));
+  compiled = malloc((user_count + 1) * sizeof(*compiled));
+  if (!user_words || !compiled) {
+    free(user_words);
+    free(compiled);
+    error(ctx, "AOT: out of memory");
+    return false;
+  }
+
+  int i = user_count;
+  for (word_t* word = dictionary_head; word && word != builtin_dictionary_head;
+       word = word->link) {
+    user_words[--i] = word;
+  }
+
+  // Decide what gets compiled, and check every header can be restored
+  bool ok = true;
+  for (i = 0; i < user_count; i++) {
+    word_t* word = user_words[i];
+    compiled[i] = word->param_type == PARAM_ADDRESS &&
+                  is_colon_definition(word) && decode_body(word);
+  }
+  for (i = 0; i < user_count && ok; i++) {
+    char buffer[16];
+    if (!cfunc_name(user_words[i], buffer, sizeof(buffer))) {
+      error(ctx, "AOT: can't save %s (unknown word type)", user_words[i]->name);
+      ok = false;
+    }
+  }
+
+  if (ok && entry && user_index(entry) < 0) {
+    error(ctx, "AOT: entry word %s is a builtin", entry->name);
+    ok = false;
+  }
+
+  if (ok) {
+    out = file;
+    fprintf(out,
+            "// Generated by kisforth-aot: %d words, %u bytes of data space\n"
+            "\n#include \"aot.h\"\n",
+            user_count, here - builtin_here);
+
+    for (i = 0; i < user_count; i++) {
+      if (!compiled[i]) continue;
+      fprintf(out, "\nstatic void aot_%04x(context_t* ctx, word_t* self);",
+              header_addr(user_words[i]));
+    }
+    fputc('\n', out);
+
+    for (i = 0; i < user_count; i++) {
+      if (compiled[i]) write_definition(user_words[i]);
+    }
+
+    write_image(builtin_here);
+    write_words();
+    fprintf(out,
+            "\nconst aot_program_t aot_program = {\n"
+            "    0x%04x, 0x%04x, aot_image, aot_words, %d, 0x%04x,\n"
+            "};\n",
+            builtin_here, here, user_count, entry ? header_addr(entry) : 0);
+
+    ok = !ferror(out);
+    debug("AOT: wrote %d words", user_count);
+  }
+
+  free(user_words);
+  free(compiled);
+  user_words = NULL;
+  compiled = NULL;
+  user_count = 0;
+  return ok;
+}
+
+bool aot_install(context_t* ctx, const aot_program_t* program) {
+  if (here != program->base || program->here > forth_end) {
+    error(ctx, "AOT: program was compiled for a different build");
+    return false;
+  }
+
+  memcpy(&forth_memory[program->base], program->image,
+         program->here - program->base);
+  here = program->here;
+
+  for (int i = 0; i < program->word_count; i++) {
+    const aot_word_t* saved = &program->words[i];
+    word_t* word = AOT_W(saved->header);
+    word->link = saved->link ? AOT_W(saved->link) : NULL;
+    word->cfunc = saved->cfunc;
+  }
+  if (program->word_count > 0) {
+    dictionary_head = AOT_W(program->words[program->word_count - 1].header);
+  }
+
+  debug("AOT: installed %d words", program->word_count);
+  return true;
+}
+
+#endif  // FORTH_ENABLE_AOT
@@ -0,0 +1,285 @@
+#include "array.h"
+
+#include <stddef.h>
+
+#include "debug.h"
+#include "dictionary.h"
+#include "error.h"
+#include "stack.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#if defined(__SSE4_1__)
+#include <smmintrin.h>
+#endif
+#endif
+
+/*
+ * Kernels
+ * =======
+ * All arithmetic is done on ucell_t (or with wrapping SIMD adds) so overflow
+ * wraps instead of being undefined. Forth addresses need not be 16-byte
+ * aligned, so vector loads and stores are always unaligned.
+ */
+
+#if defined(__SSE2__)
+
+// Horizontal add of four 32-bit lanes
+static inline ucell_t hsum_epi32(__m128i v) {
+  v = _mm_add_epi32(v, _mm_shuffle_epi32(v, _MM_SHUFFLE(1, 0, 3, 2)));
+  v = _mm_add_epi32(v, _mm_shuffle_epi32(v, _MM_SHUFFLE(2, 3, 0, 1)));
+  return (ucell_t)_mm_cvtsi128_si32(v);
+}
+
+// Low 32 bits of a lane-wise product (SSE2 has no pmulld)
+static inline __m128i mullo_epi32(__m128i a, __m128i b) {
+#if defined(__SSE4_1__)
+  return _mm_mullo_epi32(a, b);
+#else
+  __m128i even = _mm_mul_epu32(a, b);
+  __m128i odd = _mm_mul_epu32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32));
+  return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)),
+                            _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+#endif
+}
+
+// Lane-wise signed min/max (SSE2 has no pminsd/pmaxsd)
+static inline __m128i select_epi32(__m128i mask, __m128i a, __m128i b) {
+  return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+
+static inline __m128i min_epi32(__m128i a, __m128i b) {
+#if defined(__SSE4_1__)
+  return _mm_min_epi32(a, b);
+#else
+  return select_epi32(_mm_cmplt_epi32(a, b), a, b);
+#endif
+}
+
+static inline __m128i max_epi32(__m128i a, __m128i b) {
+#if defined(__SSE4_1__)
+  return _mm_max_epi32(a, b);
+#else
+  return select_epi32(_mm_cmpgt_epi32(a, b), a, b);
+#endif
+}
+
+static inline __m128i load4(const cell_t* p) {
+  return _mm_loadu_si128((const __m128i*)p);
+}
+
+#endif  // __SSE2__
+
+cell_t cells_sum(const cell_t* a, ucell_t n) {
+  ucell_t sum = 0;
+  ucell_t i = 0;
+
+#if defined(__SSE2__)
+  // Two accumulators hide the add latency
+  __m128i acc0 = _mm_setzero_si128();
+  __m128i acc1 = _mm_setzero_si128();
+  for (; i + 8 <= n; i += 8) {
+    acc0 = _mm_add_epi32(acc0, load4(a + i));
+    acc1 = _mm_add_epi32(acc1, load4(a + i + 4));
+  }
+  sum = hsum_epi32(_mm_add_epi32(acc0, acc1));
+#endif
+
+  for (; i < n; i++) sum += (ucell_t)a[i];
+  return (cell_t)sum;
+}
+
+cell_t cells_min(const cell_t* a, ucell_t n) {
+  cell_t result = a[0];
+  ucell_t i = 0;
+
+#if defined(__SSE2__)
+  if (n >= 4) {
+    __m128i acc = load4(a);
+    for (i = 4; i + 4 <= n; i += 4) acc = min_epi32(acc, load4(a + i));
+
+    acc = min_epi32(acc, _mm_shuffle_epi32(acc, _MM_SHUFFLE(1, 0, 3, 2)));
+    acc = min_epi32(acc, _mm_shuffle_epi32(acc, _MM_SHUFFLE(2, 3, 0, 1)));
+    result = _mm_cvtsi128_si32(acc);
+  }
+#endif
+
+  for (; i < n; i++) {
+    if (a[i] < result) result = a[i];
+  }
+  return result;
+}
+
+cell_t cells_max(const cell_t* a, ucell_t n) {
+  cell_t result = a[0];
+  ucell_t i = 0;
+
+#if defined(__SSE2__)
+  if (n >= 4) {
+    __m128i acc = load4(a);
+    for (i = 4; i + 4 <= n; i += 4) acc = max_epi32(acc, load4(a + i));
+
+    acc = max_epi32(acc, _mm_shuffle_epi32(acc, _MM_SHUFFLE(1, 0, 3, 2)));
+    acc = max_epi32(acc, _mm_shuffle_epi32(acc, _MM_SHUFFLE(2, 3, 0, 1)));
+    result = _mm_cvtsi128_si32(acc);
+  }
+#endif
+
+  for (; i < n; i++) {
+    if (a[i] > result) result = a[i];
+  }
+  return result;
+}
+
+cell_t cells_dot(const cell_t* a, const cell_t* b, ucell_t n) {
+  ucell_t sum = 0;
+  ucell_t i = 0;
+
+#if defined(__SSE2__)
+  __m128i acc = _mm_setzero_si128();
+  for (; i + 4 <= n; i += 4) {
+    acc = _mm_add_epi32(acc, mullo_epi32(load4(a + i), load4(b + i)));
+  }
+  sum = hsum_epi32(acc);
+#endif
+
+  for (; i < n; i++) sum += (ucell_t)a[i] * (ucell_t)b[i];
+  return (cell_t)sum;
+}
+
+void cells_scale(cell_t* a, ucell_t n, cell_t factor) {
+  ucell_t i = 0;
+
+#if defined(__SSE2__)
+  __m128i f = _mm_set1_epi32(factor);
+  for (; i + 4 <= n; i += 4) {
+    _mm_storeu_si128((__m128i*)(a + i), mullo_epi32(load4(a + i), f));
+  }
+#endif
+
+  for (; i < n; i++) a[i] = (cell_t)((ucell_t)a[i] * (ucell_t)factor);
+}
+
+// Inclusive scan: a[i] becomes a[0] + ... + a[i]
+void cells_prefix_sum(cell_t* a, ucell_t n) {
+  ucell_t running = 0;
+  ucell_t i = 0;
+
+#if defined(__SSE2__)
+  // In-register scan of four lanes (two shifted adds), then add the carry
+  __m128i carry = _mm_setzero_si128();
+  for (; i + 4 <= n; i += 4) {
+    __m128i x = load4(a + i);
+    x = _mm_add_epi32(x, _mm_slli_si128(x, 4));
+    x = _mm_add_epi32(x, _mm_slli_si128(x, 8));
+    x = _mm_add_epi32(x, carry);
+    _mm_storeu_si128((__m128i*)(a + i), x);
+    carry = _mm_shuffle_epi32(x, _MM_SHUFFLE(3, 3, 3, 3));
+  }
+  running = (ucell_t)_mm_cvtsi128_si32(carry);
+#endif
+
+  for (; i < n; i++) {
+    running += (ucell_t)a[i];
+    a[i] = (cell_t)running;
+  }
+}
+
+// ============================================================================
+// Forth words
+// ============================================================================
+
+// Validate u cells at addr and return them; NULL if u is not positive or the
+// range is bad (an error has been reported in that case)
+static cell_t* cell_span(context_t* ctx, forth_addr_t addr, cell_t u) {
+  if (u <= 0) return NULL;
+
+  // Keep the byte count from wrapping before the range check sees it
+  if ((ucell_t)u > UINT32_MAX / sizeof(cell_t)) {
+    error(ctx, "Cell count too large: %d", u);
+    return NULL;
+  }
+  return addr_range_to_ptr(ctx, addr, (ucell_t)u * sizeof(cell_t));
+}
+
+// CELLS-SUM ( a-addr u -- n )
+static void f_cells_sum(context_t* ctx, word_t* self) {
+  (void)self;
+
+  cell_t u = data_pop(ctx);
+  forth_addr_t addr = (forth_addr_t)data_pop(ctx);
+
+  cell_t* a = cell_span(ctx, addr, u);
+  data_push(ctx, a ? cells_sum(a, (ucell_t)u) : 0);
+}
+
+// CELLS-MIN ( a-addr u -- n )  u must be positive
+static void f_cells_min(context_t* ctx, word_t* self) {
+  (void)self;
+
+  cell_t u = data_pop(ctx);
+  forth_addr_t addr = (forth_addr_t)data_pop(ctx);
+
+  require(ctx, u > 0);
+  cell_t* a = cell_span(ctx, addr, u);
+  if (a) data_push(ctx, cells_min(a, (ucell_t)u));
+}
+
+// CELLS-MAX ( a-addr u -- n )  u must be positive
+static void f_cells_max(context_t* ctx, word_t* self) {
+  (void)self;
+
+  cell_t u = data_pop(ctx);
+  forth_addr_t addr = (forth_addr_t)data_pop(ctx);
+
+  require(ctx, u > 0);
+  cell_t* a = cell_span(ctx, addr, u);
+  if (a) data_push(ctx, cells_max(a, (ucell_t)u));
+}
+
+// CELLS-DOT ( a-addr1 a-addr2 u -- n )
+static void f_cells_dot(context_t* ctx, word_t* self) {
+  (void)self;
+
+  cell_t u = data_pop(ctx);
+  forth_addr_t addr2 = (forth_addr_t)data_pop(ctx);
+  forth_addr_t addr1 = (forth_addr_t)data_pop(ctx);
+
+  cell_t* a = cell_span(ctx, addr1, u);
+  cell_t* b = cell_span(ctx, addr2, u);
+  data_push(ctx, a && b ? cells_dot(a, b, (ucell_t)u) : 0);
+}
+
+// CELLS-SCALE ( a-addr u n -- )  Multiply each cell by n in place
+static void f_cells_scale(context_t* ctx, word_t* self) {
+  (void)self;
+
+  cell_t factor = data_pop(ctx);
+  cell_t u = data_pop(ctx);
+  forth_addr_t addr = (forth_addr_t)data_pop(ctx);
+
+  cell_t* a = cell_span(ctx, addr, u);
+  if (a) cells_scale(a, (ucell_t)u, factor);
+}
+
+// CELLS-PREFIX-SUM ( a-addr u -- )  Replace each cell by its running total
+static void f_cells_prefix_sum(context_t* ctx, word_t* self) {
+  (void)self;
+
+  cell_t u = data_pop(ctx);
+  forth_addr_t addr = (forth_addr_t)data_pop(ctx);
+
+  cell_t* a = cell_span(ctx, addr, u);
+  if (a) cells_prefix_sum(a, (ucell_t)u);
+}
+
+void create_array_primitives(void) {
+  create_primitive_word("CELLS-SUM", f_cells_sum);
+  create_primitive_word("CELLS-MIN", f_cells_min);
+  create_primitive_word("CELLS-MAX", f_cells_max);
+  create_primitive_word("CELLS-DOT", f_cells_dot);
+  create_primitive_word("CELLS-SCALE", f_cells_scale);
+  create_primitive_word("CELLS-PREFIX-SUM", f_cells_prefix_sum);
+
+  debug("Cell-array primitives created");
+}
@@ -0,0 +1,313 @@
+#include "bench.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "debug.h"
+#include "dictionary.h"
+#include "stack.h"
+#include "test.h"
+#include "text.h"
+
+#ifdef FORTH_ENABLE_TESTS
+
+typedef struct {
+  const char* name;
+  const char* setup;  // Interpreted a line at a time, not timed
+  const char* run;    // Interpreted a line at a time and timed
+} bench_case_t;
+
+// 4096 cells of test data; 250 passes over it touch about 1M elements
+#define BENCH_CELL_DATA                                    \
+  "CREATE DATA 4096 CELLS ALLOT\n"                         \
+  ": INIT 4096 0 DO I 7 AND 3 - DATA I CELLS + ! LOOP ;\n" \
+  "INIT\n"
+
+#ifdef FORTH_ENABLE_FLOATING
+// 1024 floats of test data; 250 passes touch 256k elements
+#define BENCH_FLOAT_DATA                                              \
+  "CREATE FDATA 1024 FLOATS ALLOT\n"                                  \
+  ": FINIT 1024 0 DO I 7 AND S>F 0.5 F* FDATA I FLOATS + F! LOOP ;\n" \
+  "FINIT\n"
+#endif
+
+#ifdef FORTH_ENABLE_STRING
+// 4KB of text with "needle" at the end, an identical copy, and a mostly blank
+// buffer; 250 passes over 4KB is about 1MB per case
+#define BENCH_TEXT_DATA                                     \
+  "CREATE TEXT 4096 ALLOT TEXT 4096 97 FILL\n"              \
+  "S\" needle\" TEXT 4090 + SWAP MOVE\n"                    \
+  "CREATE TEXT2 4096 ALLOT TEXT TEXT2 4096 MOVE\n"          \
+  "CREATE TRAIL 4096 ALLOT TRAIL 4096 BLANK 120 TRAIL C!\n" \
+  ": NEEDLE S\" needle\" ;\n"
+#endif
+
+// 16 lines of 16 literals compiled with ,
+#define BENCH_TABLE_ROW                                                   \
+  "12345678 , 87654321 , -42 , $7FFF , 1000000007 , 2147483647 , %1011 , " \
+  "31415926 , 7 , 65535 , -1 , 100 , 99999 , 'A' , 4096 , 3 ,\n"
+#define BENCH_TABLE_ROWS4 \
+  BENCH_TABLE_ROW BENCH_TABLE_ROW BENCH_TABLE_ROW BENCH_TABLE_ROW
+#define BENCH_TABLE_ROWS \
+  BENCH_TABLE_ROWS4 BENCH_TABLE_ROWS4 BENCH_TABLE_ROWS4 BENCH_TABLE_ROWS4
+
+static const bench_case_t bench_cases[] = {
+    // Cell-array reductions: native kernel vs the same loop in Forth
+    {"CELLS-SUM (1M cells)",
+     BENCH_CELL_DATA ": RUN 250 0 DO DATA 4096 CELLS-SUM DROP LOOP ;", "RUN"},
+    {"@ + loop (1M cells)",
+     BENCH_CELL_DATA
+     ": SUM 0 4096 0 DO DATA I CELLS + @ + LOOP ;\n"
+     ": RUN 250 0 DO SUM DROP LOOP ;",
+     "RUN"},
+    {"CELLS-MAX (1M cells)",
+     BENCH_CELL_DATA ": RUN 250 0 DO DATA 4096 CELLS-MAX DROP LOOP ;", "RUN"},
+    {"CELLS-DOT (1M cells)",
+     BENCH_CELL_DATA ": RUN 250 0 DO DATA DATA 4096 CELLS-DOT DROP LOOP ;",
+     "RUN"},
+    {"CELLS-PREFIX-SUM (1M cells)",
+     BENCH_CELL_DATA ": RUN 250 0 DO DATA 4096 CELLS-PREFIX-SUM LOOP ;",
+     "RUN"},
+    {"MOVE 16KB x 250",
+     BENCH_CELL_DATA ": RUN 250 0 DO DATA DATA 4 + 4092 CELLS MOVE LOOP ;",
+     "RUN"},
+
+    // Mixed-precision scaling: native */ vs the M* SM/REM colon definition
+    {"*/ (100k)", ": RUN 100000 0 DO I 3 7 */ DROP LOOP ;", "RUN"},
+    {"M* SM/REM */ (100k)",
+     ": OLD*/ >R M* R> SM/REM SWAP DROP ;\n"
+     ": RUN 100000 0 DO I 3 7 OLD*/ DROP LOOP ;",
+     "RUN"},
+
+    // Counted-loop overhead: the loop itself, then with a stepped +LOOP
+    {"Empty DO LOOP (10M)", ": RUN 10000000 0 DO LOOP ;", "RUN"},
+    {"I +LOOP (10M)", ": RUN 0 20000000 0 ?DO I + 2 +LOOP DROP ;", "RUN"},
+
+    // Call overhead: a short colon definition called from a counted loop
+    {"Colon calls (1M)",
+     ": SQ DUP * ; NOINLINE\n"
+     ": RUN 0 1000000 0 DO I 1023 AND SQ + LOOP DROP ;",
+     "RUN"},
+    {"Inlined calls (1M)",
+     ": SQ DUP * ; INLINE\n: RUN 0 1000000 0 DO I 1023 AND SQ + LOOP DROP ;",
+     "RUN"},
+    {"Constant expressions (100k)",
+     ": RUN 100000 0 DO 10 CELLS BL 1+ + [ 4 8 * ] LITERAL XOR DROP LOOP ;",
+     "RUN"},
+    {"Tail recursion (1M)",
+     ": DOWN DUP IF 1- RECURSE THEN ;\n: RUN 1000000 DOWN DROP ;", "RUN"},
+
+    // Dispatch on a byte: an IF chain vs CASE, which compiles to a table
+    {"IF chain dispatch (1M)",
+     ": OP DUP 0 = IF DROP 1 ELSE DUP 1 = IF DROP 2 ELSE DUP 2 = IF DROP 3 "
+     "ELSE DUP 3 = IF DROP 4 ELSE DUP 4 = IF DROP 5 ELSE DUP 5 = IF DROP 6 "
+     "ELSE DUP 6 = IF DROP 7 ELSE DROP 8 THEN THEN THEN THEN THEN THEN THEN ;\n"
+     ": RUN 0 1000000 0 DO I 7 AND OP + LOOP DROP ;",
+     "RUN"},
+    {"CASE dispatch (1M)",
+     ": OP CASE 0 OF 1 ENDOF 1 OF 2 ENDOF 2 OF 3 ENDOF 3 OF 4 ENDOF "
+     "4 OF 5 ENDOF 5 OF 6 ENDOF 6 OF 7 ENDOF 8 SWAP ENDCASE ;\n"
+     ": RUN 0 1000000 0 DO I 7 AND OP + LOOP DROP ;",
+     "RUN"},
+    {"Verified loop (1M)",
+     ": RUN 0 1000000 0 DO I 3 AND - 7 XOR LOOP DROP ;", "RUN"},
+
+    // Number conversion: a data table written as Forth source
+    {"Numeric table load (256 literals)", "CREATE TABLE\n",
+     BENCH_TABLE_ROWS},
+
+    // Transient regions: building a string in PAD byte by byte
+    {"C! C@ in PAD (1M bytes)",
+     ": RUN 1000 0 DO 1000 0 DO I PAD I + C! PAD I + C@ DROP LOOP LOOP ;",
+     "RUN"},
+    {"FILL MOVE in PAD (100k)",
+     ": RUN 100000 0 DO PAD 64 BL FILL PAD PAD 512 + 64 MOVE LOOP ;", "RUN"},
+
+    // CREATE DOES> array access vs the same address arithmetic inline
+    {"DOES> array access (1M)",
+     ": ARRAY CREATE CELLS ALLOT DOES> SWAP CELLS + ; 16 ARRAY A\n"
+     ": RUN 1000 0 DO 1000 0 DO I 15 AND A DROP LOOP LOOP ;",
+     "RUN"},
+    {"Inline CELLS + (1M)",
+     "CREATE B 16 CELLS ALLOT\n"
+     ": RUN 1000 0 DO 1000 0 DO I 15 AND CELLS B + DROP LOOP LOOP ;",
+     "RUN"},
+
+    // Record access: folded field offsets vs CELL+ chains
+    {"Structure fields (1M)",
+     "BEGIN-STRUCTURE REC FIELD: R.A FIELD: R.B FIELD: R.C END-STRUCTURE\n"
+     "CREATE R REC ALLOT\n"
+     ": RUN 1000000 0 DO I R R.C ! R R.C @ R R.B ! LOOP ;",
+     "RUN"},
+    {"CELL+ chains (1M)",
+     "CREATE R 3 CELLS ALLOT\n"
+     ": RUN 1000000 0 DO I R CELL+ CELL+ ! R CELL+ CELL+ @ R CELL+ ! LOOP ;",
+     "RUN"},
+
+#ifdef FORTH_ENABLE_LOCALS
+    // Locals vs stack juggling for a three-input expression (a-b)*(a+c)
+    {"Locals (a-b)*(a+c) (100k)",
+     ": F {: a b c :} a b - a c + * ;\n"
+     ": RUN 100000 0 DO I 3 5 F DROP LOOP ;",
+     "RUN"},
+    {"Stack juggling (a-b)*(a+c) (100k)",
+     ": F >R OVER SWAP - SWAP R> + * ;\n"
+     ": RUN 100000 0 DO I 3 5 F DROP LOOP ;",
+     "RUN"},
+#endif
+
+    // Pictured output: native #S (two digits per division) vs a # loop
+    {"<# #S #> (100k)",
+     ": RUN 100000 0 DO I 1000000 + 0 <# #S #> 2DROP LOOP ;", "RUN"},
+    {"<# # loop #> (100k)",
+     ": OLD#S BEGIN # 2DUP OR 0= UNTIL ;\n"
+     ": RUN 100000 0 DO I 1000000 + 0 <# OLD#S #> 2DROP LOOP ;",
+     "RUN"},
+
+#ifdef FORTH_ENABLE_DOUBLE
+    {"D+ (100k)", ": RUN 0 0 100000 0 DO I 0 D+ LOOP 2DROP ;", "RUN"},
+#endif
+
+#ifdef FORTH_ENABLE_FLOATING
+    // Float stack shuffling: native FSWAP vs one built on FVARIABLEs
+    {"FP polynomial (100k)",
+     ": RUN 0.0 100000 0 DO I S>F FDUP FDUP F* FSWAP 2.0 F* F+ F+ LOOP "
+     "FDROP ;",
+     "RUN"},
+    {"FP polynomial, colon FSWAP (100k)",
+     "FVARIABLE FA FVARIABLE FB\n"
+     ": CFSWAP FA F! FB F! FA F@ FB F@ ;\n"
+     ": RUN 0.0 100000 0 DO I S>F FDUP FDUP F* CFSWAP 2.0 F* F+ F+ LOOP "
+     "FDROP ;",
+     "RUN"},
+
+    // Float text conversion
+    {">FLOAT (100k)",
+     ": NUM S\" 3.14159265358979E-3\" ;\n"
+     ": RUN 100000 0 DO NUM >FLOAT DROP FDROP LOOP ;",
+     "RUN"},
+    {"REPRESENT 17 digits (100k)",
+     "CREATE DIGITS 17 ALLOT\n"
+     ": RUN 100000 0 DO I S>F 0.1 F* DIGITS 17 REPRESENT 2DROP DROP LOOP ;",
+     "RUN"},
+
+    // Float-array kernels vs the same loop in Forth
+    {"FDOT (256k floats)",
+     BENCH_FLOAT_DATA ": RUN 250 0 DO FDATA FDATA 1024 FDOT FDROP LOOP ;",
+     "RUN"},
+    {"F@ F* F+ loop (256k floats)",
+     BENCH_FLOAT_DATA
+     ": DOT 0.0 1024 0 DO FDATA I FLOATS + F@ FDUP F* F+ LOOP ;\n"
+     ": RUN 250 0 DO DOT FDROP LOOP ;",
+     "RUN"},
+    {"FAXPY (256k floats)",
+     BENCH_FLOAT_DATA
+     "CREATE FY 1024 FLOATS ALLOT\n"
+     ": RUN 250 0 DO FDATA FY 1024 0.5 FAXPY LOOP ;",
+     "RUN"},
+    {"FMATMUL 32x32 x 100",
+     BENCH_FLOAT_DATA
+     "CREATE FC 1024 FLOATS ALLOT\n"
+     ": RUN 100 0 DO FDATA FDATA FC 32 32 32 FMATMUL LOOP ;",
+     "RUN"},
+#endif
+
+#ifdef FORTH_ENABLE_STRING
+    // String words vs the same scans written in Forth
+    {"COMPARE (1MB)",
+     BENCH_TEXT_DATA
+     ": RUN 250 0 DO TEXT 4096 TEXT2 4096 COMPARE DROP LOOP ;",
+     "RUN"},
+    {"C@ compare loop (1MB)",
+     BENCH_TEXT_DATA
+     "VARIABLE DIFF\n"
+     ": FCOMPARE 0 DIFF ! 0 DO OVER I + C@ OVER I + C@ - DIFF @ OR DIFF ! "
+     "LOOP 2DROP DIFF @ ;\n"
+     ": RUN 250 0 DO TEXT TEXT2 4096 FCOMPARE DROP LOOP ;",
+     "RUN"},
+    {"SEARCH (1MB)",
+     BENCH_TEXT_DATA
+     ": RUN 250 0 DO TEXT 4096 NEEDLE SEARCH 2DROP DROP LOOP ;",
+     "RUN"},
+    {"C@ scan loop (1MB)",
+     BENCH_TEXT_DATA
+     ": FSEARCH 4091 0 DO TEXT I + C@ 110 = IF I UNLOOP EXIT THEN LOOP "
+     "-1 ;\n"
+     ": RUN 250 0 DO FSEARCH DROP LOOP ;",
+     "RUN"},
+    {"-TRAILING (1MB)",
+     BENCH_TEXT_DATA ": RUN 250 0 DO TRAIL 4096 -TRAILING 2DROP LOOP ;",
+     "RUN"},
+    {"C@ BL = loop (1MB)",
+     BENCH_TEXT_DATA
+     ": FTRAIL BEGIN DUP IF 2DUP + 1- C@ BL = ELSE 0 THEN "
+     "WHILE 1- REPEAT ;\n"
+     ": RUN 250 0 DO TRAIL 4096 FTRAIL 2DROP LOOP ;",
+     "RUN"},
+#endif
+};
+
+#define BENCH_CASE_COUNT (sizeof(bench_cases) / sizeof(bench_cases[0]))
+
+// Feed text one line at a time, as it would arrive at the REPL
+static void interpret_lines(const char* text) {
+  char line[INPUT_BUFFER_SIZE];
+  for (const char* p = text; *p != '\0';) {
+    size_t length = strcspn(p, "\n");
+    if (length >= sizeof(line)) length = sizeof(line) - 1;
+
+    memcpy(line, p, length);
+    line[length] = '\0';
+    interpret_text(&main_context, line);
+
+    p += strcspn(p, "\n");
+    if (*p == '\n') p++;
+  }
+}
+
+// Run one case from a fresh system and return the elapsed time in ms
+static double run_benchmark(const bench_case_t* bench) {
+  forth_reset();
+  interpret_lines(bench->setup);
+
+  clock_t start = clock();
+  interpret_lines(bench->run);
+  clock_t end = clock();
+
+  if (data_depth(&main_context) != 0) {
+    printf("  (warning: %s left %d item(s) on the stack)\n", bench->name,
+           data_depth(&main_context));
+  }
+
+  return (double)(end - start) * 1000.0 / CLOCKS_PER_SEC;
+}
+
+void run_all_benchmarks(void) {
+  printf("Running KISForth Benchmarks...\n\n");
+
+  for (size_t i = 0; i < BENCH_CASE_COUNT; i++) {
+    double ms = run_benchmark(&bench_cases[i]);
+    printf("  %-32s %10.2f ms\n", bench_cases[i].name, ms);
+    fflush(stdout);
+  }
+
+  forth_reset();
+  printf("\n");
+}
+
+// BENCH ( -- ) Run the benchmark suite (resets the system, like TEST)
+static void f_bench(context_t* ctx, word_t* self) {
+  (void)ctx;
+  (void)self;
+
+  run_all_benchmarks();
+}
+
+void create_bench_primitives(void) {
+  create_primitive_word("BENCH", f_bench);
+
+  debug("Benchmark primitives created");
+}
+
+#endif  // FORTH_ENABLE_TESTS
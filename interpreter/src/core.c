@@ -4,15 +4,19 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include "coverage.h"
 #include "debug.h"
 #include "dictionary.h"
 #include "error.h"
+#include "locals.h"
 #include "forth.h"
+#include "jit.h"
 #include "memory.h"
 #include "repl.h"
 #include "stack.h"
 #include "text.h"
 #include "util.h"
+#include "verify.h"
 
 // Global STATE pointer for efficient access
 cell_t* state_ptr = NULL;
@@ -20,61 +24,74 @@ cell_t* state_ptr = NULL;
 // Global BASE pointer for efficient access
 cell_t* base_ptr = NULL;
 
-#define MAX_LOOP_LEAVES 32
-#define MAX_NESTED_LOOPS 8
-
-typedef struct {
-  forth_addr_t loop_start_addr;  // Address for backward branch from LOOP
-  forth_addr_t leave_addrs[MAX_LOOP_LEAVES];  // Forward branches from LEAVE
-  int leave_count;                            // Number of pending LEAVEs
-} loop_frame_t;
+// Control-flow stack entry kinds, named by the word that opens each
+enum {
+  CONTROL_ORIG,  // IF, ELSE, WHILE: forward branch operand at addr
+  CONTROL_DEST,  // BEGIN: addr is where the loop branches back to
+  CONTROL_DO,    // DO, ?DO: body starts at addr, LEAVEs chained from chain
+  CONTROL_CASE,  // CASE: dispatch jump operand at addr, ENDOFs chained
+  CONTROL_OF,    // OF: mismatch branch operand at addr
+};
 
-// Loop compilation stack
-static loop_frame_t loop_stack[MAX_NESTED_LOOPS];
-static int loop_stack_depth = 0;
+static const char* control_names[] = {"IF", "BEGIN", "DO", "CASE", "OF"};
 
-// Loop compilation stack management functions
-static void push_loop_frame(context_t* ctx, forth_addr_t start_addr) {
-  if (loop_stack_depth >= MAX_NESTED_LOOPS) {
-    error(ctx, "Loop nesting too deep (max %d)", MAX_NESTED_LOOPS);
+// Open a control structure in the definition being compiled. NULL after
+// the error if too many are open.
+static control_entry_t* control_push(context_t* ctx, int kind,
+                                     forth_addr_t addr) {
+  if (ctx->control_stack_ptr >= CONTROL_STACK_SIZE) {
+    error(ctx, "Control structures nested too deep (max %d)",
+          CONTROL_STACK_SIZE);
+    return NULL;
   }
 
-  loop_frame_t* frame = &loop_stack[loop_stack_depth];
-  frame->loop_start_addr = start_addr;
-  frame->leave_count = 0;
-  loop_stack_depth++;
+  control_entry_t* entry = &ctx->control_stack[ctx->control_stack_ptr++];
+  entry->kind = kind;
+  entry->addr = addr;
+  entry->chain = 0;
 
-  debug("Push loop frame: depth=%d, start_addr=%d", loop_stack_depth,
-        start_addr);
+  debug("Control push: %s at %u, depth %d", control_names[kind], addr,
+        ctx->control_stack_ptr);
+  return entry;
 }
 
-static loop_frame_t* current_loop_frame(context_t* ctx) {
-  if (loop_stack_depth == 0) {
-    error(ctx, "No active loop for LEAVE");
+// Innermost open structure, which must be of kind; mismatch names the
+// closing word and what it needs, as in "THEN without IF". NULL after the
+// error.
+static control_entry_t* control_top(context_t* ctx, int kind,
+                                    const char* mismatch) {
+  if (ctx->control_stack_ptr == 0) {
+    error(ctx, "%s", mismatch);
+    return NULL;
   }
-  return &loop_stack[loop_stack_depth - 1];
-}
 
-static void add_leave_addr(context_t* ctx, forth_addr_t leave_addr) {
-  loop_frame_t* frame = current_loop_frame(ctx);
-
-  if (frame->leave_count >= MAX_LOOP_LEAVES) {
-    error(ctx, "Too many LEAVE statements in loop (max %d)", MAX_LOOP_LEAVES);
+  control_entry_t* entry = &ctx->control_stack[ctx->control_stack_ptr - 1];
+  if (entry->kind != kind) {
+    error(ctx, "%s (%s still open)", mismatch, control_names[entry->kind]);
+    return NULL;
   }
-
-  frame->leave_addrs[frame->leave_count++] = leave_addr;
-  debug("Add LEAVE addr: %d (count now %d)", leave_addr, frame->leave_count);
-}
-
-static loop_frame_t pop_loop_frame(context_t* ctx) {
-  if (loop_stack_depth == 0) {
-    error(ctx, "No active loop to close");
+  return entry;
+}
+
+// Close the innermost open structure, which must be of kind. The entry
+// stays readable until the next push.
+static control_entry_t* control_pop(context_t* ctx, int kind,
+                                    const char* mismatch) {
+  control_entry_t* entry = control_top(ctx, kind, mismatch);
+  if (entry) ctx->control_stack_ptr--;
+  return entry;
+}
+
+// Point each operand on a chain at target. The chain costs no memory of
+// its own: every operand holds the address of the one before it until
+// it's resolved, and the first holds 0.
+static void resolve_chain(context_t* ctx, forth_addr_t chain,
+                          forth_addr_t target) {
+  while (chain != 0) {
+    forth_addr_t link = forth_fetch(ctx, chain);
+    forth_store(ctx, chain, target);
+    chain = link;
   }
-
-  loop_frame_t frame = loop_stack[--loop_stack_depth];
-  debug("Pop loop frame: depth now %d, had %d LEAVEs", loop_stack_depth,
-        frame.leave_count);
-  return frame;
 }
 
 // Arithmetic primitives - these operate on the data stack
@@ -195,7 +212,13 @@ static void f_c_store(context_t* ctx, word_t* self) {
 
   forth_addr_t addr = (forth_addr_t)data_pop(ctx);
   byte_t value = (byte_t)data_pop(ctx);
-  forth_c_store(ctx, addr, value);
+
+  byte_t* ptr = forth_span_ptr(ctx, addr, 1);
+  if (ptr) {
+    *ptr = value;
+  } else {
+    forth_c_store(ctx, addr, value);  // Reports the bad address
+  }
 }
 
 // C@ ( addr -- char )  Fetch char from addr
@@ -204,8 +227,8 @@ static void f_c_fetch(context_t* ctx, word_t* self) {
   (void)self;
 
   forth_addr_t addr = (forth_addr_t)data_pop(ctx);
-  byte_t value = forth_c_fetch(ctx, addr);
-  data_push(ctx, (cell_t)value);
+  byte_t* ptr = forth_span_ptr(ctx, addr, 1);
+  data_push(ctx, (cell_t)(ptr ? *ptr : forth_c_fetch(ctx, addr)));
 }
 
 // Comparison primitives - these operate on the data stack and return ANS Forth
@@ -296,6 +319,7 @@ static void f_here(context_t* ctx, word_t* self) {
   (void)self;
 
   data_push(ctx, here);
+  ctx->fold_barrier = here;  // Control flow may branch here
 }
 
 // ALLOT ( n -- )  Allocate n bytes of data space
@@ -325,6 +349,7 @@ static void f_comma(context_t* ctx, word_t* self) {
 
   // Align HERE to cell boundary before storing
   forth_align();
+  if (!forth_room(ctx, sizeof(cell_t))) return;
 
   // Store the value at current HERE
   forth_store(ctx, here, x);
@@ -340,6 +365,12 @@ static void f_colon(context_t* ctx, word_t* self) {
   (void)self;
 
   word_t* word = defining_word(ctx, execute_colon);
+  ctx->fold_barrier = 0;  // No branch can target the new body yet
+  ctx->control_stack_ptr = 0;
+
+#ifdef FORTH_ENABLE_LOCALS
+  forget_locals();
+#endif
 
   // Enter compilation state
   *state_ptr = -1;
@@ -355,9 +386,21 @@ static void f_semicolon(context_t* ctx, word_t* self) {
   (void)self;
 
   if (*state_ptr == 0) error(ctx, "';' without matching :");
+  if (ctx->control_stack_ptr > 0) {
+    control_entry_t* open = &ctx->control_stack[ctx->control_stack_ptr - 1];
+    error(ctx, "%s without a match before ;", control_names[open->kind]);
+    *state_ptr = 0;
+    return;
+  }
 
   debug("Ending colon definition, compiling EXIT");
 
+#ifdef FORTH_ENABLE_LOCALS
+  end_locals(ctx);
+#endif
+
+  compile_tail_call(ctx, dictionary_head);
+
   // Compile EXIT as the last token
   word_t* exit_word = find_word(ctx, "EXIT");
 
@@ -366,6 +409,12 @@ static void f_semicolon(context_t* ctx, word_t* self) {
   // Exit compilation state
   *state_ptr = 0;
 
+  verify_definition(ctx, dictionary_head);
+
+#if defined(FORTH_ENABLE_JIT) && JIT_THRESHOLD == 0
+  jit_compile(dictionary_head);
+#endif
+
   debug("Colon definition complete, exiting compilation mode");
 }
 
@@ -389,6 +438,37 @@ static void f_exit(context_t* ctx, word_t* self) {
   }
 }
 
+// (TAIL) Run-time: ( -- ) Call the word in the next cell as the last thing
+// before EXIT. A threaded callee runs its tokens in this frame, so its own
+// EXIT returns to our caller; anything else is called normally and the EXIT
+// that follows returns.
+static void f_tail_runtime(context_t* ctx, word_t* self) {
+  (void)self;
+
+  forth_addr_t xt = forth_fetch(ctx, ctx->ip);
+  word_t* callee = addr_to_ptr(ctx, xt);
+  if (callee->cfunc == execute_colon) {
+    coverage_hit(xt);  // Runs without going through execute_word
+    ctx->ip = callee->param.address;
+    return;
+  }
+
+  ctx->ip += sizeof(cell_t);
+  execute_word(ctx, callee);
+}
+
+// RECURSE Compilation: ( -- ) Compile a call to the current definition
+static void f_recurse(context_t* ctx, word_t* self) {
+  (void)self;
+
+  if (*state_ptr == 0 || dictionary_head == NULL) {
+    error(ctx, "RECURSE outside a definition");
+    return;
+  }
+
+  compile_token(ctx, ptr_to_addr(ctx, dictionary_head));
+}
+
 // LIT implementation that reads from instruction stream
 // LIT ( -- x ) Push the literal value that follows in compiled code
 static void f_lit(context_t* ctx, word_t* self) {
@@ -570,17 +650,15 @@ static void f_type(context_t* ctx, word_t* self) {
     return;  // Ignore negative count per ANS Forth practice
   }
 
-  // Output each character
-  for (cell_t i = 0; i < u; i++) {
-    // Bounds check the address
-    if (c_addr + i >= FORTH_MEMORY_SIZE) {
-      break;  // Stop at memory boundary
-    }
-
-    char c = (char)forth_c_fetch(ctx, c_addr + i);
-    putchar(c);
+  // Main memory output stops at its end; transient regions (pictured
+  // output, PAD) are translated as one span
+  if (c_addr < FORTH_MEMORY_SIZE && (ucell_t)u > FORTH_MEMORY_SIZE - c_addr) {
+    u = (cell_t)(FORTH_MEMORY_SIZE - c_addr);
   }
 
+  const char* chars = addr_range_to_ptr(ctx, c_addr, (ucell_t)u);
+  if (chars) fwrite(chars, 1, (size_t)u, stdout);
+
   fflush(stdout);  // Ensure immediate output
 }
 
@@ -627,12 +705,88 @@ static void f_m_star(context_t* ctx, word_t* self) {
   cell_t n1 = data_pop(ctx);
 
   // Use 64-bit arithmetic to handle the full range without overflow
-  int64_t product = (int64_t)n1 * (int64_t)n2;
+  data_push_double(ctx, (int64_t)n1 * (int64_t)n2);
+}
+
+// UM* ( u1 u2 -- ud )  Unsigned multiply giving a double-cell product
+static void f_um_star(context_t* ctx, word_t* self) {
+  (void)self;
+
+  ucell_t u2 = (ucell_t)data_pop(ctx);
+  ucell_t u1 = (ucell_t)data_pop(ctx);
+
+  data_push_double(ctx, (int64_t)((uint64_t)u1 * u2));
+}
+
+// UM/MOD ( ud u1 -- u2 u3 )  Unsigned division: remainder u2, quotient u3
+static void f_um_slash_mod(context_t* ctx, word_t* self) {
+  (void)self;
+
+  ucell_t divisor = (ucell_t)data_pop(ctx);
+  uint64_t dividend = (uint64_t)data_pop_double(ctx);
+
+  if (divisor == 0) {
+    error(ctx, "Division by zero in 'UM/MOD'");
+    data_push(ctx, 0);
+    data_push(ctx, 0);
+    return;
+  }
+
+  uint64_t quotient = dividend / divisor;
+  require(ctx, quotient <= UINT32_MAX);  // Quotient must fit in a cell
+
+  data_push(ctx, (cell_t)(ucell_t)(dividend % divisor));
+  data_push(ctx, (cell_t)(ucell_t)quotient);
+}
+
+// S>D ( n -- d )  Sign-extend a single cell to a double cell
+static void f_s_to_d(context_t* ctx, word_t* self) {
+  (void)self;
+
+  data_push(ctx, data_peek(ctx) < 0 ? -1 : 0);
+}
+
+// Symmetric n1*n2/n3 with a 64-bit intermediate, shared by */ and */MOD
+static void star_slash_mod(context_t* ctx, cell_t* remainder,
+                           cell_t* quotient) {
+  int64_t divisor = data_pop(ctx);
+  cell_t n2 = data_pop(ctx);
+  cell_t n1 = data_pop(ctx);
+
+  *remainder = 0;
+  *quotient = 0;
+  if (divisor == 0) {
+    error(ctx, "Division by zero in '*/'");
+    return;
+  }
+
+  // Same rounding as / and /MOD: SM/REM, truncating toward zero
+  int64_t product = (int64_t)n1 * n2;
+  int64_t q = product / divisor;
+  int64_t r = product % divisor;
+
+  require(ctx, q >= INT32_MIN && q <= INT32_MAX);
+  *remainder = (cell_t)r;
+  *quotient = (cell_t)q;
+}
+
+// */ ( n1 n2 n3 -- n4 )  n1*n2/n3 with a double-cell intermediate
+static void f_star_slash(context_t* ctx, word_t* self) {
+  (void)self;
 
-  // Push as double-cell: low cell first, then high cell
-  // This follows ANS Forth convention for double-cell numbers
-  data_push(ctx, (cell_t)(product & 0xFFFFFFFF));          // low 32 bits
-  data_push(ctx, (cell_t)((product >> 32) & 0xFFFFFFFF));  // high 32 bits
+  cell_t remainder, quotient;
+  star_slash_mod(ctx, &remainder, &quotient);
+  data_push(ctx, quotient);
+}
+
+// */MOD ( n1 n2 n3 -- n4 n5 )  Remainder and quotient of n1*n2/n3
+static void f_star_slash_mod(context_t* ctx, word_t* self) {
+  (void)self;
+
+  cell_t remainder, quotient;
+  star_slash_mod(ctx, &remainder, &quotient);
+  data_push(ctx, remainder);
+  data_push(ctx, quotient);
 }
 
 // IMMEDIATE ( -- ) Mark the most recently defined word as immediate
@@ -648,6 +802,32 @@ static void f_immediate(context_t* ctx, word_t* self) {
   debug("Made word '%s' immediate", dictionary_head->name);
 }
 
+// INLINE ( -- ) Compile the most recent definition's body into its callers
+static void f_inline(context_t* ctx, word_t* self) {
+  (void)self;
+
+  word_t* word = dictionary_head;
+  if (word == NULL) error(ctx, "No word to inline");
+
+  word->flags &= ~WORD_FLAG_NOINLINE;
+  if (!inline_body_end(ctx, word, INLINE_LIMIT_TOKENS)) {
+    error(ctx, "INLINE: %s is not a short straight-line definition",
+          word->name);
+    return;
+  }
+  word->flags |= WORD_FLAG_INLINE;
+}
+
+// NOINLINE ( -- ) Always compile calls to the most recent definition
+static void f_noinline(context_t* ctx, word_t* self) {
+  (void)self;
+
+  if (dictionary_head == NULL) error(ctx, "No word to mark");
+
+  dictionary_head->flags =
+      (dictionary_head->flags & ~WORD_FLAG_INLINE) | WORD_FLAG_NOINLINE;
+}
+
 // ROLL ( xu xu-1 ... x1 x0 u -- xu-1 ... x1 x0 xu )
 // Remove u. Rotate u+1 items on top of stack. An ambiguous condition
 // exists if there are less than u+2 items on the stack before ROLL.
@@ -758,6 +938,7 @@ static void f_dot_quote(context_t* ctx, word_t* self) {
     compile_token(ctx, ptr_to_addr(ctx, runtime_word));
     compile_token(ctx, (forth_addr_t)length);
 
+    if (!forth_room(ctx, length)) return;
     for (int i = 0; i < length; i++) {
       forth_c_store(ctx, here + i, string_buffer[i]);
     }
@@ -801,6 +982,7 @@ static void f_abort_quote(context_t* ctx, word_t* self) {
     compile_token(ctx, (forth_addr_t)length);
 
     // 3. Compile each character
+    if (!forth_room(ctx, length)) return;
     for (int i = 0; i < length; i++) {
       forth_c_store(ctx, here + i, string_buffer[i]);
     }
@@ -817,6 +999,98 @@ static void f_create(context_t* ctx, word_t* self) {
   defining_word(ctx, f_param_field);
 }
 
+// Longest DOES> code run without a return stack frame
+#define DOES_INLINE_TOKENS 8
+
+// Address just past a word's header, where CREATE starts its data field
+static forth_addr_t header_end(word_t* word) {
+  return (forth_addr_t)((byte_t*)word - forth_memory) + sizeof(word_t);
+}
+
+// Data field of a CREATEd word. DOES> leaves it right after the header and
+// reuses param.address for the DOES> code.
+forth_addr_t data_field(word_t* word) {
+  return word->param_type == PARAM_DOES ? header_end(word)
+                                        : word->param.address;
+}
+
+// DOES> runtime: push the data field and run the DOES> code as a colon body
+void f_does_runtime(context_t* ctx, word_t* self) {
+  data_push(ctx, (cell_t)data_field(self));
+  execute_colon(ctx, self);
+}
+
+// DOES> runtime for short straight-line code (see does_code_inlinable): the
+// tokens run directly up to EXIT, with no return stack frame
+void f_does_inline_runtime(context_t* ctx, word_t* self) {
+  data_push(ctx, (cell_t)data_field(self));
+
+  for (forth_addr_t ip = self->param.address;; ip += sizeof(cell_t)) {
+    word_t* word = addr_to_ptr(NULL, forth_fetch(ctx, ip));
+    if (word->cfunc == f_exit) break;
+    execute_word(ctx, word);
+  }
+}
+
+static void f_does_code(context_t* ctx, word_t* self);
+
+// DOES> code can skip the return frame if it is a few tokens ending in EXIT,
+// none of which reads the instruction stream (inline operands, branches, a
+// nested DOES>)
+static bool does_code_inlinable(context_t* ctx, forth_addr_t ip) {
+  for (int i = 0; i <= DOES_INLINE_TOKENS; i++, ip += sizeof(cell_t)) {
+    word_t* word = addr_to_ptr(ctx, forth_fetch(ctx, ip));
+    if (!word) return false;
+    if (word->cfunc == f_exit) return true;
+
+    if (word->flags & (WORD_FLAG_OPERAND_CELL | WORD_FLAG_OPERAND_FLOAT |
+                       WORD_FLAG_OPERAND_STRING) ||
+        word->cfunc == f_does_code) {
+      return false;
+    }
+  }
+  return false;
+}
+
+// (DOES>) Run-time: ( -- ) ( R: nest-sys -- )
+// Point the most recent (CREATEd) word at the code after this token, then
+// return from the defining word
+static void f_does_code(context_t* ctx, word_t* self) {
+  (void)self;
+
+  word_t* word = dictionary_head;
+  if (!word || word->cfunc != f_param_field ||
+      word->param.address != header_end(word)) {
+    error(ctx, "DOES> needs a word made by CREATE");
+    return;
+  }
+
+  word->param.address = ctx->ip;
+  word->param_type = PARAM_DOES;
+  word->cfunc = does_code_inlinable(ctx, ctx->ip) ? f_does_inline_runtime
+                                                  : f_does_runtime;
+
+  debug("DOES> code for %s at %u", word->name, ctx->ip);
+
+  f_exit(ctx, self);
+}
+
+// DOES> Compilation: ( C: colon-sys1 -- colon-sys2 )
+static void f_does(context_t* ctx, word_t* self) {
+  (void)self;
+
+  if (*state_ptr == 0) {
+    error(ctx, "DOES> can only be used in compilation mode");
+    return;
+  }
+
+#ifdef FORTH_ENABLE_LOCALS
+  end_locals(ctx);  // (DOES>) returns from the defining word
+#endif
+
+  compile_word(ctx, find_word(ctx, "(DOES>)"));
+}
+
 static void f_variable(context_t* ctx, word_t* self) {
   (void)ctx;
   (void)self;
@@ -846,6 +1120,19 @@ static void f_bracket_tick(context_t* ctx, word_t* self) {
   debug("['] compiled literal for %s: %u", name, ptr_to_addr(ctx, word));
 }
 
+// LITERAL Compilation: ( x -- ) Runtime: ( -- x )
+// Compile x, computed while interpreting, as a literal
+static void f_literal(context_t* ctx, word_t* self) {
+  (void)self;
+
+  if (*state_ptr == 0) {
+    error(ctx, "LITERAL can only be used in compilation mode");
+    return;
+  }
+
+  compile_literal(ctx, data_pop(ctx));
+}
+
 // 0BRANCH ( x -- ) - conditional branch
 // If x is zero, branch to address stored at ctx->ip
 // Always advances ctx->ip past the address
@@ -859,6 +1146,7 @@ static void f_0branch(context_t* ctx, word_t* self) {
 
   if (x == 0) {
     ctx->ip = target;  // Branch taken
+    coverage_hit(target);
   }
   // If x != 0, continue (branch not taken)
 }
@@ -870,6 +1158,141 @@ static void f_branch(context_t* ctx, word_t* self) {
 
   forth_addr_t target = forth_fetch(ctx, ctx->ip);
   ctx->ip = target;  // Always branch
+  coverage_hit(target);
+}
+
+// Compile branch, the name of BRANCH or 0BRANCH, to target; returns the
+// operand's address for a forward branch to resolve later
+static forth_addr_t compile_branch(context_t* ctx, const char* branch,
+                                   forth_addr_t target) {
+  compile_word(ctx, find_word(ctx, branch));
+  forth_addr_t operand = here;
+  compile_cell(ctx, target);
+  return operand;
+}
+
+// Point the forward branch operand orig at here, a branch target now
+static void resolve_orig(context_t* ctx, forth_addr_t orig) {
+  forth_store(ctx, orig, here);
+  ctx->fold_barrier = here;
+}
+
+// IF: ( C: -- orig )
+// Compilation: compile a conditional branch for THEN or ELSE to resolve
+static void f_if(context_t* ctx, word_t* self) {
+  (void)self;
+
+  if (*state_ptr == 0) {
+    error(ctx, "IF can only be used in compilation mode");
+  }
+
+  control_push(ctx, CONTROL_ORIG, compile_branch(ctx, "0BRANCH", 0));
+}
+
+// ELSE: ( C: orig1 -- orig2 )
+// Compilation: branch over the false part, which the IF now lands on
+static void f_else(context_t* ctx, word_t* self) {
+  (void)self;
+
+  if (*state_ptr == 0) {
+    error(ctx, "ELSE can only be used in compilation mode");
+  }
+
+  control_entry_t* orig = control_pop(ctx, CONTROL_ORIG, "ELSE without IF");
+  if (!orig) return;
+  forth_addr_t operand = orig->addr;
+
+  control_push(ctx, CONTROL_ORIG, compile_branch(ctx, "BRANCH", 0));
+  resolve_orig(ctx, operand);
+}
+
+// THEN: ( C: orig -- )
+// Compilation: the IF or ELSE branch lands here
+static void f_then(context_t* ctx, word_t* self) {
+  (void)self;
+
+  if (*state_ptr == 0) {
+    error(ctx, "THEN can only be used in compilation mode");
+  }
+
+  control_entry_t* orig = control_pop(ctx, CONTROL_ORIG, "THEN without IF");
+  if (orig) resolve_orig(ctx, orig->addr);
+}
+
+// BEGIN: ( C: -- dest )
+// Compilation: mark here as the target of the loop's backward branch
+static void f_begin(context_t* ctx, word_t* self) {
+  (void)self;
+
+  if (*state_ptr == 0) {
+    error(ctx, "BEGIN can only be used in compilation mode");
+  }
+
+  control_push(ctx, CONTROL_DEST, here);
+  ctx->fold_barrier = here;  // The loop branches back here
+}
+
+// AGAIN: ( C: dest -- )
+static void f_again(context_t* ctx, word_t* self) {
+  (void)self;
+
+  if (*state_ptr == 0) {
+    error(ctx, "AGAIN can only be used in compilation mode");
+  }
+
+  control_entry_t* dest =
+      control_pop(ctx, CONTROL_DEST, "AGAIN without BEGIN");
+  if (dest) compile_branch(ctx, "BRANCH", dest->addr);
+}
+
+// UNTIL: ( C: dest -- )
+static void f_until(context_t* ctx, word_t* self) {
+  (void)self;
+
+  if (*state_ptr == 0) {
+    error(ctx, "UNTIL can only be used in compilation mode");
+  }
+
+  control_entry_t* dest =
+      control_pop(ctx, CONTROL_DEST, "UNTIL without BEGIN");
+  if (dest) compile_branch(ctx, "0BRANCH", dest->addr);
+}
+
+// WHILE: ( C: dest -- orig dest )
+// Compilation: compile the exit test, its orig going under the BEGIN so
+// REPEAT closes the loop first and then resolves it
+static void f_while(context_t* ctx, word_t* self) {
+  (void)self;
+
+  if (*state_ptr == 0) {
+    error(ctx, "WHILE can only be used in compilation mode");
+  }
+
+  control_entry_t* dest =
+      control_pop(ctx, CONTROL_DEST, "WHILE without BEGIN");
+  if (!dest) return;
+  forth_addr_t target = dest->addr;
+
+  control_push(ctx, CONTROL_ORIG, compile_branch(ctx, "0BRANCH", 0));
+  control_push(ctx, CONTROL_DEST, target);
+}
+
+// REPEAT: ( C: orig dest -- )
+static void f_repeat(context_t* ctx, word_t* self) {
+  (void)self;
+
+  if (*state_ptr == 0) {
+    error(ctx, "REPEAT can only be used in compilation mode");
+  }
+
+  control_entry_t* dest =
+      control_pop(ctx, CONTROL_DEST, "REPEAT without BEGIN");
+  if (!dest) return;
+  compile_branch(ctx, "BRANCH", dest->addr);
+
+  control_entry_t* orig =
+      control_pop(ctx, CONTROL_ORIG, "REPEAT without WHILE");
+  if (orig) resolve_orig(ctx, orig->addr);
 }
 
 // U< ( u1 u2 -- flag )  Unsigned less than comparison
@@ -981,12 +1404,13 @@ static void f_find(context_t* ctx, word_t* self) {
 static void f_unused(context_t* ctx, word_t* self) {
   (void)ctx;
   (void)self;
-  cell_t unused_bytes = FORTH_MEMORY_SIZE - here;
+  cell_t unused_bytes = forth_end - here;  // High memory is in use
   data_push(ctx, unused_bytes);
 }
 
 // DO runtime: ( limit start -- ) ( R: -- loop-sys )
-// Sets up loop parameters on return stack
+// Sets up loop parameters on return stack, in the biased form LOOP_BIAS
+// describes
 static void f_do_runtime(context_t* ctx, word_t* self) {
   (void)ctx;
   (void)self;  // Unused parameter
@@ -999,14 +1423,32 @@ static void f_do_runtime(context_t* ctx, word_t* self) {
   cell_t limit = data_pop(ctx);  // Loop limit
 
   // Push loop parameters onto return stack: limit first, then index
-  return_push(ctx, limit);
-  return_push(ctx, start);
+  ucell_t bias = (ucell_t)limit + LOOP_BIAS;
+  return_push(ctx, (cell_t)bias);
+  return_push(ctx, (cell_t)((ucell_t)start - bias));
 
   debug("DO: limit=%d, start=%d", limit, start);
 }
 
+// ?DO runtime: ( limit start -- ) ( R: -- | loop-sys )
+// Like DO, except that equal limit and start skip the loop: the branch
+// target after this instruction is the end of the loop
+static void f_question_do_runtime(context_t* ctx, word_t* self) {
+  if (data_depth(ctx) >= 2 && data_peek(ctx) == data_peek_at(ctx, 1)) {
+    data_pop(ctx);
+    data_pop(ctx);
+    ctx->ip = forth_fetch(ctx, ctx->ip);
+    coverage_hit(ctx->ip);
+    return;
+  }
+
+  ctx->ip += sizeof(cell_t);  // Skip over the branch target address
+  f_do_runtime(ctx, self);
+}
+
 // LOOP runtime: ( -- ) ( R: loop-sys1 -- | loop-sys2 )
-// Increment index by 1, test for loop termination
+// Increment index by 1 in place; it reaches the limit when the biased
+// index overflows
 static void f_loop_runtime(context_t* ctx, word_t* self) {
   (void)ctx;
   (void)self;  // Unused parameter
@@ -1015,35 +1457,24 @@ static void f_loop_runtime(context_t* ctx, word_t* self) {
     error(ctx, "LOOP: missing loop parameters on return stack");
   }
 
-  // Get loop parameters from return stack
-  cell_t index = return_pop(ctx);
-  cell_t limit = return_pop(ctx);
-
-  // Increment index
-  index++;
-
-  debug("LOOP: index=%d, limit=%d", index, limit);
+  cell_t* index = &ctx->return_stack[ctx->return_stack_ptr - 1];
 
-  // Check for loop termination
-  if (index == limit) {
-    // Loop finished - don't restore parameters, continue after loop
+  if (*index == INT32_MAX) {
+    // Loop finished - drop parameters, continue after loop
+    ctx->return_stack_ptr -= 2;
     ctx->ip += sizeof(cell_t);  // Skip over the branch target address
-    debug("LOOP: finished");
     return;
   }
 
-  // Continue loop - restore parameters and branch back
-  return_push(ctx, limit);
-  return_push(ctx, index);
-
-  // The backward branch address follows this instruction
-  forth_addr_t branch_target = forth_fetch(ctx, ctx->ip);
-  ctx->ip = branch_target;
-  debug("LOOP: continue to %d", branch_target);
+  // Continue loop - branch back to the address after this instruction
+  (*index)++;
+  ctx->ip = forth_fetch(ctx, ctx->ip);
 }
 
 // +LOOP runtime: ( n -- ) ( R: loop-sys1 -- | loop-sys2 )
-// Increment index by n, test for loop termination with boundary crossing
+// Increment index by n, ending the loop when it crosses the boundary
+// between limit-1 and limit (ANS Forth): exactly when adding n to the
+// biased index overflows. An increment of 0 never ends it.
 static void f_plus_loop_runtime(context_t* ctx, word_t* self) {
   (void)ctx;
   (void)self;  // Unused parameter
@@ -1057,45 +1488,26 @@ static void f_plus_loop_runtime(context_t* ctx, word_t* self) {
   }
 
   cell_t increment = data_pop(ctx);
+  cell_t* index = &ctx->return_stack[ctx->return_stack_ptr - 1];
+  cell_t old_index = *index;
+  cell_t new_index = (cell_t)((ucell_t)old_index + (ucell_t)increment);
 
-  // Get loop parameters from return stack
-  cell_t index = return_pop(ctx);
-  cell_t limit = return_pop(ctx);
-
-  cell_t old_index = index;
-  index += increment;
-
-  debug("+LOOP: old_index=%d, increment=%d, new_index=%d, limit=%d", old_index,
-        increment, index, limit);
-
-  // Check for boundary crossing (ANS Forth standard)
-  // Loop terminates when index crosses the boundary between limit-1 and limit
-  bool crossed = false;
-
-  if (increment > 0) {
-    // Positive increment: terminate if we crossed from below limit to >= limit
-    crossed = (old_index < limit && index >= limit);
-  } else if (increment < 0) {
-    // Negative increment: terminate if we crossed from >= limit to < limit
-    crossed = (old_index >= limit && index < limit);
-  }
-  // If increment is 0, never terminate (infinite loop)
-
-  if (crossed) {
-    // Loop finished - don't restore parameters
+  if (((old_index ^ new_index) & (increment ^ new_index)) < 0) {
+    // Loop finished - drop parameters, continue after loop
+    ctx->return_stack_ptr -= 2;
     ctx->ip += sizeof(cell_t);  // Skip over the branch target address
-    debug("+LOOP: boundary crossed, finished");
     return;
   }
 
-  // Continue loop - restore parameters and branch back
-  return_push(ctx, limit);
-  return_push(ctx, index);
+  // Continue loop - branch back to the address after this instruction
+  *index = new_index;
+  ctx->ip = forth_fetch(ctx, ctx->ip);
+}
 
-  // The backward branch address follows this instruction
-  forth_addr_t branch_target = forth_fetch(ctx, ctx->ip);
-  ctx->ip = branch_target;
-  debug("+LOOP: continue to %d", branch_target);
+// Loop index from the biased pair whose top cell is offset cells down
+static cell_t loop_index(context_t* ctx, int offset) {
+  cell_t* top = &ctx->return_stack[ctx->return_stack_ptr - 1 - offset];
+  return (cell_t)((ucell_t)top[0] + (ucell_t)top[-1]);
 }
 
 // I: ( -- n ) ( R: loop-sys -- loop-sys )
@@ -1108,11 +1520,7 @@ static void f_i(context_t* ctx, word_t* self) {
     error(ctx, "I: no loop parameters on return stack");
   }
 
-  // Index is on top of return stack, limit is below it
-  cell_t index = return_stack_peek(ctx, 0);  // Top of return stack
-  data_push(ctx, index);
-
-  debug("I: index=%d", index);
+  data_push(ctx, loop_index(ctx, 0));
 }
 
 // J: ( -- n ) ( R: loop-sys1 loop-sys2 -- loop-sys1 loop-sys2 )
@@ -1125,13 +1533,8 @@ static void f_j(context_t* ctx, word_t* self) {
     error(ctx, "J: no outer loop parameters on return stack");
   }
 
-  // Return stack layout: [outer_limit] [outer_index] [inner_limit]
-  // [inner_index] J needs the outer_index, which is at position 2 from top
-  // (0-indexed)
-  cell_t outer_index = return_stack_peek(ctx, 2);
-  data_push(ctx, outer_index);
-
-  debug("J: outer_index=%d", outer_index);
+  // The outer loop's pair is under the inner one
+  data_push(ctx, loop_index(ctx, 2));
 }
 
 // LEAVE runtime: ( -- ) ( R: loop-sys -- )
@@ -1173,7 +1576,7 @@ static void f_unloop(context_t* ctx, word_t* self) {
 }
 
 // DO: ( C: -- do-sys )
-// Compilation: Push loop frame, compile DO runtime
+// Compilation: compile DO runtime and open a loop with no LEAVEs yet
 static void f_do(context_t* ctx, word_t* self) {
   (void)ctx;
   (void)self;  // Unused parameter
@@ -1189,88 +1592,72 @@ static void f_do(context_t* ctx, word_t* self) {
   }
   compile_word(ctx, do_runtime);
 
-  // Push loop frame with current address as loop start
+  // The loop starts at the current address
   forth_addr_t loop_start = here;
-  push_loop_frame(ctx, loop_start);
+  control_push(ctx, CONTROL_DO, loop_start);
 
   debug("DO: compiled, loop starts at %d", loop_start);
 }
 
-// LOOP: ( C: do-sys -- )
-// Compilation: Resolve LEAVEs, compile LOOP runtime and backward branch
-static void f_loop(context_t* ctx, word_t* self) {
-  (void)ctx;
-  (void)self;  // Unused parameter
+// ?DO: ( C: -- do-sys )
+// Compilation: compile the ?DO runtime with a branch past the loop, which
+// starts the LEAVE chain that LOOP or +LOOP resolves
+static void f_question_do(context_t* ctx, word_t* self) {
+  (void)self;
 
   if (*state_ptr == 0) {
-    error(ctx, "LOOP can only be used in compilation mode");
+    error(ctx, "?DO can only be used in compilation mode");
   }
 
-  // Get and pop the loop frame
-  loop_frame_t frame = pop_loop_frame(ctx);
+  compile_word(ctx, find_word(ctx, "(?DO)"));
+  forth_addr_t placeholder_addr = here;
+  compile_cell(ctx, 0);  // End of the LEAVE chain
 
-  // Compile the LOOP runtime primitive
-  word_t* loop_runtime = find_word(ctx, "(LOOP)");
-  if (!loop_runtime) {
-    error(ctx, "LOOP: (LOOP) runtime primitive not found");
-  }
-  compile_word(ctx, loop_runtime);
+  control_entry_t* loop = control_push(ctx, CONTROL_DO, here);
+  if (loop) loop->chain = placeholder_addr;
 
-  // Compile backward branch target (loop start address)
-  compile_cell(ctx, frame.loop_start_addr);
+  debug("?DO: compiled, loop starts at %d", here);
+}
 
-  // Resolve all LEAVE addresses to point here (after the loop)
-  forth_addr_t after_loop = here;
-  for (int i = 0; i < frame.leave_count; i++) {
-    forth_addr_t addr = frame.leave_addrs[i];
-    cell_t* cell_ptr = addr_to_ptr(ctx, addr);
-    *cell_ptr = after_loop;
-    debug("LOOP: resolved LEAVE at %d to %d", addr, after_loop);
+// LOOP and +LOOP: ( C: do-sys -- )
+// Compilation: close the loop with runtime and its backward branch, then
+// resolve the LEAVE chain to just after it
+static void compile_loop_end(context_t* ctx, const char* name,
+                             const char* runtime, const char* mismatch) {
+  if (*state_ptr == 0) {
+    error(ctx, "%s can only be used in compilation mode", name);
+    return;
   }
 
-  debug("LOOP: compiled, %d LEAVEs resolved to %d", frame.leave_count,
-        after_loop);
-}
+  control_entry_t* loop = control_pop(ctx, CONTROL_DO, mismatch);
+  if (!loop) return;
 
-// +LOOP: ( C: do-sys -- )
-// Compilation: Resolve LEAVEs, compile +LOOP runtime and backward branch
-static void f_plus_loop(context_t* ctx, word_t* self) {
-  (void)ctx;
-  (void)self;  // Unused parameter
+  compile_word(ctx, find_word(ctx, runtime));
+  compile_cell(ctx, loop->addr);  // Backward branch target (loop start)
 
-  if (*state_ptr == 0) {
-    error(ctx, "+LOOP can only be used in compilation mode");
-  }
+  resolve_chain(ctx, loop->chain, here);
+  ctx->fold_barrier = here;  // LEAVEs land here
 
-  // Get and pop the loop frame
-  loop_frame_t frame = pop_loop_frame(ctx);
+  debug("%s: compiled, LEAVEs resolved to %d", name, here);
+}
 
-  // Compile the +LOOP runtime primitive
-  word_t* plus_loop_runtime = find_word(ctx, "(+LOOP)");
-  if (!plus_loop_runtime) {
-    error(ctx, "+LOOP: (+LOOP) runtime primitive not found");
-  }
-  compile_word(ctx, plus_loop_runtime);
+// LOOP: ( C: do-sys -- )
+static void f_loop(context_t* ctx, word_t* self) {
+  (void)self;
 
-  // Compile backward branch target (loop start address)
-  compile_cell(ctx, frame.loop_start_addr);
+  compile_loop_end(ctx, "LOOP", "(LOOP)", "LOOP without DO");
+}
 
-  // Resolve all LEAVE addresses to point here (after the loop)
-  forth_addr_t after_loop = here;
-  for (int i = 0; i < frame.leave_count; i++) {
-    forth_addr_t addr = frame.leave_addrs[i];
-    cell_t* cell_ptr = addr_to_ptr(ctx, addr);
-    *cell_ptr = after_loop;
-    debug("+LOOP: resolved LEAVE at %d to %d", addr, after_loop);
-  }
+// +LOOP: ( C: do-sys -- )
+static void f_plus_loop(context_t* ctx, word_t* self) {
+  (void)self;
 
-  debug("+LOOP: compiled, %d LEAVEs resolved to %d", frame.leave_count,
-        after_loop);
+  compile_loop_end(ctx, "+LOOP", "(+LOOP)", "+LOOP without DO");
 }
 
 // LEAVE: ( C: -- )
-// Compilation: Compile LEAVE runtime and add branch address for later
-// resolution
+// Compilation: compile LEAVE runtime, its branch operand linked into the
+// innermost loop's LEAVE chain for LOOP or +LOOP to resolve
 static void f_leave(context_t* ctx, word_t* self) {
   (void)ctx;
   (void)self;  // Unused parameter
@@ -1279,6 +1666,18 @@ static void f_leave(context_t* ctx, word_t* self) {
     error(ctx, "LEAVE can only be used in compilation mode");
   }
 
+  // The loop may enclose IFs, BEGINs and CASEs
+  control_entry_t* loop = NULL;
+  for (int i = ctx->control_stack_ptr - 1; i >= 0 && !loop; i--) {
+    if (ctx->control_stack[i].kind == CONTROL_DO) {
+      loop = &ctx->control_stack[i];
+    }
+  }
+  if (!loop) {
+    error(ctx, "LEAVE without DO");
+    return;
+  }
+
   // Compile the LEAVE runtime primitive
   word_t* leave_runtime = find_word(ctx, "(LEAVE)");
   if (!leave_runtime) {
@@ -1286,16 +1685,253 @@ static void f_leave(context_t* ctx, word_t* self) {
   }
   compile_word(ctx, leave_runtime);
 
-  // Compile placeholder for branch target (will be resolved by LOOP/+LOOP)
+  // The operand holds the previous LEAVE until the loop closes
   forth_addr_t placeholder_addr = here;
-  compile_cell(ctx, 0);  // Placeholder address
-
-  // Add this address to the current loop frame for later resolution
-  add_leave_addr(ctx, placeholder_addr);
+  compile_cell(ctx, loop->chain);
+  loop->chain = placeholder_addr;
 
   debug("LEAVE: compiled with placeholder at %d", placeholder_addr);
 }
 
+// (OF) ( x1 x2 -- | x1 )
+// Equal: drop both and run the OF clause. Otherwise keep x1 and branch to
+// the next test.
+static void f_of_runtime(context_t* ctx, word_t* self) {
+  (void)self;
+
+  cell_t x2 = data_pop(ctx);
+  cell_t x1 = data_peek(ctx);
+  forth_addr_t target = forth_fetch(ctx, ctx->ip);
+  ctx->ip += sizeof(cell_t);
+
+  if (x1 == x2) {
+    data_pop(ctx);
+  } else {
+    ctx->ip = target;
+    coverage_hit(target);
+  }
+}
+
+// Target for x in the (SWITCH) table at table (just past its length cell)
+static forth_addr_t switch_lookup(context_t* ctx, forth_addr_t table,
+                                  cell_t x) {
+#define SWITCH_CELL(i) forth_fetch(ctx, table + (i) * sizeof(cell_t))
+  cell_t count = SWITCH_CELL(SWITCH_COUNT);
+
+  if (SWITCH_CELL(SWITCH_KIND) == SWITCH_DENSE) {
+    ucell_t offset = (ucell_t)x - (ucell_t)SWITCH_CELL(SWITCH_LOW);
+    if (offset < (ucell_t)count) {
+      return (forth_addr_t)SWITCH_CELL(SWITCH_HEADER + (cell_t)offset);
+    }
+  } else {
+    cell_t low = 0, high = count - 1;
+    while (low <= high) {
+      cell_t mid = low + (high - low) / 2;
+      cell_t value = SWITCH_CELL(SWITCH_HEADER + mid);
+      if (value == x) {
+        return (forth_addr_t)SWITCH_CELL(SWITCH_HEADER + count + mid);
+      }
+      if (value < x) {
+        low = mid + 1;
+      } else {
+        high = mid - 1;
+      }
+    }
+  }
+
+  return (forth_addr_t)SWITCH_CELL(SWITCH_DEFAULT);
+#undef SWITCH_CELL
+}
+
+// (SWITCH) ( x -- | x )
+// Jump to the OF clause for x, dropping it, or to the default clause with x
+// still on the stack. The table follows as a counted operand.
+static void f_switch_runtime(context_t* ctx, word_t* self) {
+  (void)self;
+
+  cell_t x = data_peek(ctx);
+  forth_addr_t table = ctx->ip + sizeof(cell_t);
+  forth_addr_t target = switch_lookup(ctx, table, x);
+
+  if (target != (forth_addr_t)forth_fetch(
+                    ctx, table + SWITCH_DEFAULT * sizeof(cell_t))) {
+    data_pop(ctx);
+  }
+  ctx->ip = target;
+  coverage_hit(target);
+}
+
+// CASE: ( C: -- case-sys )
+// Compilation: note where the first test starts, which ENDCASE may turn
+// into a jump to a dispatch table, and start an empty chain of ENDOF
+// branches
+static void f_case(context_t* ctx, word_t* self) {
+  (void)self;
+
+  if (*state_ptr == 0) {
+    error(ctx, "CASE can only be used in compilation mode");
+  }
+
+  ctx->fold_barrier = here;  // The first test stays where CASE left it
+  control_push(ctx, CONTROL_CASE, here);  // No ENDOFs yet
+}
+
+// OF: ( C: case-sys -- case-sys of-sys )
+// Compilation: compile the test, branching to the next one on a mismatch
+static void f_of(context_t* ctx, word_t* self) {
+  (void)self;
+
+  if (*state_ptr == 0) {
+    error(ctx, "OF can only be used in compilation mode");
+  }
+  if (!control_top(ctx, CONTROL_CASE, "OF without CASE")) return;
+
+  compile_word(ctx, find_word(ctx, "(OF)"));
+  control_push(ctx, CONTROL_OF, here);
+  compile_cell(ctx, 0);  // Resolved by ENDOF
+}
+
+// ENDOF: ( C: case-sys of-sys -- case-sys )
+// Compilation: jump to the end of the CASE, linking this branch into the
+// chain ENDCASE resolves, and point the OF test's mismatch branch here
+static void f_endof(context_t* ctx, word_t* self) {
+  (void)self;
+
+  if (*state_ptr == 0) {
+    error(ctx, "ENDOF can only be used in compilation mode");
+  }
+
+  control_entry_t* of = control_pop(ctx, CONTROL_OF, "ENDOF without OF");
+  if (!of) return;
+  forth_addr_t test = of->addr;
+  // OF opened inside its CASE, which is innermost again
+  control_entry_t* cases = &ctx->control_stack[ctx->control_stack_ptr - 1];
+
+  compile_word(ctx, find_word(ctx, "BRANCH"));
+  compile_cell(ctx, cases->chain);
+  cases->chain = here - sizeof(cell_t);
+
+  forth_store(ctx, test, here);
+  ctx->fold_barrier = here;  // The next test lands here
+}
+
+// Lay down a (SWITCH) for the n literal OF tests, values[i] selecting
+// targets[i]; earlier tests win over later ones with the same value
+static void compile_switch(context_t* ctx, const cell_t* values,
+                           const forth_addr_t* targets, int n,
+                           forth_addr_t otherwise) {
+  // Sort by value, the first of each value ahead of any repeats
+  static int order[SWITCH_MAX_CASES];
+  for (int i = 0; i < n; i++) {
+    int j = i;
+    while (j > 0 && values[order[j - 1]] > values[i]) {
+      order[j] = order[j - 1];
+      j--;
+    }
+    order[j] = i;
+  }
+  int unique = 0;
+  for (int i = 0; i < n; i++) {
+    if (unique == 0 || values[order[i]] != values[order[unique - 1]]) {
+      order[unique++] = order[i];
+    }
+  }
+
+  cell_t low = values[order[0]];
+  int64_t span = (int64_t)values[order[unique - 1]] - low + 1;
+  bool dense = span <= SWITCH_MAX_SPAN && span <= 2 * unique;
+  cell_t count = dense ? (cell_t)span : unique;
+  cell_t cells = SWITCH_HEADER + (dense ? count : 2 * count);
+
+  compile_word(ctx, find_word(ctx, "(SWITCH)"));
+  compile_cell(ctx, cells * (cell_t)sizeof(cell_t));
+  compile_cell(ctx, dense ? SWITCH_DENSE : SWITCH_SORTED);
+  compile_cell(ctx, count);
+  compile_cell(ctx, low);
+  compile_cell(ctx, otherwise);
+
+  if (dense) {
+    for (int i = 0, next = 0; i < count; i++) {
+      bool hit = next < unique && values[order[next]] == low + i;
+      compile_cell(ctx, hit ? targets[order[next++]] : otherwise);
+    }
+  } else {
+    for (int i = 0; i < unique; i++) compile_cell(ctx, values[order[i]]);
+    for (int i = 0; i < unique; i++) compile_cell(ctx, targets[order[i]]);
+  }
+
+  debug("Compiled %s switch: %d cases, %d targets", dense ? "dense" : "sorted",
+        n, count);
+}
+
+// ENDCASE: ( C: case-sys -- )
+// Compilation: drop the selector after the default clause and resolve the
+// ENDOF chain. When enough OF tests each compare with a literal, the
+// tests are bypassed: the first one becomes a jump to a (SWITCH) table
+// after the default clause, dense values indexing it and sparse ones
+// searched.
+static void f_endcase(context_t* ctx, word_t* self) {
+  (void)self;
+
+  if (*state_ptr == 0) {
+    error(ctx, "ENDCASE can only be used in compilation mode");
+  }
+
+  control_entry_t* cases =
+      control_pop(ctx, CONTROL_CASE, "ENDCASE without CASE");
+  if (!cases) return;
+  forth_addr_t chain = cases->chain;
+  forth_addr_t first = cases->addr;
+
+  compile_word(ctx, find_word(ctx, "DROP"));
+
+  int n = 0;
+  for (forth_addr_t link = chain; link != 0; link = forth_fetch(ctx, link)) {
+    n++;
+  }
+
+  // Walk the tests from the first, each branching to the next on a mismatch
+  static cell_t values[SWITCH_MAX_CASES];
+  static forth_addr_t targets[SWITCH_MAX_CASES];
+  forth_addr_t lit = ptr_to_addr(ctx, find_word(ctx, "LIT"));
+  forth_addr_t of = ptr_to_addr(ctx, find_word(ctx, "(OF)"));
+  forth_addr_t test = first;
+  int literals = 0;
+  while (literals < n && n <= SWITCH_MAX_CASES &&
+         (forth_addr_t)forth_fetch(ctx, test) == lit &&
+         (forth_addr_t)forth_fetch(ctx, test + 2 * sizeof(cell_t)) == of) {
+    values[literals] = forth_fetch(ctx, test + sizeof(cell_t));
+    targets[literals] = test + 4 * sizeof(cell_t);
+    test = forth_fetch(ctx, test + 3 * sizeof(cell_t));
+    literals++;
+  }
+
+  if (n >= SWITCH_MIN_CASES && literals == n) {
+    // Past the table from the default clause too
+    compile_word(ctx, find_word(ctx, "BRANCH"));
+    compile_cell(ctx, chain);
+    chain = here - sizeof(cell_t);
+
+    // LIT v (OF) next: both halves jump to the table, only the first runs
+    forth_addr_t branch = ptr_to_addr(ctx, find_word(ctx, "BRANCH"));
+    for (int i = 0; i < 4; i += 2) {
+      forth_store(ctx, first + i * sizeof(cell_t), branch);
+      forth_store(ctx, first + (i + 1) * sizeof(cell_t), here);
+    }
+    compile_switch(ctx, values, targets, n, test);
+  }
+
+  resolve_chain(ctx, chain, here);
+  ctx->fold_barrier = here;  // ENDOFs land here
+}
+
+// PAD ( -- c-addr )  Scratch area of the current context
+static void f_pad(context_t* ctx, word_t* self) {
+  (void)self;
+
+  data_push(ctx, (cell_t)PAD_ADDR);
+}
+
 // WORD ( char "<chars>cchar<chars>" -- c-addr )
 // Skip leading delimiters, parse until next delimiter, store as counted string
 // in PAD
@@ -1344,13 +1980,7 @@ static void f_word(context_t* ctx, word_t* self) {
   }
   forth_store(ctx, to_in_addr, current_to_in);
 
-  // Get PAD address by executing PAD word
-  word_t* pad_word = search_word("PAD");
-  if (!pad_word) {
-    error(ctx, "WORD: PAD not found");
-  }
-  pad_word->cfunc(ctx, pad_word);  // Execute PAD to get address
-  forth_addr_t pad_addr = (forth_addr_t)data_pop(ctx);
+  forth_addr_t pad_addr = PAD_ADDR;  // This context's PAD
 
   // Store counted string in PAD
   forth_c_store(ctx, pad_addr, (byte_t)length);  // Store length byte
@@ -1435,6 +2065,31 @@ static void f_accept(context_t* ctx, word_t* self) {
   debug("ACCEPT: read %d characters", count);
 }
 
+// >NUMBER ( ud1 c-addr1 u1 -- ud2 c-addr2 u2 )
+// Accumulate digits in BASE into ud1, stopping at the first non-digit
+static void f_to_number(context_t* ctx, word_t* self) {
+  (void)self;
+
+  cell_t u = data_pop(ctx);
+  forth_addr_t addr = (forth_addr_t)data_pop(ctx);
+  uint64_t value = (uint64_t)data_pop_double(ctx);
+
+  cell_t base = *base_ptr;
+  if (base < 2 || base > 36) base = 10;
+
+  size_t used = 0;
+  const char* text = u > 0 ? addr_range_to_ptr(ctx, addr, (ucell_t)u) : NULL;
+  if (text) {
+    bool overflow = false;
+    used = accumulate_digits(text, (size_t)u, (unsigned)base, &value,
+                             &overflow);
+  }
+
+  data_push_double(ctx, (int64_t)value);
+  data_push(ctx, (cell_t)(addr + used));
+  data_push(ctx, u - (cell_t)used);
+}
+
 // S" runtime implementation - pushes address and length of compiled string
 static void f_s_quote_runtime(context_t* ctx, word_t* self) {
   (void)ctx;
@@ -1495,6 +2150,7 @@ static void f_s_quote(context_t* ctx, word_t* self) {
     compile_cell(ctx, length);
 
     // 3. Compile the string data
+    if (!forth_room(ctx, length)) return;
     for (int i = 0; i < length; i++) {
       forth_c_store(ctx, here + i, string_buffer[i]);
     }
@@ -1588,6 +2244,10 @@ static void f_to(context_t* ctx, word_t* self) {
   char* name = parse_name(ctx, name_buffer, sizeof(name_buffer));
   if (!name) error(ctx, "Missing name after 'TO'");
 
+#ifdef FORTH_ENABLE_LOCALS
+  if (*state_ptr != 0 && compile_local_store(ctx, name)) return;
+#endif
+
   word_t* word = search_word(name);
   if (!word) error(ctx, "Word not found: %s", name);
 
@@ -1639,10 +2299,62 @@ static void f_move(context_t* ctx, word_t* self) {
   forth_addr_t addr2 = (forth_addr_t)data_pop(ctx);
   forth_addr_t addr1 = (forth_addr_t)data_pop(ctx);
 
-  if (u > 0) {
-    void* src = addr_to_ptr(ctx, addr1);
-    void* dest = addr_to_ptr(ctx, addr2);
+  if (u <= 0) return;
+
+  void* src = forth_span_ptr(ctx, addr1, (ucell_t)u);
+  void* dest = forth_span_ptr(ctx, addr2, (ucell_t)u);
+  if (src && dest) {
+    memmove(dest, src, (size_t)u);
+  } else {
+    // Report whichever span is bad
+    if (!src) addr_range_to_ptr(ctx, addr1, (ucell_t)u);
+    if (!dest) addr_range_to_ptr(ctx, addr2, (ucell_t)u);
+  }
+}
+
+// CMOVE ( c-addr1 c-addr2 u -- )  Copy from lower addresses to higher
+static void f_cmove(context_t* ctx, word_t* self) {
+  (void)self;
+
+  cell_t u = data_pop(ctx);
+  forth_addr_t addr2 = (forth_addr_t)data_pop(ctx);
+  forth_addr_t addr1 = (forth_addr_t)data_pop(ctx);
+
+  if (u <= 0) return;
+
+  byte_t* src = addr_range_to_ptr(ctx, addr1, (ucell_t)u);
+  byte_t* dest = addr_range_to_ptr(ctx, addr2, (ucell_t)u);
+  if (!src || !dest) return;
+
+  // Only a destination just above the source sees the byte-wise propagation
+  if ((uintptr_t)dest <= (uintptr_t)src ||
+      (uintptr_t)dest >= (uintptr_t)(src + u)) {
     memmove(dest, src, (size_t)u);
+  } else {
+    for (cell_t i = 0; i < u; i++) dest[i] = src[i];
+  }
+}
+
+// CMOVE> ( c-addr1 c-addr2 u -- )  Copy from higher addresses to lower
+static void f_cmove_up(context_t* ctx, word_t* self) {
+  (void)self;
+
+  cell_t u = data_pop(ctx);
+  forth_addr_t addr2 = (forth_addr_t)data_pop(ctx);
+  forth_addr_t addr1 = (forth_addr_t)data_pop(ctx);
+
+  if (u <= 0) return;
+
+  byte_t* src = addr_range_to_ptr(ctx, addr1, (ucell_t)u);
+  byte_t* dest = addr_range_to_ptr(ctx, addr2, (ucell_t)u);
+  if (!src || !dest) return;
+
+  // Only a destination just below the source sees the byte-wise propagation
+  if ((uintptr_t)dest >= (uintptr_t)src ||
+      (uintptr_t)(dest + u) <= (uintptr_t)src) {
+    memmove(dest, src, (size_t)u);
+  } else {
+    for (cell_t i = u - 1; i >= 0; i--) dest[i] = src[i];
   }
 }
 
@@ -1654,9 +2366,26 @@ static void f_fill(context_t* ctx, word_t* self) {
   cell_t u = data_pop(ctx);
   forth_addr_t c_addr = (forth_addr_t)data_pop(ctx);
 
-  if (u > 0) {
-    void* dest = addr_to_ptr(ctx, c_addr);
+  if (u <= 0) return;
+
+  void* dest = forth_span_ptr(ctx, c_addr, (ucell_t)u);
+  if (dest) {
     memset(dest, (char)char_val, (size_t)u);
+  } else {
+    addr_range_to_ptr(ctx, c_addr, (ucell_t)u);  // Reports the bad span
+  }
+}
+
+// ERASE ( addr u -- )
+static void f_erase(context_t* ctx, word_t* self) {
+  (void)self;
+
+  cell_t u = data_pop(ctx);
+  forth_addr_t addr = (forth_addr_t)data_pop(ctx);
+
+  if (u > 0) {
+    void* dest = addr_range_to_ptr(ctx, addr, (ucell_t)u);
+    if (dest) memset(dest, 0, (size_t)u);
   }
 }
 
@@ -1687,7 +2416,7 @@ void create_primitives(void) {
   create_primitive_word("HERE", f_here);
   create_primitive_word("ALLOT", f_allot);
   create_primitive_word(",", f_comma);
-  create_primitive_word("LIT", f_lit);
+  create_operand_primitive_word("LIT", f_lit, WORD_FLAG_OPERAND_CELL);
   create_primitive_word("SM/REM", f_sm_rem);
   create_primitive_word("FM/MOD", f_fm_mod);
   create_primitive_word("AND", f_and);
@@ -1703,6 +2432,11 @@ void create_primitives(void) {
   create_primitive_word("R>", f_r_from);
   create_primitive_word("R@", f_r_fetch);
   create_primitive_word("M*", f_m_star);
+  create_primitive_word("UM*", f_um_star);
+  create_primitive_word("UM/MOD", f_um_slash_mod);
+  create_primitive_word("S>D", f_s_to_d);
+  create_primitive_word("*/", f_star_slash);
+  create_primitive_word("*/MOD", f_star_slash_mod);
   create_primitive_word("U<", f_u_less);
 
   // Create STATE variable (0 = interpret, -1 = compile)
@@ -1714,27 +2448,39 @@ void create_primitives(void) {
   create_primitive_word(":", f_colon);
   create_immediate_primitive_word(";", f_semicolon);
   create_primitive_word("EXIT", f_exit);
+  create_operand_primitive_word("(TAIL)", f_tail_runtime,
+                                WORD_FLAG_OPERAND_CELL);
+  create_immediate_primitive_word("RECURSE", f_recurse);
   create_primitive_word("IMMEDIATE", f_immediate);
+  create_primitive_word("INLINE", f_inline);
+  create_primitive_word("NOINLINE", f_noinline);
 
   // Create helper words first (these are implementation details)
-  create_primitive_word("(S\")", f_s_quote_runtime);
-  create_primitive_word("(.\")", f_dot_quote_runtime);
-  create_primitive_word("(ABORT\")", f_abort_quote_runtime);
+  create_operand_primitive_word("(S\")", f_s_quote_runtime,
+                                WORD_FLAG_OPERAND_STRING);
+  create_operand_primitive_word("(.\")", f_dot_quote_runtime,
+                                WORD_FLAG_OPERAND_STRING);
+  create_operand_primitive_word("(ABORT\")", f_abort_quote_runtime,
+                                WORD_FLAG_OPERAND_STRING);
 
   // Create the user-visible immediate words
   create_immediate_primitive_word("S\"", f_s_quote);
   create_immediate_primitive_word(".\"", f_dot_quote);
   create_immediate_primitive_word("ABORT\"", f_abort_quote);
 
-  create_area_word("PAD");
-  forth_allot(&main_context, FORTH_PAD_SIZE);
+  create_primitive_word("PAD", f_pad);
 
   create_primitive_word("CREATE", f_create);
+  create_primitive_word("(DOES>)", f_does_code);
+  create_immediate_primitive_word("DOES>", f_does);
   create_primitive_word("VARIABLE", f_variable);
 
-  create_primitive_word("0BRANCH", f_0branch);
-  create_primitive_word("BRANCH", f_branch);
+  create_operand_primitive_word("0BRANCH", f_0branch,
+                                WORD_FLAG_OPERAND_CELL | WORD_FLAG_BRANCH);
+  create_operand_primitive_word("BRANCH", f_branch,
+                                WORD_FLAG_OPERAND_CELL | WORD_FLAG_BRANCH);
   create_immediate_primitive_word("[']", f_bracket_tick);
+  create_immediate_primitive_word("LITERAL", f_literal);
   create_primitive_word("'", f_tick);
   create_primitive_word("EXECUTE", f_execute);
   create_primitive_word("FIND", f_find);
@@ -1742,21 +2488,45 @@ void create_primitives(void) {
 
   // Runtime primitives (not immediate)
   create_primitive_word("(DO)", f_do_runtime);
-  create_primitive_word("(LOOP)", f_loop_runtime);
-  create_primitive_word("(+LOOP)", f_plus_loop_runtime);
-  create_primitive_word("(LEAVE)", f_leave_runtime);
+  create_operand_primitive_word("(?DO)", f_question_do_runtime,
+                                WORD_FLAG_OPERAND_CELL | WORD_FLAG_BRANCH);
+  create_operand_primitive_word("(LOOP)", f_loop_runtime,
+                                WORD_FLAG_OPERAND_CELL | WORD_FLAG_BRANCH);
+  create_operand_primitive_word("(+LOOP)", f_plus_loop_runtime,
+                                WORD_FLAG_OPERAND_CELL | WORD_FLAG_BRANCH);
+  create_operand_primitive_word("(LEAVE)", f_leave_runtime,
+                                WORD_FLAG_OPERAND_CELL | WORD_FLAG_BRANCH);
   create_primitive_word("I", f_i);
   create_primitive_word("J", f_j);
   create_primitive_word("UNLOOP", f_unloop);
 
   // Compilation words (immediate)
+  create_immediate_primitive_word("IF", f_if);
+  create_immediate_primitive_word("ELSE", f_else);
+  create_immediate_primitive_word("THEN", f_then);
+  create_immediate_primitive_word("BEGIN", f_begin);
+  create_immediate_primitive_word("AGAIN", f_again);
+  create_immediate_primitive_word("UNTIL", f_until);
+  create_immediate_primitive_word("WHILE", f_while);
+  create_immediate_primitive_word("REPEAT", f_repeat);
   create_immediate_primitive_word("DO", f_do);
+  create_immediate_primitive_word("?DO", f_question_do);
   create_immediate_primitive_word("LOOP", f_loop);
   create_immediate_primitive_word("+LOOP", f_plus_loop);
   create_immediate_primitive_word("LEAVE", f_leave);
 
+  create_operand_primitive_word("(OF)", f_of_runtime,
+                                WORD_FLAG_OPERAND_CELL | WORD_FLAG_BRANCH);
+  create_operand_primitive_word("(SWITCH)", f_switch_runtime,
+                                WORD_FLAG_OPERAND_STRING);
+  create_immediate_primitive_word("CASE", f_case);
+  create_immediate_primitive_word("OF", f_of);
+  create_immediate_primitive_word("ENDOF", f_endof);
+  create_immediate_primitive_word("ENDCASE", f_endcase);
+
   create_primitive_word("WORD", f_word);
   create_primitive_word("ACCEPT", f_accept);
+  create_primitive_word(">NUMBER", f_to_number);
 
   create_immediate_primitive_word("\\", f_backslash);
 
@@ -1764,18 +2534,18 @@ void create_primitives(void) {
   create_primitive_word("CONST", f_constant);  // synonym for CONSTANT
   create_primitive_word("VALUE", f_value);
   create_immediate_primitive_word("TO", f_to);
-  create_primitive_word("(TO)", f_to_runtime);
+  create_operand_primitive_word("(TO)", f_to_runtime,
+                                WORD_FLAG_OPERAND_CELL);
 
   create_primitive_word("MOVE", f_move);
   create_primitive_word("FILL", f_fill);
+  create_primitive_word("CMOVE", f_cmove);
+  create_primitive_word("CMOVE>", f_cmove_up);
+  create_primitive_word("ERASE", f_erase);
 }
 
 // Built-in Forth definitions (created after primitives are available)
 static const char* builtin_definitions[] = {
-    ": IF    ['] 0BRANCH ,  HERE  0 , ; IMMEDIATE",
-    ": THEN  HERE  SWAP  ! ; IMMEDIATE",
-    ": ELSE  ['] BRANCH ,  HERE  0 ,  SWAP  HERE  SWAP  ! ; IMMEDIATE",
-
     // Stack manipulation words
     ": DUP 0 PICK ;", ": OVER 1 PICK ;", ": 2DUP OVER OVER ;",
     ": NIP SWAP DROP ;", ": TUCK SWAP OVER ;", ": 2DROP DROP DROP ;",
@@ -1793,9 +2563,8 @@ static const char* builtin_definitions[] = {
     ": U>= U< NOT ;",  // Unsigned greater than or equal
     ": 2* DUP + ;", ": 2/ 2 / ;",
 
-    ": MOD SM/REM DROP ;",
-    ": /MOD DUP >R 0 SWAP SM/REM R> 0< IF SWAP NEGATE SWAP THEN ;",
-    ": */ >R M* R> FM/MOD SWAP DROP ;", ": */MOD >R M* R> FM/MOD ;",
+    // Symmetric like '/', so n1 = n2 * (n1 n2 /) + (n1 n2 MOD)
+    ": /MOD >R S>D R> SM/REM ;", ": MOD /MOD DROP ;",
 
     ": CELL+ 4 + ;", ": CELLS 4 * ;", ": CHAR+ 1+ ;",
     ": CHARS ;",  // No-op
@@ -1834,11 +2603,6 @@ static const char* builtin_definitions[] = {
     // BOUNDS ( addr1 u -- addr2 addr1 ) - Not required but useful for loops
     ": BOUNDS OVER + SWAP ;",
 
-    ": BEGIN  HERE ; IMMEDIATE", ": AGAIN  ['] BRANCH , , ; IMMEDIATE",
-    ": UNTIL  ['] 0BRANCH , , ; IMMEDIATE",
-    ": WHILE  ['] 0BRANCH , HERE 0 , SWAP ; IMMEDIATE",
-    ": REPEAT ['] BRANCH , , HERE SWAP ! ; IMMEDIATE",
-
     ": SPACE BL EMIT ;", ": SPACES BEGIN DUP WHILE SPACE 1- REPEAT DROP ;",
 
     ": ALIGN HERE 3 + 3 INVERT AND HERE - ALLOT ;",
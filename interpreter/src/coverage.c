@@ -0,0 +1,159 @@
+#include "coverage.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include "debug.h"
+#include "dictionary.h"
+#include "memory.h"
+#include "test.h"
+
+#ifdef FORTH_ENABLE_TESTS
+
+// Coverage state - bits survive forth_reset() so a whole test run accumulates
+bool coverage_enabled = false;
+uint8_t coverage_bits[COVERAGE_BITSET_SIZE];
+
+bool coverage_marked(forth_addr_t addr) {
+  if (addr >= FORTH_MEMORY_SIZE) return false;
+
+  forth_addr_t cell = addr / sizeof(cell_t);
+  return (coverage_bits[cell >> 3] >> (cell & 7)) & 1;
+}
+
+// Clear all marks and start collecting
+void coverage_start(void) {
+  memset(coverage_bits, 0, sizeof(coverage_bits));
+  coverage_enabled = true;
+}
+
+void coverage_stop(void) { coverage_enabled = false; }
+
+// Clear marks at or above addr. Called when that memory is about to be reused
+// by different definitions (forth_reset between tests), so stale marks from a
+// previous test don't count for whatever gets compiled there next.
+void coverage_forget(forth_addr_t addr) {
+  for (forth_addr_t a = align_up(addr, sizeof(cell_t)); a < FORTH_MEMORY_SIZE;
+       a += sizeof(cell_t)) {
+    forth_addr_t cell = a / sizeof(cell_t);
+    coverage_bits[cell >> 3] &= (uint8_t)~(1u << (cell & 7));
+  }
+}
+
+// Print names of words in [from, to) that never executed, WORDS-style
+static int report_unexecuted(word_t* from, word_t* to, int* total) {
+  int width = 16;
+  int columns = 5;
+  int count = 0;
+
+  *total = 0;
+  for (word_t* word = from; word != to; word = word->link) {
+    (*total)++;
+    if (coverage_marked((byte_t*)word - forth_memory)) continue;
+
+    printf("  %-*s", width, word->name);
+    count++;
+    if (count % columns == 0) printf("\n");
+  }
+  if (count % columns != 0) printf("\n");
+
+  return count;
+}
+
+// Report branch targets in colon definitions that were never reached
+static void report_branches(context_t* ctx, int* sites, int* reached) {
+  word_t* zero_branch = search_word("0BRANCH");
+  word_t* branch = search_word("BRANCH");
+
+  *sites = 0;
+  *reached = 0;
+
+  for (word_t* word = dictionary_head; word != NULL; word = word->link) {
+    if (!is_colon_definition(word)) continue;
+
+    forth_addr_t end = definition_end(word);
+    for (forth_addr_t ip = word->param.address; ip < end;
+         ip = next_token(ctx, ip)) {
+      word_t* token = addr_to_ptr(ctx, forth_fetch(ctx, ip));
+      if (token != zero_branch && token != branch) continue;
+
+      forth_addr_t target = forth_fetch(ctx, ip + sizeof(cell_t));
+      (*sites)++;
+
+      if (coverage_marked(target)) {
+        (*reached)++;
+      } else {
+        printf("  %-16s %s at +%u -> +%u\n", word->name, token->name,
+               ip - word->param.address, target - word->param.address);
+      }
+    }
+  }
+}
+
+// Print which builtin and user definitions never ran
+void coverage_report(context_t* ctx) {
+  int missed, total, sites, reached;
+
+  printf("\n===== Coverage Report =====\n");
+
+  if (builtin_dictionary_head != dictionary_head) {
+    printf("User words never executed:\n");
+    missed =
+        report_unexecuted(dictionary_head, builtin_dictionary_head, &total);
+    printf("User words: %d of %d executed\n\n", total - missed, total);
+  }
+
+  printf("Builtin words never executed:\n");
+  missed = report_unexecuted(builtin_dictionary_head, NULL, &total);
+  printf("Builtin words: %d of %d executed\n\n", total - missed, total);
+
+  printf("Branch targets never reached:\n");
+  report_branches(ctx, &sites, &reached);
+  printf("Branch targets: %d of %d reached\n", reached, sites);
+
+  fflush(stdout);
+}
+
+// COVERAGE-ON ( -- ) Clear coverage marks and start collecting
+static void f_coverage_on(context_t* ctx, word_t* self) {
+  (void)ctx;
+  (void)self;
+
+  coverage_start();
+}
+
+// COVERAGE-OFF ( -- ) Stop collecting coverage (marks are kept)
+static void f_coverage_off(context_t* ctx, word_t* self) {
+  (void)ctx;
+  (void)self;
+
+  coverage_stop();
+}
+
+// COVERAGE-REPORT ( -- ) Report words and branch targets never executed
+static void f_coverage_report(context_t* ctx, word_t* self) {
+  (void)self;
+
+  coverage_report(ctx);
+}
+
+// TEST-COVERAGE ( -- ) Run the unit tests with coverage and report
+static void f_test_coverage(context_t* ctx, word_t* self) {
+  (void)self;
+
+  coverage_start();
+  run_all_tests();
+  coverage_stop();
+  coverage_report(ctx);
+}
+
+void create_coverage_primitives(void) {
+  create_primitive_word("COVERAGE-ON", f_coverage_on);
+  create_primitive_word("COVERAGE-OFF", f_coverage_off);
+  create_primitive_word("COVERAGE-REPORT", f_coverage_report);
+  create_primitive_word("TEST-COVERAGE", f_test_coverage);
+
+  debug("Coverage primitives created");
+}
+
+#endif  // FORTH_ENABLE_TESTS
@@ -5,44 +5,97 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include "allocate.h"
+#include "array.h"
+#include "bench.h"
 #include "core.h"
+#include "coverage.h"
 #include "debug.h"
+#include "double.h"
 #include "error.h"
+#include "float_array.h"
 #include "floating.h"
 #include "forth.h"
+#include "jit.h"
+#include "locals.h"
 #include "memory.h"
+#include "pictured.h"
 #include "stack.h"
+#include "string_words.h"
+#include "structure.h"
 #include "test.h"
 #include "text.h"
 #include "tools.h"
+#include "verify.h"
 
 // Dictionary head points to the most recently defined word
 word_t* dictionary_head = NULL;
 
+// Boundary between builtin and user words (set at end of dictionary_init)
+word_t* builtin_dictionary_head = NULL;
+forth_addr_t builtin_here = 0;
+
 // Initialize empty dictionary
 void dictionary_init(void) {
   dictionary_head = NULL;
+  builtin_here = 0;  // Nothing counts as a builtin until they all exist
+
+#ifdef FORTH_ENABLE_JIT
+  jit_reset();
+#endif
+
   create_primitives();
   create_builtin_definitions();
+  create_array_primitives();
+  create_pictured_primitives();
+  create_structure_primitives();
 
 #ifdef FORTH_ENABLE_TOOLS
   create_tools_primitives();
   create_tools_definitions();
 #endif
 
+#ifdef FORTH_ENABLE_ALLOCATE
+  create_allocate_primitives();
+#endif
+
+#ifdef FORTH_ENABLE_STRING
+  create_string_primitives();
+#endif
+
+#ifdef FORTH_ENABLE_DOUBLE
+  create_double_primitives();
+#endif
+
+#ifdef FORTH_ENABLE_LOCALS
+  create_locals_primitives();
+#endif
+
 #ifdef FORTH_ENABLE_FLOATING
   create_floating_primitives();
+  create_float_array_primitives();
   create_floating_definitions();
 #endif
 
 #ifdef FORTH_ENABLE_TESTS
   create_test_primitives();
+  create_coverage_primitives();
+  create_bench_primitives();
 #endif
 
 #ifdef FORTH_DEBUG_ENABLED
   create_primitive_word("DEBUG-ON", f_debug_on);
   create_primitive_word("DEBUG-OFF", f_debug_off);
 #endif
+
+#ifdef FORTH_ENABLE_JIT
+  jit_init();
+#endif
+
+  builtin_dictionary_head = dictionary_head;
+  builtin_here = here;
+
+  verify_init();
 }
 
 // Link a word into the dictionary (at the head of the linked list)
@@ -51,8 +104,8 @@ void link_word(word_t* word) {
   dictionary_head = word;        // Make this word the new head
 }
 
-// Add this helper function to dictionary.c
-static int case_insensitive_strcmp(const char* a, const char* b) {
+// Compare names the way the dictionary does
+int case_insensitive_strcmp(const char* a, const char* b) {
   while (*a && *b) {
     int ca = tolower(*a);
     int cb = tolower(*b);
@@ -139,6 +192,16 @@ word_t* create_immediate_primitive_word(const char* name,
   return word;
 }
 
+// Create a primitive that reads inline operands compiled after its token
+word_t* create_operand_primitive_word(const char* name,
+                                      void (*cfunc)(context_t* ctx,
+                                                    word_t* self),
+                                      uint32_t operand_flags) {
+  word_t* word = create_primitive_word(name, cfunc);
+  word->flags |= operand_flags;
+  return word;
+}
+
 // Compile a word reference into the current definition
 void compile_word(context_t* ctx, word_t* word) {
   if (!word) {
@@ -157,6 +220,7 @@ void compile_word(context_t* ctx, word_t* word) {
 // Compile a cell value into the current definition
 void compile_cell(context_t* ctx, cell_t value) {
   // Store the value at HERE and advance HERE
+  if (!forth_room(ctx, sizeof(cell_t))) return;
   forth_store(ctx, here, value);
   here += sizeof(cell_t);
 
@@ -187,6 +251,9 @@ word_t* defining_word(context_t* ctx,
   word->param.address =
       here;  // Set parameter field to point to next free space
   word->param_type = PARAM_ADDRESS;
+#ifdef FORTH_ENABLE_JIT
+  word->jit_calls = 0;
+#endif
   link_word(word);
 
   return word;
@@ -196,6 +263,7 @@ word_t* defining_word(context_t* ctx,
 void execute_word(context_t* ctx, word_t* word) {
   require(ctx, word != NULL);
   require(ctx, word->cfunc != NULL);
+  coverage_hit((byte_t*)word - forth_memory);
   word->cfunc(ctx, word);
 }
 
@@ -227,27 +295,66 @@ forth_addr_t store_counted_string(context_t* ctx, const char* str, int length) {
   return string_addr;
 }
 
+// Return the address of the token after the one at ip, skipping any inline
+// operands the token carries (literal values, branch targets, strings)
+forth_addr_t next_token(context_t* ctx, forth_addr_t ip) {
+  word_t* word = addr_to_ptr(ctx, forth_fetch(ctx, ip));
+  ip += sizeof(cell_t);
+
+  if (word->flags & WORD_FLAG_OPERAND_CELL) {
+    ip += sizeof(cell_t);
+  } else if (word->flags & WORD_FLAG_OPERAND_FLOAT) {
+    ip += 2 * sizeof(cell_t);
+  } else if (word->flags & WORD_FLAG_OPERAND_STRING) {
+    cell_t length = forth_fetch(ctx, ip);
+    ip = align_up(ip + sizeof(cell_t) + length, sizeof(cell_t));
+  }
+
+  return ip;
+}
+
+// End of a word's compiled body: the header of the next word defined after
+// it, or HERE for the most recent definition
+forth_addr_t definition_end(word_t* word) {
+  word_t* next = NULL;
+
+  for (word_t* current = dictionary_head; current != word;
+       current = current->link) {
+    if (current == NULL) return here;
+    next = current;
+  }
+
+  return next ? (forth_addr_t)((byte_t*)next - forth_memory) : here;
+}
+
 // Execute a colon definition using the return stack
 void execute_colon(context_t* ctx, word_t* self) {
-  // Parameter field contains array of tokens (word addresses)
-  forth_addr_t tokens_addr =
-      self->param.address;  // parameter field points to actual parameter
-                            // space (word definition)
-
   debug("Executing colon definition: %s", self->name);
 
-  // Save current instruction pointer on return stack (if executing)
-  if (ctx->ip != 0) {
-    return_push(ctx, (cell_t)ctx->ip);
-    debug("  Saved IP on return stack");
+#if defined(FORTH_ENABLE_JIT) && JIT_THRESHOLD > 0
+  // Hot definitions go native from their next call
+  if (self->jit_calls < JIT_THRESHOLD && ++self->jit_calls == JIT_THRESHOLD) {
+    jit_compile(self);
   }
+#endif
+
+  // Save the caller's instruction pointer on the return stack. At the top
+  // level it is 0, so the final EXIT still ends execution with ip = 0.
+  int frame = ctx->return_stack_ptr;
+  return_push(ctx, (cell_t)ctx->ip);
 
-  // Set new instruction pointer to start of this definition's tokens
-  ctx->ip = tokens_addr;
+  // Parameter field points to the definition's tokens
+  ctx->ip = self->param.address;
+  if (!execute_verified(ctx, self, frame)) execute_tokens(ctx, frame);
+
+  debug("Colon definition execution complete");
+}
 
-  // Execute tokens until EXIT is called (which will restore IP from return
-  // stack)
-  while (ctx->ip != 0) {
+// Execute tokens from ctx->ip until the EXIT that pops the frame. Stopping
+// there (rather than running on in the caller's tokens) keeps C recursion
+// bounded by the call depth instead of growing with every call made.
+void execute_tokens(context_t* ctx, int frame) {
+  while (ctx->return_stack_ptr > frame) {
     forth_addr_t token_addr = forth_fetch(ctx, ctx->ip);
     ctx->ip += sizeof(cell_t);  // Advance to next token
 
@@ -255,11 +362,15 @@ void execute_colon(context_t* ctx, word_t* self) {
     word_t* word = addr_to_ptr(NULL, token_addr);
     debug("  Executing token: %s", word->name);
     execute_word(ctx, word);
-
-    // If EXIT was called, ctx->ip will have been updated
   }
+}
 
-  debug("Colon definition execution complete");
+// Threaded colon definitions, and those the JIT turned into native code
+bool is_colon_definition(word_t* word) {
+#ifdef FORTH_ENABLE_JIT
+  if (jit_compiled(word)) return true;
+#endif
+  return word->cfunc == execute_colon;
 }
 
 // ============================================================================
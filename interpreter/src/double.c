@@ -0,0 +1,181 @@
+#include "double.h"
+
+#include <stdio.h>
+
+#include "core.h"
+#include "debug.h"
+#include "dictionary.h"
+#include "error.h"
+#include "memory.h"
+#include "stack.h"
+#include "util.h"
+
+#ifdef FORTH_ENABLE_DOUBLE
+
+// Arithmetic goes through uint64_t so overflow wraps like cell arithmetic
+static inline int64_t wrap_add(int64_t a, int64_t b) {
+  return (int64_t)((uint64_t)a + (uint64_t)b);
+}
+
+static inline int64_t wrap_mul(int64_t a, int64_t b) {
+  return (int64_t)((uint64_t)a * (uint64_t)b);
+}
+
+// D+ ( d1 d2 -- d3 )
+static void f_d_plus(context_t* ctx, word_t* self) {
+  (void)self;
+
+  int64_t d2 = data_pop_double(ctx);
+  int64_t d1 = data_pop_double(ctx);
+  data_push_double(ctx, wrap_add(d1, d2));
+}
+
+// D- ( d1 d2 -- d3 )
+static void f_d_minus(context_t* ctx, word_t* self) {
+  (void)self;
+
+  int64_t d2 = data_pop_double(ctx);
+  int64_t d1 = data_pop_double(ctx);
+  data_push_double(ctx, wrap_add(d1, wrap_mul(d2, -1)));
+}
+
+// D* ( d1 d2 -- d3 )  Low 64 bits of the product
+static void f_d_star(context_t* ctx, word_t* self) {
+  (void)self;
+
+  int64_t d2 = data_pop_double(ctx);
+  int64_t d1 = data_pop_double(ctx);
+  data_push_double(ctx, wrap_mul(d1, d2));
+}
+
+// M+ ( d1 n -- d2 )
+static void f_m_plus(context_t* ctx, word_t* self) {
+  (void)self;
+
+  cell_t n = data_pop(ctx);
+  int64_t d1 = data_pop_double(ctx);
+  data_push_double(ctx, wrap_add(d1, n));
+}
+
+// DNEGATE ( d1 -- d2 )
+static void f_dnegate(context_t* ctx, word_t* self) {
+  (void)self;
+
+  data_push_double(ctx, wrap_mul(data_pop_double(ctx), -1));
+}
+
+// DABS ( d -- ud )
+static void f_dabs(context_t* ctx, word_t* self) {
+  (void)self;
+
+  int64_t d = data_pop_double(ctx);
+  data_push_double(ctx, d < 0 ? wrap_mul(d, -1) : d);
+}
+
+// D< ( d1 d2 -- flag )
+static void f_d_less(context_t* ctx, word_t* self) {
+  (void)self;
+
+  int64_t d2 = data_pop_double(ctx);
+  int64_t d1 = data_pop_double(ctx);
+  data_push(ctx, d1 < d2 ? -1 : 0);
+}
+
+// D= ( d1 d2 -- flag )
+static void f_d_equal(context_t* ctx, word_t* self) {
+  (void)self;
+
+  int64_t d2 = data_pop_double(ctx);
+  int64_t d1 = data_pop_double(ctx);
+  data_push(ctx, d1 == d2 ? -1 : 0);
+}
+
+// D0= ( d -- flag )
+static void f_d_zero_equal(context_t* ctx, word_t* self) {
+  (void)self;
+
+  data_push(ctx, data_pop_double(ctx) == 0 ? -1 : 0);
+}
+
+// D0< ( d -- flag )
+static void f_d_zero_less(context_t* ctx, word_t* self) {
+  (void)self;
+
+  data_push(ctx, data_pop_double(ctx) < 0 ? -1 : 0);
+}
+
+// D>S ( d -- n )  Requires d to be in single-cell range
+static void f_d_to_s(context_t* ctx, word_t* self) {
+  (void)self;
+
+  int64_t d = data_pop_double(ctx);
+  require(ctx, d >= INT32_MIN && d <= INT32_MAX);
+  data_push(ctx, (cell_t)d);
+}
+
+// D. ( d -- )  Display d in the current BASE
+static void f_d_dot(context_t* ctx, word_t* self) {
+  (void)self;
+
+  int64_t d = data_pop_double(ctx);
+  cell_t base = *base_ptr;
+
+  // Validate base range, fall back to decimal if invalid
+  if (base < 2 || base > 36) {
+    base = 10;
+  }
+
+  print_double_in_base(d, base);
+  putchar(' ');
+  fflush(stdout);
+}
+
+// 2CONSTANT runtime: push the two cells stored in the data field
+void f_2constant_runtime(context_t* ctx, word_t* self) {
+  forth_addr_t addr = self->param.address;
+
+  data_push(ctx, forth_fetch(ctx, addr + sizeof(cell_t)));
+  data_push(ctx, forth_fetch(ctx, addr));
+}
+
+// 2CONSTANT ( x1 x2 "name" -- )  Same cell layout as 2! (x2 first)
+static void f_2constant(context_t* ctx, word_t* self) {
+  (void)self;
+
+  cell_t x2 = data_pop(ctx);
+  cell_t x1 = data_pop(ctx);
+
+  defining_word(ctx, f_2constant_runtime);
+  compile_cell(ctx, x2);
+  compile_cell(ctx, x1);
+}
+
+// 2VARIABLE ( "name" -- )  Two cells of data space, initialized to zero
+static void f_2variable(context_t* ctx, word_t* self) {
+  (void)self;
+
+  defining_word(ctx, f_param_field);
+  compile_cell(ctx, 0);
+  compile_cell(ctx, 0);
+}
+
+void create_double_primitives(void) {
+  create_primitive_word("D+", f_d_plus);
+  create_primitive_word("D-", f_d_minus);
+  create_primitive_word("D*", f_d_star);
+  create_primitive_word("M+", f_m_plus);
+  create_primitive_word("DNEGATE", f_dnegate);
+  create_primitive_word("DABS", f_dabs);
+  create_primitive_word("D<", f_d_less);
+  create_primitive_word("D=", f_d_equal);
+  create_primitive_word("D0=", f_d_zero_equal);
+  create_primitive_word("D0<", f_d_zero_less);
+  create_primitive_word("D>S", f_d_to_s);
+  create_primitive_word("D.", f_d_dot);
+  create_primitive_word("2CONSTANT", f_2constant);
+  create_primitive_word("2VARIABLE", f_2variable);
+
+  debug("Double-Number primitives created");
+}
+
+#endif  // FORTH_ENABLE_DOUBLE
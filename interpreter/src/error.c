@@ -7,8 +7,12 @@
 #include "repl.h"
 #include "stack.h"
 
+unsigned error_count = 0;
+
 void error(context_t* ctx, const char* format, ...) {
   va_list args;
+  error_count++;
+
   va_start(args, format);
   printf("ERROR: ");
   vprintf(format, args);
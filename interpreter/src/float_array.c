@@ -0,0 +1,451 @@
+#include "float_array.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "debug.h"
+#include "dictionary.h"
+#include "error.h"
+#include "floating.h"
+#include "stack.h"
+
+#ifdef FORTH_ENABLE_FLOATING
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#if defined(__GNUC__)
+#include <immintrin.h>
+#define FLOAT_ARRAY_HAVE_AVX 1  // Built with target("avx"), used if supported
+#endif
+#endif
+
+// Rows and columns per FMATMUL tile: a 32x32 tile of B is 8KB and stays in L1
+#define FMATMUL_BLOCK 32
+
+/*
+ * Kernels
+ * =======
+ * Each kernel exists in plain C, SSE2 (two doubles per vector) and AVX (four
+ * per vector); select_float_kernels() picks the widest one the CPU supports.
+ * Reductions keep two vector accumulators to hide the add latency. Forth
+ * addresses are only cell-aligned, so every vector load and store is
+ * unaligned. FMATMUL is plain C that tiles the product and hands each row
+ * strip to the AXPY kernel.
+ */
+
+static double sum_scalar(const double* a, size_t n) {
+  double sum = 0.0;
+  for (size_t i = 0; i < n; i++) sum += a[i];
+  return sum;
+}
+
+static double dot_scalar(const double* a, const double* b, size_t n) {
+  double sum = 0.0;
+  for (size_t i = 0; i < n; i++) sum += a[i] * b[i];
+  return sum;
+}
+
+static void scale_scalar(double* a, size_t n, double r) {
+  for (size_t i = 0; i < n; i++) a[i] *= r;
+}
+
+static void axpy_scalar(double r, const double* x, double* y, size_t n) {
+  for (size_t i = 0; i < n; i++) y[i] += r * x[i];
+}
+
+static void add_scalar(const double* a, const double* b, double* c, size_t n) {
+  for (size_t i = 0; i < n; i++) c[i] = a[i] + b[i];
+}
+
+static void mul_scalar(const double* a, const double* b, double* c, size_t n) {
+  for (size_t i = 0; i < n; i++) c[i] = a[i] * b[i];
+}
+
+#if defined(__SSE2__)
+
+static inline double hsum_pd(__m128d v) {
+  return _mm_cvtsd_f64(_mm_add_sd(v, _mm_unpackhi_pd(v, v)));
+}
+
+static double sum_sse2(const double* a, size_t n) {
+  __m128d acc0 = _mm_setzero_pd();
+  __m128d acc1 = _mm_setzero_pd();
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    acc0 = _mm_add_pd(acc0, _mm_loadu_pd(a + i));
+    acc1 = _mm_add_pd(acc1, _mm_loadu_pd(a + i + 2));
+  }
+  return hsum_pd(_mm_add_pd(acc0, acc1)) + sum_scalar(a + i, n - i);
+}
+
+static double dot_sse2(const double* a, const double* b, size_t n) {
+  __m128d acc0 = _mm_setzero_pd();
+  __m128d acc1 = _mm_setzero_pd();
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    acc0 = _mm_add_pd(acc0,
+                      _mm_mul_pd(_mm_loadu_pd(a + i), _mm_loadu_pd(b + i)));
+    acc1 = _mm_add_pd(
+        acc1, _mm_mul_pd(_mm_loadu_pd(a + i + 2), _mm_loadu_pd(b + i + 2)));
+  }
+  return hsum_pd(_mm_add_pd(acc0, acc1)) + dot_scalar(a + i, b + i, n - i);
+}
+
+static void scale_sse2(double* a, size_t n, double r) {
+  const __m128d f = _mm_set1_pd(r);
+  size_t i = 0;
+  for (; i + 2 <= n; i += 2) {
+    _mm_storeu_pd(a + i, _mm_mul_pd(_mm_loadu_pd(a + i), f));
+  }
+  scale_scalar(a + i, n - i, r);
+}
+
+static void axpy_sse2(double r, const double* x, double* y, size_t n) {
+  const __m128d f = _mm_set1_pd(r);
+  size_t i = 0;
+  for (; i + 2 <= n; i += 2) {
+    __m128d product = _mm_mul_pd(_mm_loadu_pd(x + i), f);
+    _mm_storeu_pd(y + i, _mm_add_pd(_mm_loadu_pd(y + i), product));
+  }
+  axpy_scalar(r, x + i, y + i, n - i);
+}
+
+static void add_sse2(const double* a, const double* b, double* c, size_t n) {
+  size_t i = 0;
+  for (; i + 2 <= n; i += 2) {
+    _mm_storeu_pd(c + i, _mm_add_pd(_mm_loadu_pd(a + i), _mm_loadu_pd(b + i)));
+  }
+  add_scalar(a + i, b + i, c + i, n - i);
+}
+
+static void mul_sse2(const double* a, const double* b, double* c, size_t n) {
+  size_t i = 0;
+  for (; i + 2 <= n; i += 2) {
+    _mm_storeu_pd(c + i, _mm_mul_pd(_mm_loadu_pd(a + i), _mm_loadu_pd(b + i)));
+  }
+  mul_scalar(a + i, b + i, c + i, n - i);
+}
+
+#endif  // __SSE2__
+
+#ifdef FLOAT_ARRAY_HAVE_AVX
+
+__attribute__((target("avx"))) static inline double hsum256_pd(__m256d v) {
+  return hsum_pd(
+      _mm_add_pd(_mm256_castpd256_pd128(v), _mm256_extractf128_pd(v, 1)));
+}
+
+__attribute__((target("avx"))) static double sum_avx(const double* a,
+                                                     size_t n) {
+  __m256d acc0 = _mm256_setzero_pd();
+  __m256d acc1 = _mm256_setzero_pd();
+  size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    acc0 = _mm256_add_pd(acc0, _mm256_loadu_pd(a + i));
+    acc1 = _mm256_add_pd(acc1, _mm256_loadu_pd(a + i + 4));
+  }
+  return hsum256_pd(_mm256_add_pd(acc0, acc1)) + sum_sse2(a + i, n - i);
+}
+
+__attribute__((target("avx"))) static double dot_avx(const double* a,
+                                                     const double* b,
+                                                     size_t n) {
+  __m256d acc0 = _mm256_setzero_pd();
+  __m256d acc1 = _mm256_setzero_pd();
+  size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    acc0 = _mm256_add_pd(
+        acc0, _mm256_mul_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i)));
+    acc1 = _mm256_add_pd(acc1, _mm256_mul_pd(_mm256_loadu_pd(a + i + 4),
+                                             _mm256_loadu_pd(b + i + 4)));
+  }
+  return hsum256_pd(_mm256_add_pd(acc0, acc1)) +
+         dot_sse2(a + i, b + i, n - i);
+}
+
+__attribute__((target("avx"))) static void scale_avx(double* a, size_t n,
+                                                     double r) {
+  const __m256d f = _mm256_set1_pd(r);
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    _mm256_storeu_pd(a + i, _mm256_mul_pd(_mm256_loadu_pd(a + i), f));
+  }
+  scale_sse2(a + i, n - i, r);
+}
+
+__attribute__((target("avx"))) static void axpy_avx(double r, const double* x,
+                                                    double* y, size_t n) {
+  const __m256d f = _mm256_set1_pd(r);
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    __m256d product = _mm256_mul_pd(_mm256_loadu_pd(x + i), f);
+    _mm256_storeu_pd(y + i, _mm256_add_pd(_mm256_loadu_pd(y + i), product));
+  }
+  axpy_sse2(r, x + i, y + i, n - i);
+}
+
+__attribute__((target("avx"))) static void add_avx(const double* a,
+                                                   const double* b, double* c,
+                                                   size_t n) {
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    _mm256_storeu_pd(
+        c + i, _mm256_add_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i)));
+  }
+  add_sse2(a + i, b + i, c + i, n - i);
+}
+
+__attribute__((target("avx"))) static void mul_avx(const double* a,
+                                                   const double* b, double* c,
+                                                   size_t n) {
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    _mm256_storeu_pd(
+        c + i, _mm256_mul_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i)));
+  }
+  mul_sse2(a + i, b + i, c + i, n - i);
+}
+
+#endif  // FLOAT_ARRAY_HAVE_AVX
+
+// Kernels in use, chosen once by select_float_kernels()
+static double (*sum_kernel)(const double*, size_t) = sum_scalar;
+static double (*dot_kernel)(const double*, const double*, size_t) = dot_scalar;
+static void (*scale_kernel)(double*, size_t, double) = scale_scalar;
+static void (*axpy_kernel)(double, const double*, double*, size_t) =
+    axpy_scalar;
+static void (*add_kernel)(const double*, const double*, double*, size_t) =
+    add_scalar;
+static void (*mul_kernel)(const double*, const double*, double*, size_t) =
+    mul_scalar;
+
+static void select_float_kernels(void) {
+#if defined(__SSE2__)
+  sum_kernel = sum_sse2;
+  dot_kernel = dot_sse2;
+  scale_kernel = scale_sse2;
+  axpy_kernel = axpy_sse2;
+  add_kernel = add_sse2;
+  mul_kernel = mul_sse2;
+#endif
+
+#ifdef FLOAT_ARRAY_HAVE_AVX
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx")) {
+    sum_kernel = sum_avx;
+    dot_kernel = dot_avx;
+    scale_kernel = scale_avx;
+    axpy_kernel = axpy_avx;
+    add_kernel = add_avx;
+    mul_kernel = mul_avx;
+    debug("Float-array kernels: AVX");
+  }
+#endif
+}
+
+double floats_sum(const double* a, ucell_t n) { return sum_kernel(a, n); }
+
+double floats_dot(const double* a, const double* b, ucell_t n) {
+  return dot_kernel(a, b, n);
+}
+
+void floats_scale(double* a, ucell_t n, double r) { scale_kernel(a, n, r); }
+
+void floats_axpy(double r, const double* x, double* y, ucell_t n) {
+  axpy_kernel(r, x, y, n);
+}
+
+void floats_add(const double* a, const double* b, double* c, ucell_t n) {
+  add_kernel(a, b, c, n);
+}
+
+void floats_mul(const double* a, const double* b, double* c, ucell_t n) {
+  mul_kernel(a, b, c, n);
+}
+
+void floats_matmul(const double* a, const double* b, double* c, ucell_t m,
+                   ucell_t n, ucell_t p) {
+  for (size_t i = 0; i < (size_t)m * p; i++) c[i] = 0.0;
+
+  // One tile of B (rows kk.., columns jj..) is reused for every row of A
+  for (ucell_t kk = 0; kk < n; kk += FMATMUL_BLOCK) {
+    ucell_t k_end = kk + FMATMUL_BLOCK < n ? kk + FMATMUL_BLOCK : n;
+
+    for (ucell_t jj = 0; jj < p; jj += FMATMUL_BLOCK) {
+      ucell_t width = jj + FMATMUL_BLOCK < p ? FMATMUL_BLOCK : p - jj;
+
+      for (ucell_t i = 0; i < m; i++) {
+        double* c_row = c + (size_t)i * p + jj;
+        for (ucell_t k = kk; k < k_end; k++) {
+          axpy_kernel(a[(size_t)i * n + k], b + (size_t)k * p + jj, c_row,
+                      width);
+        }
+      }
+    }
+  }
+}
+
+// ============================================================================
+// Forth words
+// ============================================================================
+
+// Validate u floats at addr and return them; NULL if u is zero or the range
+// is bad (an error has been reported in that case)
+static double* float_span(context_t* ctx, forth_addr_t addr, uint64_t u) {
+  if (u == 0) return NULL;
+
+  if (u > UINT32_MAX / FLOAT_SIZE) {
+    error(ctx, "Float count too large: %llu", (unsigned long long)u);
+    return NULL;
+  }
+  if (addr % sizeof(cell_t) != 0) {
+    error(ctx, "Float array not cell-aligned: %u", addr);
+    return NULL;
+  }
+  return addr_range_to_ptr(ctx, addr, (ucell_t)(u * FLOAT_SIZE));
+}
+
+// Pop a count that must not be negative
+static ucell_t pop_count(context_t* ctx) {
+  cell_t u = data_pop(ctx);
+  if (u < 0) {
+    error(ctx, "Negative float count: %d", u);
+    return 0;
+  }
+  return (ucell_t)u;
+}
+
+// FSUM ( f-addr u -- ) ( F: -- r )
+static void f_fsum(context_t* ctx, word_t* self) {
+  (void)self;
+
+  ucell_t u = pop_count(ctx);
+  forth_addr_t addr = (forth_addr_t)data_pop(ctx);
+
+  double* a = float_span(ctx, addr, u);
+  float_push(ctx, a ? floats_sum(a, u) : 0.0);
+}
+
+// FDOT ( f-addr1 f-addr2 u -- ) ( F: -- r )
+static void f_fdot_product(context_t* ctx, word_t* self) {
+  (void)self;
+
+  ucell_t u = pop_count(ctx);
+  forth_addr_t addr2 = (forth_addr_t)data_pop(ctx);
+  forth_addr_t addr1 = (forth_addr_t)data_pop(ctx);
+
+  double* a = float_span(ctx, addr1, u);
+  double* b = float_span(ctx, addr2, u);
+  float_push(ctx, a && b ? floats_dot(a, b, u) : 0.0);
+}
+
+// FSCALE ( f-addr u -- ) ( F: r -- )  Multiply each float by r in place
+static void f_fscale(context_t* ctx, word_t* self) {
+  (void)self;
+
+  double r = float_pop(ctx);
+  ucell_t u = pop_count(ctx);
+  forth_addr_t addr = (forth_addr_t)data_pop(ctx);
+
+  double* a = float_span(ctx, addr, u);
+  if (a) floats_scale(a, u, r);
+}
+
+// FAXPY ( f-addr1 f-addr2 u -- ) ( F: r -- )  y[i] += r * x[i], x at f-addr1
+static void f_faxpy(context_t* ctx, word_t* self) {
+  (void)self;
+
+  double r = float_pop(ctx);
+  ucell_t u = pop_count(ctx);
+  forth_addr_t y_addr = (forth_addr_t)data_pop(ctx);
+  forth_addr_t x_addr = (forth_addr_t)data_pop(ctx);
+
+  double* x = float_span(ctx, x_addr, u);
+  double* y = float_span(ctx, y_addr, u);
+  if (x && y) floats_axpy(r, x, y, u);
+}
+
+// FV+ ( f-addr1 f-addr2 f-addr3 u -- )  c[i] = a[i] + b[i]
+static void f_fv_plus(context_t* ctx, word_t* self) {
+  (void)self;
+
+  ucell_t u = pop_count(ctx);
+  forth_addr_t c_addr = (forth_addr_t)data_pop(ctx);
+  forth_addr_t b_addr = (forth_addr_t)data_pop(ctx);
+  forth_addr_t a_addr = (forth_addr_t)data_pop(ctx);
+
+  double* a = float_span(ctx, a_addr, u);
+  double* b = float_span(ctx, b_addr, u);
+  double* c = float_span(ctx, c_addr, u);
+  if (a && b && c) floats_add(a, b, c, u);
+}
+
+// FV* ( f-addr1 f-addr2 f-addr3 u -- )  c[i] = a[i] * b[i]
+static void f_fv_star(context_t* ctx, word_t* self) {
+  (void)self;
+
+  ucell_t u = pop_count(ctx);
+  forth_addr_t c_addr = (forth_addr_t)data_pop(ctx);
+  forth_addr_t b_addr = (forth_addr_t)data_pop(ctx);
+  forth_addr_t a_addr = (forth_addr_t)data_pop(ctx);
+
+  double* a = float_span(ctx, a_addr, u);
+  double* b = float_span(ctx, b_addr, u);
+  double* c = float_span(ctx, c_addr, u);
+  if (a && b && c) floats_mul(a, b, c, u);
+}
+
+static bool spans_overlap(const double* x, uint64_t xn, const double* y,
+                          uint64_t yn) {
+  return x < y + yn && y < x + xn;
+}
+
+// FMATMUL ( f-addr1 f-addr2 f-addr3 m n p -- )
+// Row-major C (m x p) at f-addr3 = A (m x n) at f-addr1 * B (n x p) at f-addr2
+static void f_fmatmul(context_t* ctx, word_t* self) {
+  (void)self;
+
+  ucell_t p = pop_count(ctx);
+  ucell_t n = pop_count(ctx);
+  ucell_t m = pop_count(ctx);
+  forth_addr_t c_addr = (forth_addr_t)data_pop(ctx);
+  forth_addr_t b_addr = (forth_addr_t)data_pop(ctx);
+  forth_addr_t a_addr = (forth_addr_t)data_pop(ctx);
+
+  uint64_t a_count = (uint64_t)m * n;
+  uint64_t b_count = (uint64_t)n * p;
+  uint64_t c_count = (uint64_t)m * p;
+  if (c_count == 0) return;
+
+  double* c = float_span(ctx, c_addr, c_count);
+  if (!c) return;
+
+  // n = 0 is an all-zero product
+  double* a = float_span(ctx, a_addr, a_count);
+  double* b = float_span(ctx, b_addr, b_count);
+  if (n > 0 && (!a || !b)) return;
+
+  if (n > 0 && (spans_overlap(c, c_count, a, a_count) ||
+                spans_overlap(c, c_count, b, b_count))) {
+    error(ctx, "FMATMUL result overlaps an operand");
+    return;
+  }
+
+  floats_matmul(a, b, c, m, n, p);
+}
+
+void create_float_array_primitives(void) {
+  select_float_kernels();
+
+  create_primitive_word("FSUM", f_fsum);
+  create_primitive_word("FDOT", f_fdot_product);
+  create_primitive_word("FSCALE", f_fscale);
+  create_primitive_word("FAXPY", f_faxpy);
+  create_primitive_word("FV+", f_fv_plus);
+  create_primitive_word("FV*", f_fv_star);
+  create_primitive_word("FMATMUL", f_fmatmul);
+
+  debug("Float-array primitives created");
+}
+
+#endif  // FORTH_ENABLE_FLOATING
@@ -0,0 +1,533 @@
+#include "float_convert.h"
+
+#include <float.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef FORTH_ENABLE_FLOATING
+
+// ============================================================================
+// Parsing
+// ============================================================================
+
+#define FLOAT_PARSE_MAX 320  // Longest string the strtod fallback accepts
+
+// Powers of ten that are exact doubles
+static const double exact_powers[] = {
+    1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+#define MAX_EXACT_POWER 22
+#define MAX_EXACT_MANTISSA ((uint64_t)1 << 53)
+
+static inline bool is_digit(char c) { return c >= '0' && c <= '9'; }
+
+// Clinger's fast path: exact when mantissa and 10^exp10 are both exact
+// doubles, since one IEEE multiply or divide is correctly rounded
+static bool fast_path(uint64_t mantissa, int exp10, double* value) {
+  if (mantissa > MAX_EXACT_MANTISSA) return false;
+
+  if (exp10 < 0) {
+    if (exp10 < -MAX_EXACT_POWER) return false;
+    *value = (double)mantissa / exact_powers[-exp10];
+    return true;
+  }
+
+  // 123e25 is 123000e22: move surplus powers into the mantissa while exact
+  while (exp10 > MAX_EXACT_POWER) {
+    if (mantissa > MAX_EXACT_MANTISSA / 10) return false;
+    mantissa *= 10;
+    exp10--;
+  }
+  *value = (double)mantissa * exact_powers[exp10];
+  return true;
+}
+
+bool float_parse(const char* text, size_t length, bool literal_syntax,
+                 double* result) {
+  size_t i = 0;
+  bool negative = false;
+
+  if (i < length && (text[i] == '+' || text[i] == '-')) {
+    negative = text[i] == '-';
+    i++;
+  }
+
+  // Significand: up to 19 significant digits fit in a uint64_t
+  uint64_t mantissa = 0;
+  int significant = 0;
+  int exp10 = 0;
+  int digits = 0;
+  bool point = false;
+  bool truncated = false;
+
+  for (; i < length; i++) {
+    char c = text[i];
+    if (is_digit(c)) {
+      digits++;
+      if (significant < 19) {
+        if (mantissa != 0 || c != '0') {
+          mantissa = mantissa * 10 + (uint64_t)(c - '0');
+          significant++;
+        }
+        if (point) exp10--;
+      } else {
+        if (c != '0') truncated = true;
+        if (!point) exp10++;
+      }
+    } else if (c == '.' && !point) {
+      point = true;
+    } else {
+      break;
+    }
+  }
+
+  if (digits == 0) return false;
+  size_t significand_end = i;
+
+  // Exponent
+  bool has_exponent = false;
+  int exponent = 0;
+
+  if (i < length) {
+    char c = text[i];
+    bool marker = c == 'E' || c == 'e' ||
+                  (!literal_syntax && (c == 'D' || c == 'd'));
+    bool bare_sign = !literal_syntax && (c == '+' || c == '-');
+    if (!marker && !bare_sign) return false;
+
+    has_exponent = true;
+    if (marker) i++;
+
+    bool exp_negative = false;
+    if (i < length && (text[i] == '+' || text[i] == '-')) {
+      exp_negative = text[i] == '-';
+      i++;
+    }
+
+    size_t exp_start = i;
+    for (; i < length && is_digit(text[i]); i++) {
+      if (exponent < 100000) exponent = exponent * 10 + (text[i] - '0');
+    }
+
+    if (i != length) return false;
+    if (literal_syntax && i == exp_start) return false;
+    if (exp_negative) exponent = -exponent;
+  }
+
+  // Literals need a '.' or 'E' so that integers stay integers
+  if (literal_syntax && !point && !has_exponent) return false;
+
+  double value;
+  if (truncated || !fast_path(mantissa, exp10 + exponent, &value)) {
+    // Rebuild the number in strtod's syntax and let libc round it
+    if (significand_end + 16 > FLOAT_PARSE_MAX) return false;
+
+    char buffer[FLOAT_PARSE_MAX];
+    size_t start = (text[0] == '+' || text[0] == '-') ? 1 : 0;
+    size_t n = significand_end - start;
+    memcpy(buffer, text + start, n);
+
+    buffer[n++] = 'e';
+    if (exponent < 0) buffer[n++] = '-';
+    char exp_digits[8];
+    int exp_length = 0;
+    unsigned magnitude = (unsigned)(exponent < 0 ? -exponent : exponent);
+    do {
+      exp_digits[exp_length++] = (char)('0' + magnitude % 10);
+      magnitude /= 10;
+    } while (magnitude != 0);
+    while (exp_length > 0) buffer[n++] = exp_digits[--exp_length];
+    buffer[n] = '\0';
+
+    value = strtod(buffer, NULL);
+  }
+
+  // Out of range for a double (reject like any other malformed number)
+  if (value > DBL_MAX) return false;
+
+  *result = negative ? -value : value;
+  return true;
+}
+
+// ============================================================================
+// Shortest digits (Grisu2, after Florian Loitsch and Milo Yip)
+// ============================================================================
+
+/*
+ * A double is a 64-bit significand f and binary exponent e. The boundaries
+ * halfway to its neighbours are scaled by a cached power of ten so the
+ * product lands in a range where digits can be produced with 64-bit
+ * integer arithmetic; digit generation stops as soon as the digits
+ * emitted so far pin the value between the (conservatively shrunk)
+ * boundaries, which is what makes the result round-trip.
+ */
+
+typedef struct {
+  uint64_t f;
+  int e;
+} diy_fp_t;
+
+#define DIY_SIGNIFICAND_SIZE 64
+#define DP_SIGNIFICAND_SIZE 52
+#define DP_EXPONENT_BIAS (0x3FF + DP_SIGNIFICAND_SIZE)
+#define DP_HIDDEN_BIT ((uint64_t)1 << DP_SIGNIFICAND_SIZE)
+#define DP_SIGNIFICAND_MASK (DP_HIDDEN_BIT - 1)
+#define DP_EXPONENT_MASK ((uint64_t)0x7FF << DP_SIGNIFICAND_SIZE)
+
+// Normalized 10^k for k = -348, -340, ..., 340
+static const struct {
+  uint64_t f;
+  int16_t e;
+} cached_powers[] = {
+    {0xFA8FD5A0081C0288ULL, -1220},
+    {0xBAAEE17FA23EBF76ULL, -1193},
+    {0x8B16FB203055AC76ULL, -1166},
+    {0xCF42894A5DCE35EAULL, -1140},
+    {0x9A6BB0AA55653B2DULL, -1113},
+    {0xE61ACF033D1A45DFULL, -1087},
+    {0xAB70FE17C79AC6CAULL, -1060},
+    {0xFF77B1FCBEBCDC4FULL, -1034},
+    {0xBE5691EF416BD60CULL, -1007},
+    {0x8DD01FAD907FFC3CULL, -980},
+    {0xD3515C2831559A83ULL, -954},
+    {0x9D71AC8FADA6C9B5ULL, -927},
+    {0xEA9C227723EE8BCBULL, -901},
+    {0xAECC49914078536DULL, -874},
+    {0x823C12795DB6CE57ULL, -847},
+    {0xC21094364DFB5637ULL, -821},
+    {0x9096EA6F3848984FULL, -794},
+    {0xD77485CB25823AC7ULL, -768},
+    {0xA086CFCD97BF97F4ULL, -741},
+    {0xEF340A98172AACE5ULL, -715},
+    {0xB23867FB2A35B28EULL, -688},
+    {0x84C8D4DFD2C63F3BULL, -661},
+    {0xC5DD44271AD3CDBAULL, -635},
+    {0x936B9FCEBB25C996ULL, -608},
+    {0xDBAC6C247D62A584ULL, -582},
+    {0xA3AB66580D5FDAF6ULL, -555},
+    {0xF3E2F893DEC3F126ULL, -529},
+    {0xB5B5ADA8AAFF80B8ULL, -502},
+    {0x87625F056C7C4A8BULL, -475},
+    {0xC9BCFF6034C13053ULL, -449},
+    {0x964E858C91BA2655ULL, -422},
+    {0xDFF9772470297EBDULL, -396},
+    {0xA6DFBD9FB8E5B88FULL, -369},
+    {0xF8A95FCF88747D94ULL, -343},
+    {0xB94470938FA89BCFULL, -316},
+    {0x8A08F0F8BF0F156BULL, -289},
+    {0xCDB02555653131B6ULL, -263},
+    {0x993FE2C6D07B7FACULL, -236},
+    {0xE45C10C42A2B3B06ULL, -210},
+    {0xAA242499697392D3ULL, -183},
+    {0xFD87B5F28300CA0EULL, -157},
+    {0xBCE5086492111AEBULL, -130},
+    {0x8CBCCC096F5088CCULL, -103},
+    {0xD1B71758E219652CULL, -77},
+    {0x9C40000000000000ULL, -50},
+    {0xE8D4A51000000000ULL, -24},
+    {0xAD78EBC5AC620000ULL, 3},
+    {0x813F3978F8940984ULL, 30},
+    {0xC097CE7BC90715B3ULL, 56},
+    {0x8F7E32CE7BEA5C70ULL, 83},
+    {0xD5D238A4ABE98068ULL, 109},
+    {0x9F4F2726179A2245ULL, 136},
+    {0xED63A231D4C4FB27ULL, 162},
+    {0xB0DE65388CC8ADA8ULL, 189},
+    {0x83C7088E1AAB65DBULL, 216},
+    {0xC45D1DF942711D9AULL, 242},
+    {0x924D692CA61BE758ULL, 269},
+    {0xDA01EE641A708DEAULL, 295},
+    {0xA26DA3999AEF774AULL, 322},
+    {0xF209787BB47D6B85ULL, 348},
+    {0xB454E4A179DD1877ULL, 375},
+    {0x865B86925B9BC5C2ULL, 402},
+    {0xC83553C5C8965D3DULL, 428},
+    {0x952AB45CFA97A0B3ULL, 455},
+    {0xDE469FBD99A05FE3ULL, 481},
+    {0xA59BC234DB398C25ULL, 508},
+    {0xF6C69A72A3989F5CULL, 534},
+    {0xB7DCBF5354E9BECEULL, 561},
+    {0x88FCF317F22241E2ULL, 588},
+    {0xCC20CE9BD35C78A5ULL, 614},
+    {0x98165AF37B2153DFULL, 641},
+    {0xE2A0B5DC971F303AULL, 667},
+    {0xA8D9D1535CE3B396ULL, 694},
+    {0xFB9B7CD9A4A7443CULL, 720},
+    {0xBB764C4CA7A44410ULL, 747},
+    {0x8BAB8EEFB6409C1AULL, 774},
+    {0xD01FEF10A657842CULL, 800},
+    {0x9B10A4E5E9913129ULL, 827},
+    {0xE7109BFBA19C0C9DULL, 853},
+    {0xAC2820D9623BF429ULL, 880},
+    {0x80444B5E7AA7CF85ULL, 907},
+    {0xBF21E44003ACDD2DULL, 933},
+    {0x8E679C2F5E44FF8FULL, 960},
+    {0xD433179D9C8CB841ULL, 986},
+    {0x9E19DB92B4E31BA9ULL, 1013},
+    {0xEB96BF6EBADF77D9ULL, 1039},
+    {0xAF87023B9BF0EE6BULL, 1066},
+};
+
+// 10^0 .. 10^19; the fraction loop can scale by up to 10^19
+static const uint64_t powers_of_ten[] = {1ULL,
+                                         10ULL,
+                                         100ULL,
+                                         1000ULL,
+                                         10000ULL,
+                                         100000ULL,
+                                         1000000ULL,
+                                         10000000ULL,
+                                         100000000ULL,
+                                         1000000000ULL,
+                                         10000000000ULL,
+                                         100000000000ULL,
+                                         1000000000000ULL,
+                                         10000000000000ULL,
+                                         100000000000000ULL,
+                                         1000000000000000ULL,
+                                         10000000000000000ULL,
+                                         100000000000000000ULL,
+                                         1000000000000000000ULL,
+                                         10000000000000000000ULL};
+
+static diy_fp_t diy_from_double(double value) {
+  uint64_t bits;
+  memcpy(&bits, &value, sizeof(bits));
+
+  int biased_e = (int)((bits & DP_EXPONENT_MASK) >> DP_SIGNIFICAND_SIZE);
+  uint64_t significand = bits & DP_SIGNIFICAND_MASK;
+
+  if (biased_e != 0) {
+    return (diy_fp_t){significand + DP_HIDDEN_BIT, biased_e - DP_EXPONENT_BIAS};
+  }
+  return (diy_fp_t){significand, 1 - DP_EXPONENT_BIAS};  // Subnormal
+}
+
+static diy_fp_t diy_normalize(diy_fp_t x) {
+  while (!(x.f & ((uint64_t)1 << 63))) {
+    x.f <<= 1;
+    x.e--;
+  }
+  return x;
+}
+
+// Rounded high 64 bits of the 128-bit product, in 32-bit pieces so it
+// needs no __int128 (32-bit targets)
+static diy_fp_t diy_multiply(diy_fp_t x, diy_fp_t y) {
+  const uint64_t mask32 = 0xFFFFFFFFu;
+  uint64_t a = x.f >> 32, b = x.f & mask32;
+  uint64_t c = y.f >> 32, d = y.f & mask32;
+
+  uint64_t ac = a * c, bc = b * c, ad = a * d, bd = b * d;
+  uint64_t middle = (bd >> 32) + (ad & mask32) + (bc & mask32);
+  middle += (uint64_t)1 << 31;  // Round
+
+  return (diy_fp_t){ac + (ad >> 32) + (bc >> 32) + (middle >> 32),
+                    x.e + y.e + 64};
+}
+
+// Boundaries m- and m+ halfway to the neighbouring doubles, same exponent
+static void diy_boundaries(diy_fp_t v, diy_fp_t* minus, diy_fp_t* plus) {
+  diy_fp_t pl = {(v.f << 1) + 1, v.e - 1};
+  while (!(pl.f & (DP_HIDDEN_BIT << 1))) {
+    pl.f <<= 1;
+    pl.e--;
+  }
+  pl.f <<= DIY_SIGNIFICAND_SIZE - DP_SIGNIFICAND_SIZE - 2;
+  pl.e -= DIY_SIGNIFICAND_SIZE - DP_SIGNIFICAND_SIZE - 2;
+
+  // The gap below a power of two is half the gap above it
+  diy_fp_t mi = v.f == DP_HIDDEN_BIT ? (diy_fp_t){(v.f << 2) - 1, v.e - 2}
+                                     : (diy_fp_t){(v.f << 1) - 1, v.e - 1};
+  mi.f <<= mi.e - pl.e;
+  mi.e = pl.e;
+
+  *plus = pl;
+  *minus = mi;
+}
+
+// Cached power c with c * 2^e in a range digit generation handles; sets *k
+// so that c approximates 10^-k
+static diy_fp_t cached_power(int e, int* k) {
+  double dk = (-61 - e) * 0.30102999566398114 + 347;  // log10(2)
+  int ik = (int)dk;
+  if (dk - ik > 0.0) ik++;
+
+  unsigned index = (unsigned)((ik >> 3) + 1);
+  *k = -(-348 + (int)index * 8);
+  return (diy_fp_t){cached_powers[index].f, cached_powers[index].e};
+}
+
+static int count_digits(uint32_t n) {
+  int count = 1;
+  while (count < 10 && n >= powers_of_ten[count]) count++;
+  return count;
+}
+
+// Nudge the last digit toward the value while staying inside the boundaries
+static void grisu_round(char* digits, int length, uint64_t delta,
+                        uint64_t rest, uint64_t ten_kappa, uint64_t wp_w) {
+  while (rest < wp_w && delta - rest >= ten_kappa &&
+         (rest + ten_kappa < wp_w ||
+          wp_w - rest > rest + ten_kappa - wp_w)) {
+    digits[length - 1]--;
+    rest += ten_kappa;
+  }
+}
+
+static int digit_gen(diy_fp_t w, diy_fp_t mp, uint64_t delta, char* digits,
+                     int* k) {
+  const diy_fp_t one = {(uint64_t)1 << -mp.e, mp.e};
+  const uint64_t wp_w = mp.f - w.f;
+  uint32_t p1 = (uint32_t)(mp.f >> -one.e);
+  uint64_t p2 = mp.f & (one.f - 1);
+  int kappa = count_digits(p1);
+  int length = 0;
+
+  // Integer part
+  while (kappa > 0) {
+    uint32_t d = p1 / (uint32_t)powers_of_ten[kappa - 1];
+    p1 %= (uint32_t)powers_of_ten[kappa - 1];
+    if (d || length) digits[length++] = (char)('0' + d);
+    kappa--;
+
+    uint64_t rest = ((uint64_t)p1 << -one.e) + p2;
+    if (rest <= delta) {
+      *k += kappa;
+      grisu_round(digits, length, delta, rest, powers_of_ten[kappa] << -one.e,
+                  wp_w);
+      return length;
+    }
+  }
+
+  // Fraction part
+  for (;;) {
+    p2 *= 10;
+    delta *= 10;
+    char d = (char)(p2 >> -one.e);
+    if (d || length) digits[length++] = (char)('0' + d);
+    p2 &= one.f - 1;
+    kappa--;
+
+    if (p2 < delta) {
+      *k += kappa;
+      grisu_round(digits, length, delta, p2, one.f,
+                  -kappa < 20 ? wp_w * powers_of_ten[-kappa] : 0);
+      return length;
+    }
+  }
+}
+
+// Read back 0.<digits> * 10^point
+static double digits_value(const char* digits, int length, int point) {
+  char text[FLOAT_MAX_DIGITS + 8];
+  int n = length;
+  memcpy(text, digits, (size_t)length);
+
+  int exponent = point - length;
+  text[n++] = 'e';
+  if (exponent < 0) {
+    text[n++] = '-';
+    exponent = -exponent;
+  }
+  if (exponent >= 100) text[n++] = (char)('0' + exponent / 100);
+  if (exponent >= 10) text[n++] = (char)('0' + exponent / 10 % 10);
+  text[n++] = (char)('0' + exponent % 10);
+
+  double value = 0.0;
+  float_parse(text, (size_t)n, true, &value);
+  return value;
+}
+
+// Drop the last digit, rounding toward zero or away from it, and strip
+// trailing zeros; returns the new length
+static int shorten(const char* digits, int length, bool up, char* out,
+                   int* point) {
+  memcpy(out, digits, (size_t)length);
+  out[length - 1] = up ? '9' : '0';  // Force or suppress the carry
+  float_round_digits(out, length, length - 1, point);
+
+  int out_length = length - 1;
+  while (out_length > 1 && out[out_length - 1] == '0') out_length--;
+  return out_length;
+}
+
+int float_shortest_digits(double value, char* digits, int* point) {
+  if (value < 0) value = -value;
+
+  if (value == 0.0) {
+    digits[0] = '0';
+    *point = 1;
+    return 1;
+  }
+
+  diy_fp_t v = diy_from_double(value);
+  diy_fp_t w_minus, w_plus;
+  diy_boundaries(v, &w_minus, &w_plus);
+
+  int k;
+  diy_fp_t c_mk = cached_power(w_plus.e, &k);
+  diy_fp_t w = diy_multiply(diy_normalize(v), c_mk);
+  diy_fp_t wp = diy_multiply(w_plus, c_mk);
+  diy_fp_t wm = diy_multiply(w_minus, c_mk);
+
+  // Shrink the interval by one unit each side to cover rounding in the
+  // multiplications
+  wm.f++;
+  wp.f--;
+
+  int length = digit_gen(w, wp, wp.f - wm.f, digits, &k);
+
+  // digits * 10^k as 0.digits * 10^point
+  *point = length + k;
+
+  // Grisu2 is occasionally a digit or two long, only ever in 16- and
+  // 17-digit results; drop a digit while one of the two neighbouring
+  // shorter strings (nearest first) still reads back
+  while (length >= 16) {
+    bool nearest_up = digits[length - 1] >= '5';
+    char shorter[FLOAT_MAX_DIGITS];
+    int shorter_point;
+    int shorter_length = 0;
+
+    for (int attempt = 0; attempt < 2 && shorter_length == 0; attempt++) {
+      bool up = attempt == 0 ? nearest_up : !nearest_up;
+      shorter_point = *point;
+      shorter_length = shorten(digits, length, up, shorter, &shorter_point);
+      if (digits_value(shorter, shorter_length, shorter_point) != value) {
+        shorter_length = 0;
+      }
+    }
+    if (shorter_length == 0) break;
+
+    memcpy(digits, shorter, (size_t)shorter_length);
+    length = shorter_length;
+    *point = shorter_point;
+  }
+
+  return length;
+}
+
+void float_round_digits(char* digits, int length, int count, int* point) {
+  if (count >= length) {
+    memset(digits + length, '0', (size_t)(count - length));
+    return;
+  }
+  if (count <= 0 || digits[count] < '5') return;
+
+  // Propagate the carry
+  for (int i = count - 1; i >= 0; i--) {
+    if (digits[i] != '9') {
+      digits[i]++;
+      return;
+    }
+    digits[i] = '0';
+  }
+
+  digits[0] = '1';
+  (*point)++;
+}
+
+#endif  // FORTH_ENABLE_FLOATING
@@ -8,40 +8,19 @@
 #include "core.h"
 #include "debug.h"
 #include "dictionary.h"
+#include "float_convert.h"
 #include "error.h"
 #include "memory.h"
+#include "stack.h"
 #include "text.h"
 
 #ifdef FORTH_ENABLE_FLOATING
 
-// Float stack storage
-double float_stack[FLOAT_STACK_SIZE];
-int float_stack_ptr = 0;  // Points to next empty slot
-
-// Initialize float stack
-void float_stack_init(void) { main_context.float_stack_ptr = 0; }
-
-// Float stack operations
-void float_push(context_t* ctx, double value) {
-  require(ctx, float_stack_ptr < FLOAT_STACK_SIZE);  // Stack overflow check
-  float_stack[float_stack_ptr++] = value;
-  debug("Float pushed: %g (depth now %d)", value, float_stack_ptr);
-}
-
-double float_pop(context_t* ctx) {
-  require(ctx, float_stack_ptr > 0);  // Stack underflow check
-  double value = float_stack[--float_stack_ptr];
-  debug("Float popped: %g (depth now %d)", value, float_stack_ptr);
-  return value;
-}
-
-double float_peek(context_t* ctx) {
-  require(ctx, float_stack_ptr > 0);  // Stack underflow check
-  return float_stack[float_stack_ptr - 1];
+// Float stack errors (the push/pop fast paths are inline in floating.h)
+void float_stack_error(context_t* ctx, const char* problem) {
+  error(ctx, "Float stack %s", problem);
 }
 
-int float_depth(context_t* ctx) { return ctx->float_stack_ptr; }
-
 // Liberal floating-point number parsing
 // Accepts: 123.456, .5, 5., 1E5, 1.23e-10, etc.
 // Rejects pure integers like: 123, -456 (those go to integer stack)
@@ -54,35 +33,9 @@ bool try_parse_float(const char* token, double* result) {
     return false;
   }
 
-  // Empty string is not a float
-  if (*token == '\0') return false;
-
-  // Quick check: must contain decimal point OR exponent to be considered float
-  // This distinguishes floats from integers: "123" -> integer, "123.0" -> float
-  bool looks_like_float =
-      (strchr(token, '.') != NULL || strchr(token, 'e') != NULL ||
-       strchr(token, 'E') != NULL);
-
-  if (!looks_like_float) {
-    return false;  // Pure integer, let try_parse_number handle it
-  }
-
-  // Use strtod to do the actual parsing
-  char* endptr;
-  double value = strtod(token, &endptr);
+  if (!float_parse(token, strlen(token), true, result)) return false;
 
-  // Check if entire string was consumed
-  if (*endptr != '\0') {
-    return false;  // Invalid characters or incomplete parse
-  }
-
-  // Check for valid result (reject NaN and infinity for safety)
-  if (isnan(value) || isinf(value)) {
-    return false;
-  }
-
-  *result = value;
-  debug("Parsed float: '%s' -> %g", token, value);
+  debug("Parsed float: '%s' -> %g", token, *result);
   return true;
 }
 
@@ -141,50 +94,414 @@ static void f_fdivide(context_t* ctx, word_t* self) {
   float_push(ctx, r1 / r2);
 }
 
-// F. ( F: r -- ) Display a float and remove from stack
-static void f_fdot(context_t* ctx, word_t* self) {
-  (void)ctx;
+// FSWAP ( F: r1 r2 -- r2 r1 )
+static void f_fswap(context_t* ctx, word_t* self) {
+  (void)self;
+  double r2 = float_pop(ctx);
+  double r1 = float_pop(ctx);
+  float_push(ctx, r2);
+  float_push(ctx, r1);
+}
+
+// FOVER ( F: r1 r2 -- r1 r2 r1 )
+static void f_fover(context_t* ctx, word_t* self) {
+  (void)self;
+  double r2 = float_pop(ctx);
+  double r1 = float_peek(ctx);
+  float_push(ctx, r2);
+  float_push(ctx, r1);
+}
+
+// FROT ( F: r1 r2 r3 -- r2 r3 r1 )
+static void f_frot(context_t* ctx, word_t* self) {
+  (void)self;
+  double r3 = float_pop(ctx);
+  double r2 = float_pop(ctx);
+  double r1 = float_pop(ctx);
+  float_push(ctx, r2);
+  float_push(ctx, r3);
+  float_push(ctx, r1);
+}
+
+// FDEPTH ( -- +n ) Number of values on the float stack
+static void f_fdepth(context_t* ctx, word_t* self) {
+  (void)self;
+  data_push(ctx, float_depth(ctx));
+}
+
+// Floats in data space take two cells in FLIT order and need only cell
+// alignment, so they are copied rather than dereferenced as double*
+static double float_fetch(context_t* ctx, forth_addr_t addr) {
+  double value = 0.0;
+  void* src = addr_range_to_ptr(ctx, addr, FLOAT_SIZE);
+  if (src) memcpy(&value, src, FLOAT_SIZE);
+  return value;
+}
+
+static void float_store(context_t* ctx, forth_addr_t addr, double value) {
+  void* dest = addr_range_to_ptr(ctx, addr, FLOAT_SIZE);
+  if (dest) memcpy(dest, &value, FLOAT_SIZE);
+}
+
+// F@ ( f-addr -- ) ( F: -- r )
+static void f_ffetch(context_t* ctx, word_t* self) {
+  (void)self;
+  forth_addr_t addr = (forth_addr_t)data_pop(ctx);
+  float_push(ctx, float_fetch(ctx, addr));
+}
+
+// F! ( f-addr -- ) ( F: r -- )
+static void f_fstore(context_t* ctx, word_t* self) {
+  (void)self;
+  forth_addr_t addr = (forth_addr_t)data_pop(ctx);
+  float_store(ctx, addr, float_pop(ctx));
+}
+
+// FLOATS ( n1 -- n2 ) Size in bytes of n1 floats
+static void f_floats(context_t* ctx, word_t* self) {
+  (void)self;
+  data_push(ctx, data_pop(ctx) * FLOAT_SIZE);
+}
+
+// FLOAT+ ( f-addr1 -- f-addr2 )
+static void f_float_plus(context_t* ctx, word_t* self) {
+  (void)self;
+  data_push(ctx, data_pop(ctx) + FLOAT_SIZE);
+}
+
+// FCONSTANT runtime: push the float stored in the data field
+void f_fconstant_runtime(context_t* ctx, word_t* self) {
+  float_push(ctx, float_fetch(ctx, self->param.address));
+}
+
+// FCONSTANT ( "name" -- ) ( F: r -- )
+static void f_fconstant(context_t* ctx, word_t* self) {
   (void)self;
 
   double value = float_pop(ctx);
 
-#ifdef FORTH_TARGET_PICO
-  // Pico-specific formatting - manual cleanup for cleaner output
-  char buffer[32];
+  defining_word(ctx, f_fconstant_runtime);
+  float_store(ctx, forth_allot(ctx, FLOAT_SIZE), value);
+}
+
+// FVARIABLE ( "name" -- ) One float of data space, initialized to zero
+static void f_fvariable(context_t* ctx, word_t* self) {
+  (void)self;
+
+  defining_word(ctx, f_param_field);
+  float_store(ctx, forth_allot(ctx, FLOAT_SIZE), 0.0);
+}
+
+// F< ( -- flag ) ( F: r1 r2 -- )
+static void f_fless(context_t* ctx, word_t* self) {
+  (void)self;
+  double r2 = float_pop(ctx);
+  double r1 = float_pop(ctx);
+  data_push(ctx, r1 < r2 ? -1 : 0);
+}
+
+// F0= ( -- flag ) ( F: r -- )
+static void f_fzero_equal(context_t* ctx, word_t* self) {
+  (void)self;
+  data_push(ctx, float_pop(ctx) == 0.0 ? -1 : 0);
+}
+
+// F0< ( -- flag ) ( F: r -- )
+static void f_fzero_less(context_t* ctx, word_t* self) {
+  (void)self;
+  data_push(ctx, float_pop(ctx) < 0.0 ? -1 : 0);
+}
+
+// FNEGATE ( F: r1 -- r2 )
+static void f_fnegate(context_t* ctx, word_t* self) {
+  (void)self;
+  float_push(ctx, -float_pop(ctx));
+}
+
+// FABS ( F: r1 -- r2 )
+static void f_fabs(context_t* ctx, word_t* self) {
+  (void)self;
+  float_push(ctx, fabs(float_pop(ctx)));
+}
+
+// FMAX ( F: r1 r2 -- r3 )
+static void f_fmax(context_t* ctx, word_t* self) {
+  (void)self;
+  double r2 = float_pop(ctx);
+  double r1 = float_pop(ctx);
+  float_push(ctx, r1 > r2 ? r1 : r2);
+}
+
+// FMIN ( F: r1 r2 -- r3 )
+static void f_fmin(context_t* ctx, word_t* self) {
+  (void)self;
+  double r2 = float_pop(ctx);
+  double r1 = float_pop(ctx);
+  float_push(ctx, r1 < r2 ? r1 : r2);
+}
+
+// FLOOR ( F: r1 -- r2 ) Round toward negative infinity
+static void f_floor(context_t* ctx, word_t* self) {
+  (void)self;
+  float_push(ctx, floor(float_pop(ctx)));
+}
+
+// FROUND ( F: r1 -- r2 ) Round to nearest, ties to even
+static void f_fround(context_t* ctx, word_t* self) {
+  (void)self;
+  float_push(ctx, nearbyint(float_pop(ctx)));
+}
+
+// FSQRT ( F: r1 -- r2 )
+static void f_fsqrt(context_t* ctx, word_t* self) {
+  (void)self;
+  double r = float_pop(ctx);
+  if (r < 0.0) error(ctx, "Negative argument to 'FSQRT'");
+  float_push(ctx, sqrt(r));
+}
+
+// FSIN ( F: r1 -- r2 ) Argument in radians
+static void f_fsin(context_t* ctx, word_t* self) {
+  (void)self;
+  float_push(ctx, sin(float_pop(ctx)));
+}
+
+// FCOS ( F: r1 -- r2 ) Argument in radians
+static void f_fcos(context_t* ctx, word_t* self) {
+  (void)self;
+  float_push(ctx, cos(float_pop(ctx)));
+}
+
+// FEXP ( F: r1 -- r2 ) e raised to r1
+static void f_fexp(context_t* ctx, word_t* self) {
+  (void)self;
+  float_push(ctx, exp(float_pop(ctx)));
+}
+
+// FLN ( F: r1 -- r2 ) Natural logarithm
+static void f_fln(context_t* ctx, word_t* self) {
+  (void)self;
+  double r = float_pop(ctx);
+  if (r <= 0.0) error(ctx, "Non-positive argument to 'FLN'");
+  float_push(ctx, log(r));
+}
+
+// F** ( F: r1 r2 -- r3 ) r1 raised to r2
+static void f_fpower(context_t* ctx, word_t* self) {
+  (void)self;
+  double r2 = float_pop(ctx);
+  double r1 = float_pop(ctx);
+  float_push(ctx, pow(r1, r2));
+}
+
+// Truncate toward zero; values outside the int64_t range are an error
+static int64_t float_to_int64(context_t* ctx, double r) {
+  if (!(r > -9223372036854775808.0 && r < 9223372036854775808.0)) {
+    error(ctx, "Float out of integer range");
+    return 0;
+  }
+  return (int64_t)r;
+}
+
+// D>F ( d -- ) ( F: -- r )
+static void f_d_to_f(context_t* ctx, word_t* self) {
+  (void)self;
+  float_push(ctx, (double)data_pop_double(ctx));
+}
+
+// F>D ( -- d ) ( F: r -- )
+static void f_f_to_d(context_t* ctx, word_t* self) {
+  (void)self;
+  data_push_double(ctx, float_to_int64(ctx, float_pop(ctx)));
+}
+
+// S>F ( n -- ) ( F: -- r )
+static void f_s_to_f(context_t* ctx, word_t* self) {
+  (void)self;
+  float_push(ctx, (double)data_pop(ctx));
+}
+
+// F>S ( -- n ) ( F: r -- )
+static void f_f_to_s(context_t* ctx, word_t* self) {
+  (void)self;
+  int64_t n = float_to_int64(ctx, float_pop(ctx));
+  if (n < INT32_MIN || n > INT32_MAX) {
+    error(ctx, "Float out of cell range in 'F>S'");
+    n = 0;
+  }
+  data_push(ctx, (cell_t)n);
+}
+
+// Digits shown by F., FS. and FE. (SET-PRECISION); 15 hides the noise in
+// sums like 0.1 0.2 F+, 17 shows every value exactly as it reads back
+static cell_t float_precision = 15;
+
+// Text for r: shortest round-trip digits, rounded to PRECISION. Fixed
+// notation falls back to scientific for very large or small values rather
+// than printing hundreds of zeros. The sign is the sign bit, so -0.0 keeps
+// it as FS. and REPRESENT do.
+void float_format(double value, float_style_t style,
+                  char out[FLOAT_FORMAT_SIZE]) {
+  if (isnan(value)) {
+    strcpy(out, "NaN");
+    return;
+  }
+  if (isinf(value)) {
+    strcpy(out, value < 0 ? "-Inf" : "Inf");
+    return;
+  }
+
+  char digits[FLOAT_MAX_DIGITS];
+  int point;
+  int length = float_shortest_digits(value, digits, &point);
+
+  if (length > float_precision) {
+    float_round_digits(digits, length, float_precision, &point);
+    length = float_precision;
+    while (length > 1 && digits[length - 1] == '0') length--;
+  }
+
+  int n = 0;
+  if (signbit(value)) out[n++] = '-';
+
+  if (style == FLOAT_FIXED && (point < -6 || point > 21)) {
+    style = FLOAT_SCIENTIFIC;
+  }
 
-  // Check if it's effectively a whole number
-  if (fabs(value - round(value)) < 1e-9 && value >= -2147483648.0 &&
-      value <= 2147483647.0) {
-    // Display as integer
-    snprintf(buffer, sizeof(buffer), "%.0f", value);
+  if (style == FLOAT_FIXED) {
+    if (point <= 0) {
+      out[n++] = '0';
+      out[n++] = '.';
+      for (int i = point; i < 0; i++) out[n++] = '0';
+      for (int i = 0; i < length; i++) out[n++] = digits[i];
+    } else {
+      for (int i = 0; i < point; i++) out[n++] = i < length ? digits[i] : '0';
+      out[n++] = '.';
+      for (int i = point; i < length; i++) out[n++] = digits[i];
+    }
   } else {
-    // Use %.6g and manually clean up trailing zeros
-    snprintf(buffer, sizeof(buffer), "%.6g", value);
-
-    // Remove trailing zeros after decimal point (if any)
-    char* dot = strchr(buffer, '.');
-    if (dot && !strchr(buffer, 'e') && !strchr(buffer, 'E')) {
-      char* end = buffer + strlen(buffer) - 1;
-      while (end > dot && *end == '0') {
-        *end = '\0';
-        end--;
-      }
-      // Remove trailing decimal point if no digits after it
-      if (*end == '.') {
-        *end = '\0';
-      }
+    // One leading digit, or one to three so the exponent is a multiple of 3
+    int exponent = point - 1;
+    int leading = 1;
+    if (style == FLOAT_ENGINEERING && value != 0.0) {
+      leading += ((exponent % 3) + 3) % 3;
+      exponent -= leading - 1;
     }
+
+    for (int i = 0; i < leading; i++) out[n++] = i < length ? digits[i] : '0';
+    out[n++] = '.';
+    for (int i = leading; i < length; i++) out[n++] = digits[i];
+    n += snprintf(out + n, FLOAT_FORMAT_SIZE - (size_t)n, "E%d", exponent);
   }
 
-  printf("%s ", buffer);
-#else
-  // PC build - use simple %g format (should work well)
-  printf("%g ", value);
-#endif
+  out[n] = '\0';
+}
+
+// Display r with a trailing space
+static void print_float(double value, float_style_t style) {
+  char out[FLOAT_FORMAT_SIZE];
+  float_format(value, style, out);
+  printf("%s ", out);
+}
 
+// F. ( F: r -- ) Display in fixed-point notation
+static void f_fdot(context_t* ctx, word_t* self) {
+  (void)self;
+  print_float(float_pop(ctx), FLOAT_FIXED);
   fflush(stdout);
 }
 
+// FS. ( F: r -- ) Display in scientific notation
+static void f_fs_dot(context_t* ctx, word_t* self) {
+  (void)self;
+  print_float(float_pop(ctx), FLOAT_SCIENTIFIC);
+  fflush(stdout);
+}
+
+// FE. ( F: r -- ) Display in engineering notation (exponent a multiple of 3)
+static void f_fe_dot(context_t* ctx, word_t* self) {
+  (void)self;
+  print_float(float_pop(ctx), FLOAT_ENGINEERING);
+  fflush(stdout);
+}
+
+// PRECISION ( -- u )
+static void f_precision(context_t* ctx, word_t* self) {
+  (void)self;
+  data_push(ctx, float_precision);
+}
+
+// SET-PRECISION ( u -- ) Clamped to 1..17 significant digits
+static void f_set_precision(context_t* ctx, word_t* self) {
+  (void)self;
+  cell_t u = data_pop(ctx);
+  float_precision = u < 1 ? 1 : (u > FLOAT_MAX_DIGITS ? FLOAT_MAX_DIGITS : u);
+}
+
+// REPRESENT ( c-addr u -- n flag1 flag2 ) ( F: r -- )
+// u significant digits of r at c-addr, r = 0.<digits> * 10^n; flag1 is
+// true if r is negative, flag2 false if r is not a finite number
+static void f_represent(context_t* ctx, word_t* self) {
+  (void)self;
+
+  double value = float_pop(ctx);
+  cell_t u = data_pop(ctx);
+  forth_addr_t addr = (forth_addr_t)data_pop(ctx);
+
+  char* dest = u > 0 ? addr_range_to_ptr(ctx, addr, (ucell_t)u) : NULL;
+  bool finite = isfinite(value);
+  int point = 0;
+
+  if (finite) {
+    char digits[FLOAT_MAX_DIGITS];
+    int length = float_shortest_digits(value, digits, &point);
+
+    // Pad past the shortest digits, round below them
+    if (u > length) {
+      if (dest) {
+        memcpy(dest, digits, (size_t)length);
+        memset(dest + length, '0', (size_t)(u - length));
+      }
+    } else if (u > 0) {
+      float_round_digits(digits, length, u, &point);
+      if (dest) memcpy(dest, digits, (size_t)u);
+    }
+  } else if (dest) {
+    const char* text = isnan(value) ? "NaN" : "Inf";
+    for (cell_t i = 0; i < u; i++) dest[i] = i < 3 ? text[i] : ' ';
+  }
+
+  data_push(ctx, point);
+  data_push(ctx, signbit(value) ? -1 : 0);
+  data_push(ctx, finite ? -1 : 0);
+}
+
+// >FLOAT ( c-addr u -- true | false ) ( F: -- r | )
+// ANS syntax, e.g. 1.5E3, 1.5e+3, 15D2, 1.5+3 or 15; all blanks is zero
+static void f_to_float(context_t* ctx, word_t* self) {
+  (void)self;
+
+  cell_t u = data_pop(ctx);
+  forth_addr_t addr = (forth_addr_t)data_pop(ctx);
+
+  const char* text = u > 0 ? addr_range_to_ptr(ctx, addr, (ucell_t)u) : NULL;
+  if (u > 0 && !text) {
+    data_push(ctx, 0);
+    return;
+  }
+
+  cell_t blanks = 0;
+  while (blanks < u && text[blanks] == ' ') blanks++;
+
+  double value = 0.0;
+  if (blanks == u || float_parse(text, (size_t)u, false, &value)) {
+    float_push(ctx, value);
+    data_push(ctx, -1);
+  } else {
+    data_push(ctx, 0);
+  }
+}
+
 // FLIT implementation that reads from instruction stream
 // FLIT ( F: -- r ) Push the float literal value that follows in compiled code
 static void f_flit(context_t* ctx, word_t* self) {
@@ -246,7 +563,42 @@ void create_floating_primitives(void) {
   create_primitive_word("F*", f_fmultiply);
   create_primitive_word("F/", f_fdivide);
   create_primitive_word("F.", f_fdot);
-  create_primitive_word("FLIT", f_flit);
+  create_primitive_word("FS.", f_fs_dot);
+  create_primitive_word("FE.", f_fe_dot);
+  create_primitive_word("PRECISION", f_precision);
+  create_primitive_word("SET-PRECISION", f_set_precision);
+  create_primitive_word("REPRESENT", f_represent);
+  create_primitive_word(">FLOAT", f_to_float);
+  create_primitive_word("FSWAP", f_fswap);
+  create_primitive_word("FOVER", f_fover);
+  create_primitive_word("FROT", f_frot);
+  create_primitive_word("FDEPTH", f_fdepth);
+  create_primitive_word("F@", f_ffetch);
+  create_primitive_word("F!", f_fstore);
+  create_primitive_word("FLOATS", f_floats);
+  create_primitive_word("FLOAT+", f_float_plus);
+  create_primitive_word("FCONSTANT", f_fconstant);
+  create_primitive_word("FVARIABLE", f_fvariable);
+  create_primitive_word("F<", f_fless);
+  create_primitive_word("F0=", f_fzero_equal);
+  create_primitive_word("F0<", f_fzero_less);
+  create_primitive_word("FNEGATE", f_fnegate);
+  create_primitive_word("FABS", f_fabs);
+  create_primitive_word("FMAX", f_fmax);
+  create_primitive_word("FMIN", f_fmin);
+  create_primitive_word("FLOOR", f_floor);
+  create_primitive_word("FROUND", f_fround);
+  create_primitive_word("FSQRT", f_fsqrt);
+  create_primitive_word("FSIN", f_fsin);
+  create_primitive_word("FCOS", f_fcos);
+  create_primitive_word("FEXP", f_fexp);
+  create_primitive_word("FLN", f_fln);
+  create_primitive_word("F**", f_fpower);
+  create_primitive_word("D>F", f_d_to_f);
+  create_primitive_word("F>D", f_f_to_d);
+  create_primitive_word("S>F", f_s_to_f);
+  create_primitive_word("F>S", f_f_to_s);
+  create_operand_primitive_word("FLIT", f_flit, WORD_FLAG_OPERAND_FLOAT);
 
   debug("Floating-point primitives created");
 }
@@ -1,54 +1,49 @@
 #include "forth.h"
 
 #include <stdbool.h>
+#include <stddef.h>
 #include <string.h>
 
 #include "error.h"
 #include "memory.h"
 
-// Static mapping table (only accessible within this file)
-typedef struct {
-  forth_addr_t base_addr;
-  size_t context_offset;
-  size_t region_size;
-} transient_mapping_t;
-
-static const transient_mapping_t transient_mappings[] = {
-    {FORTH_MEMORY_SIZE, offsetof(context_t, pad_buffer), PAD_SIZE},
-    {FORTH_MEMORY_SIZE + PAD_SIZE, offsetof(context_t, word_buffer),
-     WORD_BUFFER_SIZE},
-    {FORTH_MEMORY_SIZE + PAD_SIZE + WORD_BUFFER_SIZE,
-     offsetof(context_t, pictured_buffer), PICTURED_BUFFER_SIZE}};
+// forth_span_ptr() treats the transient regions as one block at PAD_ADDR
+_Static_assert(offsetof(context_t, word_buffer) ==
+                   offsetof(context_t, pad_buffer) + PAD_SIZE,
+               "WORD buffer must follow PAD");
+_Static_assert(offsetof(context_t, pictured_buffer) ==
+                   offsetof(context_t, word_buffer) + WORD_BUFFER_SIZE,
+               "Pictured buffer must follow the WORD buffer");
 
 // Address translation function
 void* addr_to_ptr(context_t* ctx, forth_addr_t addr) {
-  // Handle main Forth memory
-  if (addr < FORTH_MEMORY_SIZE) {
-    return &forth_memory[addr];
-  }
+  byte_t* ptr = forth_span_ptr(ctx, addr, 1);
+  if (!ptr) error(ctx, "Invalid Forth address: %u", addr);
+  return ptr;
+}
 
-  // Handle transient regions
-  for (int i = 0; i < 3; i++) {
-    const transient_mapping_t* mapping = &transient_mappings[i];
-    if (addr >= mapping->base_addr &&
-        addr < mapping->base_addr + mapping->region_size) {
-      int buffer_offset = addr - mapping->base_addr;
-      byte_t* buffer = (byte_t*)ctx + mapping->context_offset;
-      return buffer + buffer_offset;
-    }
-  }
+// Bulk address translation: validate all of [addr, addr+size) once and return
+// a raw pointer to the span. The range must lie entirely within main memory or
+// within the transient regions. Returns NULL for an empty or bad range.
+void* addr_range_to_ptr(context_t* ctx, forth_addr_t addr, ucell_t size) {
+  if (size == 0) return NULL;
 
-  error(ctx, "Invalid Forth address: %u", addr);
-  return NULL;
+  byte_t* ptr = forth_span_ptr(ctx, addr, size);
+  if (!ptr) error(ctx, "Invalid Forth address range: %u+%u", addr, size);
+  return ptr;
 }
 
 context_t main_context = {
     .ip = 0,
     .data_stack_ptr = 0,
     .return_stack_ptr = 0,
+#ifdef FORTH_ENABLE_LOCALS
+    .locals_frame = 0,
+#endif
 #ifdef FORTH_ENABLE_FLOATING
     .float_stack_ptr = 0,
 #endif
+    .hold_index = PICTURED_BUFFER_SIZE,
     .source_buffer = NULL,
     .source_length = 0,
     .source_index = 0,
@@ -65,6 +60,13 @@ void context_init(context_t* ctx, const char* name, bool is_interrupt_handler) {
   // Initialize stacks (replaces old stack_init)
   ctx->data_stack_ptr = 0;
   ctx->return_stack_ptr = 0;
+  ctx->control_stack_ptr = 0;
+  ctx->fold_pending_count = 0;
+  ctx->fold_pending_end = 0;
+  ctx->fold_barrier = 0;
+#ifdef FORTH_ENABLE_LOCALS
+  ctx->locals_frame = 0;
+#endif
 
 #ifdef FORTH_ENABLE_FLOATING
   ctx->float_stack_ptr = 0;
@@ -74,6 +76,7 @@ void context_init(context_t* ctx, const char* name, bool is_interrupt_handler) {
   memset(ctx->pad_buffer, 0, PAD_SIZE);
   memset(ctx->word_buffer, 0, WORD_BUFFER_SIZE);
   memset(ctx->pictured_buffer, 0, PICTURED_BUFFER_SIZE);
+  ctx->hold_index = PICTURED_BUFFER_SIZE;
 
   // Input source state
   ctx->source_buffer = NULL;
@@ -0,0 +1,1100 @@
+#include "jit.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/mman.h>
+
+#include "core.h"
+#include "coverage.h"
+#include "debug.h"
+#include "dictionary.h"
+#include "memory.h"
+#include "stack.h"
+
+#ifdef FORTH_ENABLE_JIT
+
+/*
+ * Native frame
+ * ============
+ *   rbx  ctx
+ *   r12  data stack depth (ctx->data_stack_ptr), written back before calls
+ *   r13  return stack depth on entry, the frame execute_tokens() runs down to
+ *   eax, ecx, edx  scratch
+ *
+ * Data stack cell k from the top is [rbx + r12*4 + DS - 4*(k+1)]. Every
+ * template checks depth (and return depth or address range where it
+ * matters) first and on failure calls the real word, so errors are reported
+ * exactly as the threaded code would report them.
+ *
+ * Entry pushes the caller's ip like execute_colon(), and an inline EXIT pops
+ * it, so native and threaded definitions call each other freely. Before each
+ * call ctx->ip is set to the token's operand address, and afterwards it must
+ * be on the next token (or, for branch words, on a branch target); anything
+ * else jumps to the deopt stub, which hands the rest of the definition to
+ * execute_tokens().
+ */
+
+typedef enum {
+  OP_CALL,  // No template: call through the cfunc
+  OP_LIT,
+  OP_EXIT,
+  OP_BRANCH,
+  OP_0BRANCH,
+  OP_DO,
+  OP_LOOP,
+  OP_I,
+  OP_TO_R,
+  OP_R_FROM,
+  OP_R_FETCH,
+  OP_FETCH,
+  OP_STORE,
+  OP_C_FETCH,
+  OP_C_STORE,
+  OP_DUP,
+  OP_DROP,
+  OP_SWAP,
+  OP_OVER,
+  OP_NIP,
+  OP_TUCK,
+  OP_ROT,
+  OP_2DUP,
+  OP_2DROP,
+  OP_ADD,  // Binary arithmetic, foldable with a preceding LIT
+  OP_SUB,
+  OP_AND,
+  OP_OR,
+  OP_XOR,
+  OP_INVERT,  // Unary, in place
+  OP_NEGATE,
+  OP_1PLUS,
+  OP_1MINUS,
+  OP_CELL_PLUS,
+  OP_2STAR,
+  OP_CELLS,
+  OP_EQ,  // Comparisons of two cells
+  OP_NE,
+  OP_LT,
+  OP_GT,
+  OP_LE,
+  OP_GE,
+  OP_ULT,
+  OP_UGT,
+  OP_0EQ,  // Comparisons against zero
+  OP_0NE,
+  OP_0LT,
+  OP_0GT,
+} jit_op_t;
+
+// Words with templates, found by address once the builtins exist. Several
+// are colon definitions (DUP, 1+, 0<): their meaning is fixed, and inlining
+// them also saves a nested call.
+static const struct {
+  const char* name;
+  jit_op_t op;
+} template_names[] = {
+    {"LIT", OP_LIT},     {"EXIT", OP_EXIT},    {"BRANCH", OP_BRANCH},
+    {"0BRANCH", OP_0BRANCH},                   {"(DO)", OP_DO},
+    {"(LOOP)", OP_LOOP}, {"I", OP_I},          {">R", OP_TO_R},
+    {"R>", OP_R_FROM},   {"R@", OP_R_FETCH},   {"@", OP_FETCH},
+    {"!", OP_STORE},     {"C@", OP_C_FETCH},   {"C!", OP_C_STORE},
+    {"DUP", OP_DUP},     {"DROP", OP_DROP},    {"SWAP", OP_SWAP},
+    {"OVER", OP_OVER},   {"NIP", OP_NIP},      {"TUCK", OP_TUCK},
+    {"ROT", OP_ROT},     {"2DUP", OP_2DUP},    {"2DROP", OP_2DROP},
+    {"+", OP_ADD},       {"-", OP_SUB},        {"AND", OP_AND},
+    {"OR", OP_OR},       {"XOR", OP_XOR},      {"INVERT", OP_INVERT},
+    {"NEGATE", OP_NEGATE},                     {"1+", OP_1PLUS},
+    {"1-", OP_1MINUS},   {"CELL+", OP_CELL_PLUS},
+    {"2*", OP_2STAR},    {"CELLS", OP_CELLS},  {"=", OP_EQ},
+    {"<>", OP_NE},       {"<", OP_LT},         {">", OP_GT},
+    {"<=", OP_LE},       {">=", OP_GE},        {"U<", OP_ULT},
+    {"U>", OP_UGT},      {"0=", OP_0EQ},       {"0<>", OP_0NE},
+    {"0<", OP_0LT},      {"0>", OP_0GT},
+};
+
+#define TEMPLATE_COUNT (sizeof(template_names) / sizeof(template_names[0]))
+
+static word_t* template_words[TEMPLATE_COUNT];
+
+// x86 condition codes (low nibble of Jcc/SETcc)
+#define CC_O 0x0
+#define CC_NO 0x1
+#define CC_B 0x2
+#define CC_E 0x4
+#define CC_NE 0x5
+#define CC_A 0x7
+#define CC_L 0xC
+#define CC_GE 0xD
+#define CC_LE 0xE
+#define CC_G 0xF
+#define CC_ALWAYS 0x10  // emit_jump(): plain JMP
+
+// Registers by encoding
+#define REG_EAX 0
+#define REG_ECX 1
+#define REG_EDX 2
+#define REG_ESI 6
+#define REG_R12 12
+#define REG_R13 13
+
+// Context and word offsets used by the templates
+#define OFF_IP ((int32_t)offsetof(context_t, ip))
+#define OFF_DS ((int32_t)offsetof(context_t, data_stack))
+#define OFF_RS ((int32_t)offsetof(context_t, return_stack))
+#define OFF_DSP ((int32_t)offsetof(context_t, data_stack_ptr))
+#define OFF_RSP ((int32_t)offsetof(context_t, return_stack_ptr))
+#define OFF_CFUNC ((int8_t)offsetof(word_t, cfunc))
+
+typedef struct {
+  forth_addr_t addr;  // Token address
+  forth_addr_t next;  // Address of the following token
+  word_t* word;
+  jit_op_t op;
+  cell_t operand;  // First inline cell: literal or branch target
+  int target;      // Token index of the branch target, -1 if none
+  bool landing;    // Some branch lands on this token
+  size_t label;    // Native offset of the token
+} jit_token_t;
+
+typedef struct {
+  size_t at;  // rel32 to patch
+  int token;  // Token index, or -1 for the deopt stub
+} jit_fixup_t;
+
+// Code buffer, mapped once and refilled from the start on reset. It is
+// never writable and executable at once: read-execute except while
+// jit_compile appends to it.
+static byte_t* code;
+static size_t code_used;
+static bool jit_ready;
+
+// State of the definition being compiled
+static jit_token_t tokens[JIT_MAX_TOKENS];
+static jit_fixup_t fixups[4 * JIT_MAX_TOKENS];
+static int token_count;
+static int fixup_count;
+static size_t pos;
+static bool failed;
+static bool dirty;  // r12 differs from ctx->data_stack_ptr
+
+// ============================================================================
+// Encoding
+// ============================================================================
+
+static void emit8(unsigned byte) {
+  if (pos < JIT_CODE_SIZE) {
+    code[pos++] = (byte_t)byte;
+  } else {
+    failed = true;
+  }
+}
+
+static void emit32(uint32_t value) {
+  for (int i = 0; i < 4; i++) emit8((value >> (8 * i)) & 0xFF);
+}
+
+static void emit64(uint64_t value) {
+  emit32((uint32_t)value);
+  emit32((uint32_t)(value >> 32));
+}
+
+static void emit_bytes(const byte_t* bytes, size_t count) {
+  for (size_t i = 0; i < count; i++) emit8(bytes[i]);
+}
+
+#define EMIT(...)                               \
+  do {                                          \
+    static const byte_t bytes_[] = {__VA_ARGS__}; \
+    emit_bytes(bytes_, sizeof(bytes_));         \
+  } while (0)
+
+// op reg, [rbx + r12*4 + disp] for data stack cell k (k = -1 is just above
+// the top). reg is eax..edx or an opcode extension.
+static void emit_cell(unsigned opcode, unsigned reg, int k) {
+  emit8(0x42);  // REX.X: r12 index
+  emit8(opcode);
+  emit8(0x84 | (reg << 3));
+  emit8(0xA3);  // scale 4, index r12, base rbx
+  emit32((uint32_t)(OFF_DS - 4 * (k + 1)));
+}
+
+// op reg, [rbx + disp] for a context field
+static void emit_field(unsigned opcode, unsigned reg, int32_t offset) {
+  if (reg >= 8) emit8(0x44);  // REX.R
+  emit8(opcode);
+  emit8(0x83 | ((reg & 7) << 3));
+  emit32((uint32_t)offset);
+}
+
+// op reg, [rbx + rcx*4 + RS + 4*k]: return stack cell k relative to ecx
+static void emit_rstack(unsigned opcode, unsigned reg, int k) {
+  emit8(opcode);
+  emit8(0x84 | (reg << 3));
+  emit8(0x8B);  // scale 4, index rcx, base rbx
+  emit32((uint32_t)(OFF_RS + 4 * k));
+}
+
+// Jump with a rel32 to patch later; returns the patch position
+static size_t emit_jump(unsigned cc) {
+  if (cc == CC_ALWAYS) {
+    emit8(0xE9);
+  } else {
+    emit8(0x0F);
+    emit8(0x80 | cc);
+  }
+  size_t at = pos;
+  emit32(0);
+  return at;
+}
+
+static void patch(size_t at, size_t target) {
+  if (failed) return;
+  int32_t rel = (int32_t)(target - (at + 4));
+  memcpy(&code[at], &rel, sizeof(rel));
+}
+
+static void jump_to_token(unsigned cc, int token) {
+  size_t at = emit_jump(cc);
+  if (fixup_count < (int)(sizeof(fixups) / sizeof(fixups[0]))) {
+    fixups[fixup_count++] = (jit_fixup_t){at, token};
+  } else {
+    failed = true;
+  }
+}
+
+static void jump_to_deopt(unsigned cc) { jump_to_token(cc, -1); }
+
+static void emit_call_absolute(uintptr_t function) {
+  EMIT(0x48, 0xB8);  // mov rax, imm64
+  emit64((uint64_t)function);
+  EMIT(0xFF, 0xD0);  // call rax
+}
+
+// call rel32 when the code buffer is within reach, else through rax
+static void emit_call_direct(uintptr_t function) {
+  intptr_t offset = (intptr_t)function - (intptr_t)(uintptr_t)&code[pos + 5];
+  if (offset != (int32_t)offset) {
+    emit_call_absolute(function);
+    return;
+  }
+  emit8(0xE8);
+  emit32((uint32_t)(int32_t)offset);
+}
+
+static void emit_epilogue(void) {
+  EMIT(0x41, 0x5D, 0x41, 0x5C, 0x5B, 0xC3);  // pop r13, r12, rbx; ret
+}
+
+static void flush_depth(void) {
+  if (dirty) emit_field(0x89, REG_R12, OFF_DSP);  // mov [dsp], r12d
+  dirty = false;
+}
+
+// Jump to slow unless min <= depth <= DATA_STACK_SIZE - grow
+static size_t guard_depth(int min, int grow) {
+  EMIT(0x41, 0x8D, 0x44, 0x24);  // lea eax, [r12 - min]
+  emit8((byte_t)(int8_t)-min);
+  emit8(0x3D);  // cmp eax, imm32
+  emit32((uint32_t)(DATA_STACK_SIZE - grow - min));
+  return emit_jump(CC_A);
+}
+
+// ecx = return stack depth; jump to slow unless min <= ecx <= max
+static size_t guard_return(int min, int max) {
+  emit_field(0x8B, REG_ECX, OFF_RSP);
+  EMIT(0x8D, 0x41);  // lea eax, [rcx - min]
+  emit8((byte_t)(int8_t)-min);
+  emit8(0x3D);
+  emit32((uint32_t)(max - min));
+  return emit_jump(CC_A);
+}
+
+// Jump to slow unless the cell address in eax is inside main memory
+static size_t guard_address(unsigned size) {
+  emit8(0x3D);  // cmp eax, imm32
+  emit32(FORTH_MEMORY_SIZE - size);
+  return emit_jump(CC_A);
+}
+
+static void emit_memory_base(void) {
+  EMIT(0x48, 0xBA);  // mov rdx, imm64
+  emit64((uint64_t)(uintptr_t)forth_memory);
+}
+
+static void adjust_depth(int delta) {
+  if (delta == 1) {
+    EMIT(0x41, 0xFF, 0xC4);  // inc r12d
+  } else if (delta == -1) {
+    EMIT(0x41, 0xFF, 0xCC);  // dec r12d
+  } else if (delta > 0) {
+    EMIT(0x41, 0x83, 0xC4);  // add r12d, imm8
+    emit8((byte_t)delta);
+  } else if (delta < 0) {
+    EMIT(0x41, 0x83, 0xEC);  // sub r12d, imm8
+    emit8((byte_t)-delta);
+  }
+  if (delta != 0) dirty = true;
+}
+
+// eax = flag (-1 or 0) from the last compare
+static void emit_flag(unsigned cc) {
+  emit8(0x0F);
+  emit8(0x90 | cc);
+  emit8(0xC0);                  // setcc al
+  EMIT(0x0F, 0xB6, 0xC0);       // movzx eax, al
+  EMIT(0xF7, 0xD8);             // neg eax
+}
+
+// ============================================================================
+// Token calls
+// ============================================================================
+
+// Whether a token can call its word's cfunc directly. Headers whose cfunc
+// may still change go through the header: a colon definition that isn't
+// native yet, or a CREATE word a later DOES> could claim.
+static bool bound_call(const word_t* word) {
+  return word->cfunc != execute_colon && word->cfunc != f_param_field;
+}
+
+// Call the token's cfunc the way execute_colon() would, then check that ip
+// moved where the token list says it should
+static void emit_call(const jit_token_t* token) {
+  flush_depth();
+  EMIT(0xC7, 0x83);  // mov dword [rbx + ip], imm32
+  emit32((uint32_t)OFF_IP);
+  emit32(token->addr + sizeof(cell_t));
+  EMIT(0x48, 0x89, 0xDF);  // mov rdi, rbx
+  EMIT(0x48, 0xBE);        // mov rsi, imm64
+  emit64((uint64_t)(uintptr_t)token->word);
+  if (bound_call(token->word)) {
+    emit_call_direct((uintptr_t)token->word->cfunc);
+  } else {
+    EMIT(0xFF, 0x56, (byte_t)OFF_CFUNC);  // call [rsi + cfunc]
+  }
+  emit_field(0x8B, REG_R12, OFF_DSP);  // mov r12d, [dsp]
+
+  if (token->target >= 0) {
+    emit_field(0x8B, REG_EAX, OFF_IP);
+    emit8(0x3D);
+    emit32(token->next);
+    size_t fall = emit_jump(CC_E);
+    emit8(0x3D);
+    emit32((uint32_t)token->operand);
+    jump_to_token(CC_E, token->target);
+    jump_to_deopt(CC_ALWAYS);
+    patch(fall, pos);
+  } else {
+    EMIT(0x81, 0xBB);  // cmp dword [rbx + ip], imm32
+    emit32((uint32_t)OFF_IP);
+    emit32(token->next);
+    jump_to_deopt(CC_NE);
+  }
+}
+
+// Slow path for a template covering tokens first..last: patch the guard
+// jumps here and call each token for real
+static void emit_slow_path(const size_t* guards, int guard_count, int first,
+                           int last) {
+  size_t done = emit_jump(CC_ALWAYS);
+  for (int i = 0; i < guard_count; i++) patch(guards[i], pos);
+
+  dirty = true;  // The fast path may have moved r12 before bailing
+  for (int i = first; i <= last; i++) emit_call(&tokens[i]);
+
+  patch(done, pos);
+  dirty = true;
+}
+
+// ============================================================================
+// Templates
+// ============================================================================
+
+static bool is_binary(jit_op_t op) { return op >= OP_ADD && op <= OP_XOR; }
+
+static bool is_compare(jit_op_t op) { return op >= OP_EQ && op <= OP_UGT; }
+
+static bool is_zero_compare(jit_op_t op) {
+  return op >= OP_0EQ && op <= OP_0GT;
+}
+
+// Group 1 extension (/digit) of a binary op; the register form is 8*digit+1
+static unsigned binary_digit(jit_op_t op) {
+  switch (op) {
+    case OP_ADD:
+      return 0;
+    case OP_OR:
+      return 1;
+    case OP_AND:
+      return 4;
+    case OP_SUB:
+      return 5;
+    default:
+      return 6;  // XOR
+  }
+}
+
+static unsigned compare_cc(jit_op_t op) {
+  switch (op) {
+    case OP_EQ:
+    case OP_0EQ:
+      return CC_E;
+    case OP_NE:
+    case OP_0NE:
+      return CC_NE;
+    case OP_LT:
+    case OP_0LT:
+      return CC_L;
+    case OP_GT:
+    case OP_0GT:
+      return CC_G;
+    case OP_LE:
+      return CC_LE;
+    case OP_GE:
+      return CC_GE;
+    case OP_ULT:
+      return CC_B;
+    default:
+      return CC_A;  // U>
+  }
+}
+
+// Stack shuffles and unary ops: ( min items, grow ) and the body
+static bool emit_stack_template(jit_op_t op, int i) {
+  static const struct {
+    jit_op_t op;
+    int8_t min, grow;
+  } shapes[] = {
+      {OP_DUP, 1, 1},    {OP_DROP, 1, 0},   {OP_SWAP, 2, 0},
+      {OP_OVER, 2, 1},   {OP_NIP, 2, 0},    {OP_TUCK, 2, 1},
+      {OP_ROT, 3, 0},    {OP_2DUP, 2, 2},   {OP_2DROP, 2, 0},
+      {OP_INVERT, 1, 0}, {OP_NEGATE, 1, 0}, {OP_1PLUS, 1, 0},
+      {OP_1MINUS, 1, 0}, {OP_CELL_PLUS, 1, 0},
+      {OP_2STAR, 1, 0},  {OP_CELLS, 1, 0},
+  };
+
+  size_t s;
+  for (s = 0; s < sizeof(shapes) / sizeof(shapes[0]); s++) {
+    if (shapes[s].op == op) break;
+  }
+  if (s == sizeof(shapes) / sizeof(shapes[0])) return false;
+
+  size_t guard = guard_depth(shapes[s].min, shapes[s].grow);
+
+  switch (op) {
+    case OP_DUP:
+      emit_cell(0x8B, REG_EAX, 0);
+      emit_cell(0x89, REG_EAX, -1);
+      adjust_depth(1);
+      break;
+    case OP_DROP:
+      adjust_depth(-1);
+      break;
+    case OP_SWAP:
+      emit_cell(0x8B, REG_EAX, 0);
+      emit_cell(0x8B, REG_ECX, 1);
+      emit_cell(0x89, REG_ECX, 0);
+      emit_cell(0x89, REG_EAX, 1);
+      break;
+    case OP_OVER:
+      emit_cell(0x8B, REG_EAX, 1);
+      emit_cell(0x89, REG_EAX, -1);
+      adjust_depth(1);
+      break;
+    case OP_NIP:
+      emit_cell(0x8B, REG_EAX, 0);
+      emit_cell(0x89, REG_EAX, 1);
+      adjust_depth(-1);
+      break;
+    case OP_TUCK:
+      emit_cell(0x8B, REG_EAX, 0);
+      emit_cell(0x8B, REG_ECX, 1);
+      emit_cell(0x89, REG_EAX, 1);
+      emit_cell(0x89, REG_ECX, 0);
+      emit_cell(0x89, REG_EAX, -1);
+      adjust_depth(1);
+      break;
+    case OP_ROT:
+      emit_cell(0x8B, REG_EAX, 2);
+      emit_cell(0x8B, REG_ECX, 1);
+      emit_cell(0x8B, REG_EDX, 0);
+      emit_cell(0x89, REG_ECX, 2);
+      emit_cell(0x89, REG_EDX, 1);
+      emit_cell(0x89, REG_EAX, 0);
+      break;
+    case OP_2DUP:
+      emit_cell(0x8B, REG_EAX, 1);
+      emit_cell(0x8B, REG_ECX, 0);
+      emit_cell(0x89, REG_EAX, -1);
+      emit_cell(0x89, REG_ECX, -2);
+      adjust_depth(2);
+      break;
+    case OP_2DROP:
+      adjust_depth(-2);
+      break;
+    case OP_INVERT:
+      emit_cell(0xF7, 2, 0);  // not
+      break;
+    case OP_NEGATE:
+      emit_cell(0xF7, 3, 0);  // neg
+      break;
+    case OP_2STAR:
+    case OP_CELLS:
+      emit_cell(0xC1, 4, 0);  // shl imm8
+      emit8(op == OP_2STAR ? 1 : 2);
+      break;
+    default:  // 1+ 1- CELL+
+      emit_cell(0x81, op == OP_1MINUS ? 5 : 0, 0);
+      emit32(op == OP_CELL_PLUS ? 4 : 1);
+      break;
+  }
+
+  emit_slow_path(&guard, 1, i, i);
+  return true;
+}
+
+// Cell and byte access to main memory; other addresses take the slow path
+static void emit_memory_template(jit_op_t op, int i) {
+  bool store = op == OP_STORE || op == OP_C_STORE;
+  bool byte = op == OP_C_FETCH || op == OP_C_STORE;
+  size_t guards[2];
+
+  guards[0] = guard_depth(store ? 2 : 1, 0);
+  emit_cell(0x8B, REG_EAX, 0);
+  guards[1] = guard_address(byte ? 1 : sizeof(cell_t));
+  emit_memory_base();
+
+  if (store) {
+    emit_cell(0x8B, REG_ECX, 1);
+    if (byte) {
+      EMIT(0x88, 0x0C, 0x02);  // mov [rdx + rax], cl
+    } else {
+      EMIT(0x89, 0x0C, 0x02);  // mov [rdx + rax], ecx
+    }
+    adjust_depth(-2);
+  } else {
+    if (byte) {
+      EMIT(0x0F, 0xB6, 0x04, 0x02);  // movzx eax, byte [rdx + rax]
+    } else {
+      EMIT(0x8B, 0x04, 0x02);  // mov eax, [rdx + rax]
+    }
+    emit_cell(0x89, REG_EAX, 0);
+  }
+
+  emit_slow_path(guards, 2, i, i);
+}
+
+// >R R> R@ I (DO) (LOOP): the return stack is not cached, only its cells
+static void emit_return_template(jit_op_t op, int i) {
+  size_t guards[2];
+  int count = 0;
+
+  switch (op) {
+    case OP_TO_R:
+      guards[count++] = guard_depth(1, 0);
+      guards[count++] = guard_return(0, RETURN_STACK_SIZE - 1);
+      emit_cell(0x8B, REG_EAX, 0);
+      emit_rstack(0x89, REG_EAX, 0);
+      EMIT(0xFF, 0xC1);  // inc ecx
+      emit_field(0x89, REG_ECX, OFF_RSP);
+      adjust_depth(-1);
+      break;
+    case OP_R_FROM:
+    case OP_R_FETCH:
+    case OP_I:
+      guards[count++] = guard_depth(0, 1);
+      guards[count++] =
+          guard_return(op == OP_I ? 2 : 1, RETURN_STACK_SIZE);
+      emit_rstack(0x8B, REG_EAX, -1);
+      if (op == OP_I) {
+        emit_rstack(0x03, REG_EAX, -2);  // add eax, bias: the index
+      }
+      if (op == OP_R_FROM) {
+        EMIT(0xFF, 0xC9);  // dec ecx
+        emit_field(0x89, REG_ECX, OFF_RSP);
+      }
+      emit_cell(0x89, REG_EAX, -1);
+      adjust_depth(1);
+      break;
+    case OP_DO:
+      guards[count++] = guard_depth(2, 0);
+      guards[count++] = guard_return(0, RETURN_STACK_SIZE - 2);
+      emit_cell(0x8B, REG_EAX, 1);  // limit
+      emit_cell(0x8B, REG_EDX, 0);  // start
+      emit8(0x35);                  // xor eax, LOOP_BIAS: the bias
+      emit32(LOOP_BIAS);
+      EMIT(0x29, 0xC2);  // sub edx, eax: the biased index
+      emit_rstack(0x89, REG_EAX, 0);
+      emit_rstack(0x89, REG_EDX, 1);
+      EMIT(0x83, 0xC1, 0x02);  // add ecx, 2
+      emit_field(0x89, REG_ECX, OFF_RSP);
+      adjust_depth(-2);
+      break;
+    default:  // (LOOP): biased index on top, done when it overflows
+      guards[count++] = guard_return(2, RETURN_STACK_SIZE);
+      emit_rstack(0xFF, 0, -1);  // inc dword [index]
+      jump_to_token(CC_NO, tokens[i].target);
+      EMIT(0x83, 0xE9, 0x02);  // sub ecx, 2
+      emit_field(0x89, REG_ECX, OFF_RSP);
+      break;
+  }
+
+  emit_slow_path(guards, count, i, i);
+}
+
+// cmp of the top cell with imm and whatever follows it: a flag in place, or
+// with a 0BRANCH at last, a conditional jump
+static void emit_compare_immediate(unsigned cc, cell_t imm, int first,
+                                   int last) {
+  size_t guard = guard_depth(1, 0);
+
+  if (tokens[last].op == OP_0BRANCH) {
+    emit_cell(0x8B, REG_EAX, 0);
+    adjust_depth(-1);
+    emit8(0x3D);  // cmp eax, imm32
+    emit32((uint32_t)imm);
+    jump_to_token(cc ^ 1, tokens[last].target);
+  } else {
+    emit_cell(0x81, 7, 0);  // cmp dword [top], imm32
+    emit32((uint32_t)imm);
+    emit_flag(cc);
+    emit_cell(0x89, REG_EAX, 0);
+  }
+
+  emit_slow_path(&guard, 1, first, last);
+}
+
+// Two-cell compare, optionally fused with the 0BRANCH at last
+static void emit_compare(unsigned cc, int first, int last) {
+  size_t guard = guard_depth(2, 0);
+
+  if (tokens[last].op == OP_0BRANCH) {
+    emit_cell(0x8B, REG_EAX, 0);
+    emit_cell(0x8B, REG_ECX, 1);
+    adjust_depth(-2);
+    EMIT(0x39, 0xC1);  // cmp ecx, eax
+    jump_to_token(cc ^ 1, tokens[last].target);
+  } else {
+    emit_cell(0x8B, REG_EAX, 0);
+    emit_cell(0x39, REG_EAX, 1);  // cmp [second], eax
+    emit_flag(cc);
+    emit_cell(0x89, REG_EAX, 1);
+    adjust_depth(-1);
+  }
+
+  emit_slow_path(&guard, 1, first, last);
+}
+
+// True when token i exists and nothing branches into it, so it can be fused
+// with the token before it
+static bool fusable(int i, jit_op_t op) {
+  return i < token_count && !tokens[i].landing && tokens[i].op == op;
+}
+
+static bool fusable_if(int i, bool (*kind)(jit_op_t)) {
+  return i < token_count && !tokens[i].landing && kind(tokens[i].op);
+}
+
+static bool is_0branch(jit_op_t op) { return op == OP_0BRANCH; }
+
+// Emit token i (and any tokens fused with it); returns the next token index
+static int emit_token(int i) {
+  jit_token_t* token = &tokens[i];
+
+  switch (token->op) {
+    case OP_CALL:
+      emit_call(token);
+      return i + 1;
+
+    case OP_EXIT: {
+      // Inline EXIT: ip = R> if the return stack has anything, else 0
+      flush_depth();
+      emit_field(0x8B, REG_ECX, OFF_RSP);
+      EMIT(0x85, 0xC9);  // test ecx, ecx
+      size_t empty = emit_jump(CC_LE);
+      EMIT(0xFF, 0xC9);  // dec ecx
+      emit_field(0x89, REG_ECX, OFF_RSP);
+      emit_rstack(0x8B, REG_EAX, 0);
+      size_t popped = emit_jump(CC_ALWAYS);
+      patch(empty, pos);
+      EMIT(0x31, 0xC0);  // xor eax, eax
+      patch(popped, pos);
+      emit_field(0x89, REG_EAX, OFF_IP);
+      emit_epilogue();
+      dirty = true;
+      return i + 1;
+    }
+
+    case OP_BRANCH:
+      flush_depth();  // Labels assume nothing about ctx->data_stack_ptr
+      jump_to_token(CC_ALWAYS, token->target);
+      dirty = true;
+      return i + 1;
+
+    case OP_0BRANCH: {
+      size_t guard = guard_depth(1, 0);
+      adjust_depth(-1);
+      emit_cell(0x81, 7, -1);  // cmp dword [popped], 0
+      emit32(0);
+      jump_to_token(CC_E, token->target);
+      emit_slow_path(&guard, 1, i, i);
+      return i + 1;
+    }
+
+    case OP_LIT:
+      if (fusable_if(i + 1, is_binary)) {
+        jit_op_t op = tokens[i + 1].op;
+        size_t guard = guard_depth(1, 0);
+        emit_cell(0x81, binary_digit(op), 0);  // op dword [top], imm32
+        emit32((uint32_t)token->operand);
+        emit_slow_path(&guard, 1, i, i + 1);
+        return i + 2;
+      }
+      if (fusable_if(i + 1, is_compare)) {
+        int last = fusable(i + 2, OP_0BRANCH) ? i + 2 : i + 1;
+        emit_compare_immediate(compare_cc(tokens[i + 1].op), token->operand,
+                               i, last);
+        return last + 1;
+      }
+      {
+        size_t guard = guard_depth(0, 1);
+        emit_cell(0xC7, 0, -1);  // mov dword [new top], imm32
+        emit32((uint32_t)token->operand);
+        adjust_depth(1);
+        emit_slow_path(&guard, 1, i, i);
+      }
+      return i + 1;
+
+    case OP_DO:
+    case OP_LOOP:
+    case OP_I:
+    case OP_TO_R:
+    case OP_R_FROM:
+    case OP_R_FETCH:
+      emit_return_template(token->op, i);
+      return i + 1;
+
+    case OP_FETCH:
+    case OP_STORE:
+    case OP_C_FETCH:
+    case OP_C_STORE:
+      emit_memory_template(token->op, i);
+      return i + 1;
+
+    default:
+      break;
+  }
+
+  if (is_binary(token->op)) {
+    size_t guard = guard_depth(2, 0);
+    emit_cell(0x8B, REG_EAX, 0);
+    emit_cell(8 * binary_digit(token->op) + 1, REG_EAX, 1);  // op [second], eax
+    adjust_depth(-1);
+    emit_slow_path(&guard, 1, i, i);
+    return i + 1;
+  }
+
+  if (is_compare(token->op)) {
+    int last = fusable_if(i + 1, is_0branch) ? i + 1 : i;
+    emit_compare(compare_cc(token->op), i, last);
+    return last + 1;
+  }
+
+  if (is_zero_compare(token->op)) {
+    int last = fusable_if(i + 1, is_0branch) ? i + 1 : i;
+    emit_compare_immediate(compare_cc(token->op), 0, i, last);
+    return last + 1;
+  }
+
+  if (!emit_stack_template(token->op, i)) emit_call(token);
+  return i + 1;
+}
+
+// ============================================================================
+// Compilation
+// ============================================================================
+
+static jit_op_t template_op(word_t* word) {
+  for (size_t i = 0; i < TEMPLATE_COUNT; i++) {
+    if (template_words[i] == word) return template_names[i].op;
+  }
+  return OP_CALL;
+}
+
+static int token_index(forth_addr_t addr) {
+  int low = 0, high = token_count - 1;
+  while (low <= high) {
+    int mid = (low + high) / 2;
+    if (tokens[mid].addr == addr) return mid;
+    if (tokens[mid].addr < addr) {
+      low = mid + 1;
+    } else {
+      high = mid - 1;
+    }
+  }
+  return -1;
+}
+
+// Split a body into tokens, stopping at the EXIT or BRANCH that no forward
+// branch jumps past. Anything that doesn't look like compiled code gives up.
+static bool decode_body(forth_addr_t ip) {
+  forth_addr_t reach = ip;  // Furthest forward branch target
+  token_count = 0;
+
+  for (;;) {
+    if (token_count == JIT_MAX_TOKENS) return false;
+    if (ip > here - sizeof(cell_t)) return false;
+
+    forth_addr_t xt;
+    memcpy(&xt, &forth_memory[ip], sizeof(xt));
+    if (xt > FORTH_MEMORY_SIZE - sizeof(word_t)) return false;
+
+    jit_token_t* token = &tokens[token_count++];
+    token->addr = ip;
+    token->word = (word_t*)&forth_memory[xt];
+    token->op = template_op(token->word);
+    token->target = -1;
+    token->landing = false;
+    token->operand = 0;
+
+    uint32_t flags = token->word->flags;
+    ip += sizeof(cell_t);
+    if (flags & (WORD_FLAG_OPERAND_CELL | WORD_FLAG_OPERAND_FLOAT |
+                 WORD_FLAG_OPERAND_STRING)) {
+      if (ip > here - sizeof(cell_t)) return false;
+      memcpy(&token->operand, &forth_memory[ip], sizeof(cell_t));
+    }
+
+    if (flags & WORD_FLAG_OPERAND_CELL) {
+      ip += sizeof(cell_t);
+    } else if (flags & WORD_FLAG_OPERAND_FLOAT) {
+      ip += 2 * sizeof(cell_t);
+    } else if (flags & WORD_FLAG_OPERAND_STRING) {
+      if ((ucell_t)token->operand > here) return false;
+      ip = (forth_addr_t)align_up(ip + sizeof(cell_t) + token->operand,
+                                  sizeof(cell_t));
+    }
+    token->next = ip;
+
+    if ((flags & WORD_FLAG_BRANCH) && (forth_addr_t)token->operand > reach) {
+      reach = (forth_addr_t)token->operand;
+    }
+
+    if ((token->op == OP_EXIT || token->op == OP_BRANCH) && reach < ip) break;
+  }
+
+  // Every branch must land on a token of this body
+  for (int i = 0; i < token_count; i++) {
+    if (!(tokens[i].word->flags & WORD_FLAG_BRANCH)) continue;
+    int target = token_index((forth_addr_t)tokens[i].operand);
+    if (target < 0) return false;
+    tokens[i].target = target;
+    tokens[target].landing = true;
+  }
+
+  return true;
+}
+
+static void emit_prologue(void) {
+#ifdef FORTH_ENABLE_TESTS
+  // Collecting coverage: run threaded so every token is marked
+  EMIT(0x48, 0xB8);  // mov rax, &coverage_enabled
+  emit64((uint64_t)(uintptr_t)&coverage_enabled);
+  EMIT(0x80, 0x38, 0x00);  // cmp byte [rax], 0
+  EMIT(0x74, 0x0C);        // je past the tail call
+  EMIT(0x48, 0xB8);        // mov rax, execute_colon
+  emit64((uint64_t)(uintptr_t)execute_colon);
+  EMIT(0xFF, 0xE0);  // jmp rax
+#endif
+
+  EMIT(0x53, 0x41, 0x54, 0x41, 0x55);  // push rbx, r12, r13
+  EMIT(0x48, 0x89, 0xFB);              // mov rbx, rdi
+  emit_field(0x8B, REG_R13, OFF_RSP);  // r13d = frame
+
+  // return_push(ctx, ctx->ip), inline unless it would overflow
+  EMIT(0x41, 0x81, 0xFD);  // cmp r13d, imm32
+  emit32(RETURN_STACK_SIZE);
+  size_t full = emit_jump(CC_GE);
+  emit_field(0x8B, REG_EAX, OFF_IP);
+  EMIT(0x44, 0x89, 0xE9);  // mov ecx, r13d
+  emit_rstack(0x89, REG_EAX, 0);
+  EMIT(0xFF, 0xC1);  // inc ecx
+  emit_field(0x89, REG_ECX, OFF_RSP);
+  size_t pushed = emit_jump(CC_ALWAYS);
+  patch(full, pos);
+  EMIT(0x48, 0x89, 0xDF);  // mov rdi, rbx
+  emit_field(0x8B, REG_ESI, OFF_IP);
+  emit_call_direct((uintptr_t)return_push);
+  patch(pushed, pos);
+
+  emit_field(0x8B, REG_R12, OFF_DSP);
+  dirty = false;
+}
+
+// Hand the rest of the definition to the inner interpreter
+static size_t emit_deopt(void) {
+  size_t start = pos;
+  emit_field(0x89, REG_R12, OFF_DSP);
+  EMIT(0x48, 0x89, 0xDF);  // mov rdi, rbx
+  EMIT(0x44, 0x89, 0xEE);  // mov esi, r13d
+  emit_call_direct((uintptr_t)execute_tokens);
+  emit_epilogue();
+  return start;
+}
+
+// Switch the code buffer between read-write and read-execute
+static bool code_writable(bool writable) {
+  int prot = PROT_READ | (writable ? PROT_WRITE : PROT_EXEC);
+  return mprotect(code, JIT_CODE_SIZE, prot) == 0;
+}
+
+// Emit word's native code into the writable buffer; false if it didn't fit
+static bool emit_definition(word_t* word) {
+  size_t start = align_up(code_used, 16);
+  pos = start;
+  failed = false;
+  fixup_count = 0;
+
+  emit_prologue();
+  for (int i = 0; i < token_count;) {
+    // Tokens fused into a template don't get labels; nothing lands on them
+    tokens[i].label = pos;
+    if (tokens[i].landing) dirty = true;
+    i = emit_token(i);
+  }
+
+  // A body can only end in EXIT or BRANCH, but don't run off the end
+  EMIT(0xC7, 0x83);  // mov dword [rbx + ip], end
+  emit32((uint32_t)OFF_IP);
+  emit32(tokens[token_count - 1].next);
+  jump_to_deopt(CC_ALWAYS);
+
+  size_t deopt = emit_deopt();
+  for (int i = 0; i < fixup_count; i++) {
+    int target = fixups[i].token;
+    patch(fixups[i].at, target < 0 ? deopt : tokens[target].label);
+  }
+
+  if (failed) {
+    debug("JIT: out of code space compiling %s", word->name);
+    return false;
+  }
+
+  code_used = pos;
+  word->cfunc = (void (*)(context_t*, word_t*))(uintptr_t)&code[start];
+  debug("JIT: %s compiled to %zu bytes", word->name, pos - start);
+  return true;
+}
+
+bool jit_compile(word_t* word) {
+  if (!jit_ready || word->cfunc != execute_colon ||
+      word->param_type != PARAM_ADDRESS) {
+    return false;
+  }
+
+  if (!decode_body(word->param.address)) {
+    debug("JIT: %s stays threaded", word->name);
+    return false;
+  }
+
+  // Native code calling into the interpreter may be what got us here; it
+  // is executable again before we return to it
+  if (!code_writable(true)) return false;
+  bool compiled = emit_definition(word);
+  if (!code_writable(false)) {
+    // Nothing in the buffer can run now: every word goes back to threaded
+    debug("JIT: code buffer can't be made executable again");
+    for (word_t* w = dictionary_head; w != NULL; w = w->link) {
+      if (jit_compiled(w)) w->cfunc = execute_colon;
+    }
+    jit_ready = false;
+    code_used = 0;
+    return false;
+  }
+  return compiled;
+}
+
+bool jit_compiled(word_t* word) {
+  return code && (uintptr_t)word->cfunc - (uintptr_t)code < code_used;
+}
+
+void jit_reset(void) {
+  jit_ready = false;
+  code_used = 0;
+}
+
+#ifdef JIT_SUBROUTINE_THREADED
+// Subroutine threading keeps only the simplest templates and control flow
+static bool subroutine_template(jit_op_t op) {
+  switch (op) {
+    case OP_LIT:
+    case OP_EXIT:
+    case OP_BRANCH:
+    case OP_0BRANCH:
+    case OP_DUP:
+    case OP_DROP:
+    case OP_ADD:
+      return true;
+    default:
+      return false;
+  }
+}
+#endif
+
+bool jit_has_template(const char* name) {
+  for (size_t i = 0; i < TEMPLATE_COUNT; i++) {
+#ifdef JIT_SUBROUTINE_THREADED
+    if (!subroutine_template(template_names[i].op)) continue;
+#endif
+    if (strcmp(template_names[i].name, name) == 0) return true;
+  }
+  return false;
+}
+
+#if JIT_THRESHOLD == 0
+// Oldest first, so calls to earlier definitions bind to their native code
+static void compile_all(word_t* word) {
+  if (!word) return;
+  compile_all(word->link);
+  jit_compile(word);
+}
+#endif
+
+void jit_init(void) {
+  if (!code) {
+    // Ask for space near the interpreter so calls into it fit in a rel32
+    uintptr_t text = (uintptr_t)execute_colon & ~(uintptr_t)0xFFFF;
+    uintptr_t near = text > 0x20000000 ? text - 0x10000000 : text + 0x10000000;
+    void* buffer = mmap((void*)near, JIT_CODE_SIZE, PROT_READ | PROT_WRITE,
+                        MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (buffer == MAP_FAILED) {
+      debug("JIT: no code memory, running threaded");
+      return;
+    }
+    code = buffer;
+
+    // Find out now whether the system lets it become executable
+    if (!code_writable(false)) {
+      debug("JIT: no executable memory, running threaded");
+      munmap(buffer, JIT_CODE_SIZE);
+      code = NULL;
+      return;
+    }
+  }
+
+  for (size_t i = 0; i < TEMPLATE_COUNT; i++) {
+#ifdef JIT_SUBROUTINE_THREADED
+    if (!subroutine_template(template_names[i].op)) continue;
+#endif
+    template_words[i] = search_word(template_names[i].name);
+  }
+  jit_ready = true;
+
+#if JIT_THRESHOLD == 0
+  // The builtins were defined before the templates were known
+  compile_all(dictionary_head);
+#endif
+
+  debug("JIT: %zu bytes of native code", code_used);
+}
+
+#endif  // FORTH_ENABLE_JIT
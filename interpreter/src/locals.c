@@ -0,0 +1,235 @@
+#include "locals.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include "core.h"
+#include "debug.h"
+#include "dictionary.h"
+#include "error.h"
+#include "memory.h"
+#include "stack.h"
+#include "text.h"
+
+#ifdef FORTH_ENABLE_LOCALS
+
+/*
+ * Frames
+ * ======
+ * (LOCALS) n moves n cells from the data stack to the return stack (the
+ * deepest becomes local 0) on top of the caller's frame index:
+ *
+ *   return stack: ... caller-frame | local 0 | local 1 | ... | local n-1
+ *                                    ^ ctx->locals_frame
+ *
+ * (UNLOCALS) cuts the return stack back and restores the caller's frame.
+ * Loops and >R inside the definition sit above the frame, so slots stay at
+ * fixed indexes.
+ */
+
+// Names of the current definition's locals, by slot (compile time only)
+static char local_names[MAX_LOCALS][32];
+static int local_count = 0;
+
+// (LOCAL@n) and (LOCAL!n), indexed by slot
+static word_t* local_fetch_words[MAX_LOCALS];
+static word_t* local_store_words[MAX_LOCALS];
+
+// (LOCALS) ( x0 ... xn-1 -- ) ( R: -- frame x0 ... xn-1 )
+static void f_locals_runtime(context_t* ctx, word_t* self) {
+  (void)self;
+
+  cell_t count = forth_fetch(ctx, ctx->ip);
+  ctx->ip += sizeof(cell_t);
+
+  return_push(ctx, ctx->locals_frame);
+  int frame = ctx->return_stack_ptr;
+
+  for (cell_t i = 0; i < count; i++) return_push(ctx, 0);
+  for (cell_t i = count - 1; i >= 0; i--) {
+    ctx->return_stack[frame + i] = data_pop(ctx);
+  }
+
+  ctx->locals_frame = frame;
+}
+
+// (UNLOCALS) ( -- ) ( R: frame x0 ... -- )
+static void f_unlocals_runtime(context_t* ctx, word_t* self) {
+  (void)self;
+
+  ctx->return_stack_ptr = ctx->locals_frame;
+  ctx->locals_frame = return_pop(ctx);
+}
+
+// (LOCAL@n) ( -- x )
+static void f_local_fetch_runtime(context_t* ctx, word_t* self) {
+  data_push(ctx, ctx->return_stack[ctx->locals_frame + self->param.value]);
+}
+
+// (LOCAL!n) ( x -- )
+static void f_local_store_runtime(context_t* ctx, word_t* self) {
+  ctx->return_stack[ctx->locals_frame + self->param.value] = data_pop(ctx);
+}
+
+static int find_local(const char* name) {
+  for (int i = local_count - 1; i >= 0; i--) {
+    if (case_insensitive_strcmp(local_names[i], name) == 0) return i;
+  }
+  return -1;
+}
+
+bool compile_local(context_t* ctx, const char* name) {
+  int slot = find_local(name);
+  if (slot < 0) return false;
+
+  compile_token(ctx, ptr_to_addr(ctx, local_fetch_words[slot]));
+  return true;
+}
+
+bool compile_local_store(context_t* ctx, const char* name) {
+  int slot = find_local(name);
+  if (slot < 0) return false;
+
+  compile_token(ctx, ptr_to_addr(ctx, local_store_words[slot]));
+  return true;
+}
+
+bool locals_active(void) { return local_count > 0; }
+
+void end_locals(context_t* ctx) {
+  if (local_count == 0) return;
+
+  compile_token(ctx, ptr_to_addr(ctx, find_word(ctx, "(UNLOCALS)")));
+  forget_locals();
+}
+
+void forget_locals(void) { local_count = 0; }
+
+// Add a local name (slot = declaration order)
+static void declare_local(context_t* ctx, const char* name) {
+  if (local_count >= MAX_LOCALS) {
+    error(ctx, "Too many locals (max %d)", MAX_LOCALS);
+    return;
+  }
+
+  strncpy(local_names[local_count], name, sizeof(local_names[0]) - 1);
+  local_names[local_count][sizeof(local_names[0]) - 1] = '\0';
+  local_count++;
+}
+
+// Compile the frame entry for the locals just declared
+static void compile_frame(context_t* ctx) {
+  compile_token(ctx, ptr_to_addr(ctx, find_word(ctx, "(LOCALS)")));
+  compile_token(ctx, (forth_addr_t)local_count);
+
+  debug("Locals frame of %d cells", local_count);
+}
+
+static bool begin_declaration(context_t* ctx, const char* word) {
+  if (*state_ptr == 0) {
+    error(ctx, "%s can only be used in compilation mode", word);
+    return false;
+  }
+  if (local_count > 0) {
+    error(ctx, "Only one locals declaration per definition");
+    return false;
+  }
+  return true;
+}
+
+// {: ( "<spaces>args [| vals] [-- outs] :}" -- )
+// args take their values from the stack (the last one from the top); vals
+// start at zero; outs are a comment
+static void f_brace_colon(context_t* ctx, word_t* self) {
+  (void)self;
+
+  if (!begin_declaration(ctx, "{:")) return;
+
+  char name_buffer[32];
+  int initialized = -1;  // Locals taken from the stack, set at '|'
+  bool comment = false;
+
+  while (true) {
+    char* name = parse_name(ctx, name_buffer, sizeof(name_buffer));
+    if (!name) {
+      error(ctx, "Missing :}");
+      return;
+    }
+
+    if (strcmp(name, ":}") == 0) break;
+    if (comment) continue;
+
+    if (strcmp(name, "--") == 0) {
+      comment = true;
+    } else if (strcmp(name, "|") == 0 && initialized < 0) {
+      initialized = local_count;
+    } else {
+      declare_local(ctx, name);
+    }
+  }
+
+  // Uninitialized locals get zeros pushed after the arguments
+  if (initialized < 0) initialized = local_count;
+  for (int i = initialized; i < local_count; i++) compile_literal(ctx, 0);
+
+  if (local_count > 0) compile_frame(ctx);
+}
+
+// LOCALS| ( "<spaces>name1 ... namen |" -- )
+// name1 takes the value on top of the stack, name2 the one below, ...
+static void f_locals_bar(context_t* ctx, word_t* self) {
+  (void)self;
+
+  if (!begin_declaration(ctx, "LOCALS|")) return;
+
+  char names[MAX_LOCALS][32];
+  char name_buffer[32];
+  int count = 0;
+
+  while (true) {
+    char* name = parse_name(ctx, name_buffer, sizeof(name_buffer));
+    if (!name) {
+      error(ctx, "Missing | after LOCALS|");
+      return;
+    }
+    if (strcmp(name, "|") == 0) break;
+
+    if (count >= MAX_LOCALS) {
+      error(ctx, "Too many locals (max %d)", MAX_LOCALS);
+      return;
+    }
+    strcpy(names[count++], name);
+  }
+
+  // Slot 0 is the deepest value, which is the last name
+  for (int i = count - 1; i >= 0; i--) declare_local(ctx, names[i]);
+
+  if (local_count > 0) compile_frame(ctx);
+}
+
+void create_locals_primitives(void) {
+  create_operand_primitive_word("(LOCALS)", f_locals_runtime,
+                                WORD_FLAG_OPERAND_CELL);
+  create_primitive_word("(UNLOCALS)", f_unlocals_runtime);
+
+  for (int i = 0; i < MAX_LOCALS; i++) {
+    char name[16];
+
+    snprintf(name, sizeof(name), "(LOCAL@%d)", i);
+    local_fetch_words[i] = create_primitive_word(name, f_local_fetch_runtime);
+    local_fetch_words[i]->param.value = i;
+    local_fetch_words[i]->param_type = PARAM_VALUE;
+
+    snprintf(name, sizeof(name), "(LOCAL!%d)", i);
+    local_store_words[i] = create_primitive_word(name, f_local_store_runtime);
+    local_store_words[i]->param.value = i;
+    local_store_words[i]->param_type = PARAM_VALUE;
+  }
+
+  create_immediate_primitive_word("{:", f_brace_colon);
+  create_immediate_primitive_word("LOCALS|", f_locals_bar);
+
+  debug("Locals primitives created");
+}
+
+#endif  // FORTH_ENABLE_LOCALS
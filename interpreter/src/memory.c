@@ -3,6 +3,7 @@
 #include <assert.h>
 #include <string.h>
 
+#include "allocate.h"
 #include "debug.h"
 #include "error.h"
 #include "forth.h"
@@ -35,26 +36,37 @@ void input_system_init(void) {
 
 // Store cell (32-bit) at Forth address - implements ! (STORE)
 void forth_store(context_t* ctx, forth_addr_t addr, cell_t value) {
-  require(ctx, addr + sizeof(cell_t) <= FORTH_MEMORY_SIZE);
-  *(cell_t*)&forth_memory[addr] = value;
+  byte_t* ptr = forth_span_ptr(ctx, addr, sizeof(cell_t));
+  require(ctx, ptr != NULL);
+  if (ptr) *(cell_t*)ptr = value;
 }
 
 // Fetch cell (32-bit) from Forth address - implements @ (FETCH)
 cell_t forth_fetch(context_t* ctx, forth_addr_t addr) {
-  require(ctx, addr + sizeof(cell_t) <= FORTH_MEMORY_SIZE);
-  return *(cell_t*)&forth_memory[addr];
+  byte_t* ptr = forth_span_ptr(ctx, addr, sizeof(cell_t));
+  require(ctx, ptr != NULL);
+  return ptr ? *(cell_t*)ptr : 0;
 }
 
 // Store byte at Forth address - implements C! (C-STORE)
 void forth_c_store(context_t* ctx, forth_addr_t addr, byte_t value) {
-  require(ctx, addr < FORTH_MEMORY_SIZE);
-  forth_memory[addr] = value;
+  byte_t* ptr = forth_span_ptr(ctx, addr, 1);
+  require(ctx, ptr != NULL);
+  if (ptr) *ptr = value;
 }
 
 // Fetch byte from Forth address - implements C@ (C-FETCH)
 byte_t forth_c_fetch(context_t* ctx, forth_addr_t addr) {
-  require(ctx, addr < FORTH_MEMORY_SIZE);
-  return forth_memory[addr];
+  byte_t* ptr = forth_span_ptr(ctx, addr, 1);
+  require(ctx, ptr != NULL);
+  return ptr ? *ptr : 0;
+}
+
+// Check that bytes more fit at HERE below high memory (the ALLOCATE heap
+// among it); an error if not
+bool forth_room(context_t* ctx, size_t bytes) {
+  require(ctx, here + bytes <= forth_end, "Dictionary full");
+  return here + bytes <= forth_end;
 }
 
 // Allocate bytes in virtual memory and advance HERE
@@ -62,7 +74,7 @@ forth_addr_t forth_allot(context_t* ctx, size_t bytes) {
   // Ensure allocation starts on aligned boundary
   forth_align();
 
-  require(ctx, here + bytes <= FORTH_MEMORY_SIZE);  // Simple bounds check
+  require(ctx, here + bytes <= forth_end);  // Don't run into high memory
 
   forth_addr_t old_here = here;
   here += bytes;
@@ -108,8 +120,14 @@ forth_addr_t forth_allot_high(context_t* ctx, size_t bytes) {
   return forth_end;
 }
 
-// Reset function for REPL
-void forth_reset_high_memory(void) { forth_end = FORTH_MEMORY_SIZE; }
+// Reset function for REPL (also forgets every ALLOCATEd block)
+void forth_reset_high_memory(void) {
+  forth_end = FORTH_MEMORY_SIZE;
+
+#ifdef FORTH_ENABLE_ALLOCATE
+  heap_reset();
+#endif
+}
 
 void forth_align_down(forth_addr_t* addr) {
   *addr = *addr & ~(sizeof(cell_t) - 1);
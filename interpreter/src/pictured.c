@@ -0,0 +1,178 @@
+#include "pictured.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "core.h"
+#include "debug.h"
+#include "dictionary.h"
+#include "error.h"
+#include "memory.h"
+#include "stack.h"
+#include "util.h"
+
+// BASE, or decimal when BASE holds something unusable
+static unsigned current_base(void) {
+  cell_t base = *base_ptr;
+  return base < 2 || base > 36 ? 10 : (unsigned)base;
+}
+
+// Prepend length characters to the pictured string
+static void hold_chars(context_t* ctx, const char* chars, cell_t length) {
+  if (length <= 0) return;
+
+  if (length > ctx->hold_index) {
+    error(ctx, "Pictured output overflow");
+    return;
+  }
+
+  ctx->hold_index -= length;
+  memmove(&ctx->pictured_buffer[ctx->hold_index], chars, (size_t)length);
+}
+
+// Print a right-justified number: spaces to fill width, then the digits
+static void print_justified(const char* digits, cell_t length, cell_t width) {
+  for (cell_t i = length; i < width; i++) putchar(' ');
+  fwrite(digits, 1, (size_t)length, stdout);
+  fflush(stdout);
+}
+
+// <# ( -- )  Start a pictured numeric conversion
+static void f_less_number_sign(context_t* ctx, word_t* self) {
+  (void)self;
+
+  ctx->hold_index = PICTURED_BUFFER_SIZE;
+}
+
+// # ( ud1 -- ud2 )  Convert one digit
+static void f_number_sign(context_t* ctx, word_t* self) {
+  (void)self;
+
+  uint64_t ud = (uint64_t)data_pop_double(ctx);
+  unsigned base = current_base();
+  uint64_t quotient;
+
+  // Stay in 32-bit division when the value fits a cell
+  if (ud <= UINT32_MAX) {
+    quotient = (uint32_t)ud / base;
+  } else {
+    quotient = ud / base;
+  }
+
+  char digit = digit_to_char((int)(ud - quotient * base));
+  hold_chars(ctx, &digit, 1);
+  data_push_double(ctx, (int64_t)quotient);
+}
+
+// #S ( ud -- 0 0 )  Convert all remaining digits (at least one)
+static void f_number_sign_s(context_t* ctx, word_t* self) {
+  (void)self;
+
+  uint64_t ud = (uint64_t)data_pop_double(ctx);
+  char buffer[64];  // Enough for 64-bit binary
+  char* end = buffer + sizeof(buffer);
+
+  char* p = format_unsigned(ud, current_base(), end);
+  hold_chars(ctx, p, (cell_t)(end - p));
+  data_push_double(ctx, 0);
+}
+
+// #> ( xd -- c-addr u )  End conversion, leaving the pictured string
+static void f_number_sign_greater(context_t* ctx, word_t* self) {
+  (void)self;
+
+  data_pop_double(ctx);
+  data_push(ctx, (cell_t)(PICTURED_BUFFER_ADDR + ctx->hold_index));
+  data_push(ctx, PICTURED_BUFFER_SIZE - ctx->hold_index);
+}
+
+// HOLD ( char -- )
+static void f_hold(context_t* ctx, word_t* self) {
+  (void)self;
+
+  char c = (char)data_pop(ctx);
+  hold_chars(ctx, &c, 1);
+}
+
+// HOLDS ( c-addr u -- )
+static void f_holds(context_t* ctx, word_t* self) {
+  (void)self;
+
+  cell_t u = data_pop(ctx);
+  forth_addr_t addr = (forth_addr_t)data_pop(ctx);
+
+  if (u <= 0) return;
+
+  const char* chars = addr_range_to_ptr(ctx, addr, (ucell_t)u);
+  if (chars) hold_chars(ctx, chars, u);
+}
+
+// SIGN ( n -- )  Hold a minus sign if n is negative
+static void f_sign(context_t* ctx, word_t* self) {
+  (void)self;
+
+  if (data_pop(ctx) < 0) hold_chars(ctx, "-", 1);
+}
+
+// U. ( u -- )  Print unsigned number (BASE-aware)
+static void f_u_dot(context_t* ctx, word_t* self) {
+  (void)self;
+
+  ucell_t u = (ucell_t)data_pop(ctx);
+  char buffer[33];
+  char* end = buffer + sizeof(buffer);
+
+  char* p = format_unsigned(u, current_base(), end - 1);
+  end[-1] = ' ';
+  print_justified(p, (cell_t)(end - p), 0);
+}
+
+// .R ( n1 n2 -- )  Print n1 right-justified in n2 characters
+static void f_dot_r(context_t* ctx, word_t* self) {
+  (void)self;
+
+  cell_t width = data_pop(ctx);
+  cell_t n = data_pop(ctx);
+  char buffer[34];  // 32-bit binary + sign
+  char* end = buffer + sizeof(buffer);
+
+  // Signed in decimal only, like .
+  unsigned base = current_base();
+  bool negative = base == 10 && n < 0;
+  ucell_t magnitude = negative ? 0 - (ucell_t)n : (ucell_t)n;
+
+  char* p = format_unsigned(magnitude, base, end);
+  if (negative) *--p = '-';
+
+  print_justified(p, (cell_t)(end - p), width);
+}
+
+// U.R ( u n -- )  Print u right-justified in n characters
+static void f_u_dot_r(context_t* ctx, word_t* self) {
+  (void)self;
+
+  cell_t width = data_pop(ctx);
+  ucell_t u = (ucell_t)data_pop(ctx);
+  char buffer[33];
+  char* end = buffer + sizeof(buffer);
+
+  char* p = format_unsigned(u, current_base(), end);
+  print_justified(p, (cell_t)(end - p), width);
+}
+
+void create_pictured_primitives(void) {
+  create_primitive_word("<#", f_less_number_sign);
+  create_primitive_word("#", f_number_sign);
+  create_primitive_word("#S", f_number_sign_s);
+  create_primitive_word("#>", f_number_sign_greater);
+  create_primitive_word("HOLD", f_hold);
+  create_primitive_word("HOLDS", f_holds);
+  create_primitive_word("SIGN", f_sign);
+  create_primitive_word("U.", f_u_dot);
+  create_primitive_word(".R", f_dot_r);
+  create_primitive_word("U.R", f_u_dot_r);
+
+  debug("Pictured output primitives created");
+}
@@ -6,8 +6,10 @@
 #include <string.h>
 
 #include "core.h"
+#include "dictionary.h"
 #include "forth.h"
 #include "line_editor.h"
+#include "locals.h"
 #include "stack.h"
 #include "text.h"
 
@@ -26,6 +28,11 @@ void f_quit(context_t* ctx, word_t* self) {
   if (repl_running) {
     ctx->ip = 0;
     ctx->return_stack_ptr = 0;
+    ctx->control_stack_ptr = 0;
+#ifdef FORTH_ENABLE_LOCALS
+    ctx->locals_frame = 0;
+    forget_locals();
+#endif
     *state_ptr = 0;
 
     // Jump back to REPL start
@@ -82,6 +89,22 @@ static void get_line(void) {
 
 static void get_line(void) { enhanced_get_line(input_line, INPUT_BUFFER_SIZE); }
 
+// Run word under the REPL's restart point without the REPL: QUIT, ABORT and
+// errors end it early instead of letting it run on. False if one did.
+bool repl_execute(context_t* ctx, word_t* word) {
+  bool was_running = repl_running;
+  repl_running = true;
+
+  if (setjmp(repl_restart) != 0) {
+    repl_running = was_running;
+    return false;
+  }
+
+  execute_word(ctx, word);
+  repl_running = was_running;
+  return true;
+}
+
 // Simplified REPL with setjmp for QUIT support
 void repl(void) {
   context_init(&repl_context, "REPL", false);
@@ -16,6 +16,17 @@ cell_t data_pop(context_t* ctx) {
   return ctx->data_stack[--ctx->data_stack_ptr];
 }
 
+void data_push_double(context_t* ctx, int64_t value) {
+  data_push(ctx, (cell_t)(uint32_t)value);          // low 32 bits
+  data_push(ctx, (cell_t)(uint32_t)(value >> 32));  // high 32 bits
+}
+
+int64_t data_pop_double(context_t* ctx) {
+  cell_t hi = data_pop(ctx);
+  cell_t lo = data_pop(ctx);
+  return (int64_t)(((uint64_t)(uint32_t)hi << 32) | (uint32_t)lo);
+}
+
 cell_t data_peek(context_t* ctx) {
   require(ctx, ctx->data_stack_ptr > 0, "Stack underflow");
   return ctx->data_stack[ctx->data_stack_ptr - 1];
@@ -0,0 +1,333 @@
+#include "string_words.h"
+
+#include <stddef.h>
+#include <string.h>
+
+#include "core.h"
+#include "debug.h"
+#include "dictionary.h"
+#include "error.h"
+#include "memory.h"
+#include "stack.h"
+
+#ifdef FORTH_ENABLE_STRING
+
+#if defined(__SSE2__) && defined(__GNUC__)
+#include <immintrin.h>
+#define STRING_HAVE_AVX2 1  // Built with target("avx2"), used if supported
+#endif
+
+/*
+ * Kernels
+ * =======
+ * Three byte scans do all the work:
+ *   mismatch - index of the first differing byte (COMPARE)
+ *   trim     - length without trailing spaces (-TRAILING)
+ *   search   - first occurrence of a needle (SEARCH)
+ * The vector versions compare 16 or 32 bytes at once and turn the result into
+ * a bit mask. SEARCH checks the needle's first and last bytes at every
+ * candidate position in parallel and verifies only the positions that match
+ * both, so it rarely calls memcmp on text that doesn't contain the needle.
+ */
+
+static size_t mismatch_scalar(const byte_t* a, const byte_t* b, size_t n) {
+  for (size_t i = 0; i < n; i++) {
+    if (a[i] != b[i]) return i;
+  }
+  return n;
+}
+
+static size_t trim_scalar(const byte_t* s, size_t n) {
+  while (n > 0 && s[n - 1] == ' ') n--;
+  return n;
+}
+
+// Caller guarantees 1 <= nn <= hn
+static const byte_t* search_scalar(const byte_t* h, size_t hn,
+                                   const byte_t* nd, size_t nn) {
+  for (size_t i = 0; i + nn <= hn; i++) {
+    if (h[i] == nd[0] && memcmp(h + i, nd, nn) == 0) return h + i;
+  }
+  return NULL;
+}
+
+#if defined(__SSE2__)
+
+static inline __m128i load16(const byte_t* p) {
+  return _mm_loadu_si128((const __m128i*)p);
+}
+
+static size_t mismatch_sse2(const byte_t* a, const byte_t* b, size_t n) {
+  size_t i = 0;
+  for (; i + 16 <= n; i += 16) {
+    __m128i equal = _mm_cmpeq_epi8(load16(a + i), load16(b + i));
+    unsigned diff = (unsigned)_mm_movemask_epi8(equal) ^ 0xFFFFu;
+    if (diff) return i + (size_t)__builtin_ctz(diff);
+  }
+  return i + mismatch_scalar(a + i, b + i, n - i);
+}
+
+static size_t trim_sse2(const byte_t* s, size_t n) {
+  const __m128i space = _mm_set1_epi8(' ');
+  while (n >= 16) {
+    __m128i blank = _mm_cmpeq_epi8(load16(s + n - 16), space);
+    unsigned text = (unsigned)_mm_movemask_epi8(blank) ^ 0xFFFFu;
+    if (text) return n - 16 + (size_t)(32 - __builtin_clz(text));
+    n -= 16;
+  }
+  return trim_scalar(s, n);
+}
+
+static const byte_t* search_sse2(const byte_t* h, size_t hn,
+                                 const byte_t* nd, size_t nn) {
+  const __m128i first = _mm_set1_epi8((char)nd[0]);
+  const __m128i last = _mm_set1_epi8((char)nd[nn - 1]);
+  size_t positions = hn - nn + 1;
+  size_t i = 0;
+
+  for (; i + 16 <= positions; i += 16) {
+    __m128i f = _mm_cmpeq_epi8(load16(h + i), first);
+    __m128i l = _mm_cmpeq_epi8(load16(h + i + nn - 1), last);
+    unsigned candidates = (unsigned)_mm_movemask_epi8(_mm_and_si128(f, l));
+
+    while (candidates) {
+      size_t at = i + (size_t)__builtin_ctz(candidates);
+      if (memcmp(h + at, nd, nn) == 0) return h + at;
+      candidates &= candidates - 1;
+    }
+  }
+
+  return search_scalar(h + i, hn - i, nd, nn);
+}
+
+#endif  // __SSE2__
+
+#ifdef STRING_HAVE_AVX2
+
+__attribute__((target("avx2"))) static inline __m256i load32(
+    const byte_t* p) {
+  return _mm256_loadu_si256((const __m256i*)p);
+}
+
+__attribute__((target("avx2"))) static size_t mismatch_avx2(const byte_t* a,
+                                                           const byte_t* b,
+                                                           size_t n) {
+  size_t i = 0;
+  for (; i + 32 <= n; i += 32) {
+    unsigned diff = ~(unsigned)_mm256_movemask_epi8(
+        _mm256_cmpeq_epi8(load32(a + i), load32(b + i)));
+    if (diff) return i + (size_t)__builtin_ctz(diff);
+  }
+  return i + mismatch_sse2(a + i, b + i, n - i);
+}
+
+__attribute__((target("avx2"))) static size_t trim_avx2(const byte_t* s,
+                                                       size_t n) {
+  const __m256i space = _mm256_set1_epi8(' ');
+  while (n >= 32) {
+    unsigned text = ~(unsigned)_mm256_movemask_epi8(
+        _mm256_cmpeq_epi8(load32(s + n - 32), space));
+    if (text) return n - 32 + (size_t)(32 - __builtin_clz(text));
+    n -= 32;
+  }
+  return trim_sse2(s, n);
+}
+
+__attribute__((target("avx2"))) static const byte_t* search_avx2(
+    const byte_t* h, size_t hn, const byte_t* nd, size_t nn) {
+  const __m256i first = _mm256_set1_epi8((char)nd[0]);
+  const __m256i last = _mm256_set1_epi8((char)nd[nn - 1]);
+  size_t positions = hn - nn + 1;
+  size_t i = 0;
+
+  for (; i + 32 <= positions; i += 32) {
+    __m256i f = _mm256_cmpeq_epi8(load32(h + i), first);
+    __m256i l = _mm256_cmpeq_epi8(load32(h + i + nn - 1), last);
+    unsigned candidates =
+        (unsigned)_mm256_movemask_epi8(_mm256_and_si256(f, l));
+
+    while (candidates) {
+      size_t at = i + (size_t)__builtin_ctz(candidates);
+      if (memcmp(h + at, nd, nn) == 0) return h + at;
+      candidates &= candidates - 1;
+    }
+  }
+
+  return search_sse2(h + i, hn - i, nd, nn);
+}
+
+#endif  // STRING_HAVE_AVX2
+
+// Kernels in use, chosen once by select_string_kernels()
+static size_t (*mismatch_kernel)(const byte_t*, const byte_t*,
+                                 size_t) = mismatch_scalar;
+static size_t (*trim_kernel)(const byte_t*, size_t) = trim_scalar;
+static const byte_t* (*search_kernel)(const byte_t*, size_t, const byte_t*,
+                                      size_t) = search_scalar;
+
+static void select_string_kernels(void) {
+#if defined(__SSE2__)
+  mismatch_kernel = mismatch_sse2;
+  trim_kernel = trim_sse2;
+  search_kernel = search_sse2;
+#endif
+
+#ifdef STRING_HAVE_AVX2
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2")) {
+    mismatch_kernel = mismatch_avx2;
+    trim_kernel = trim_avx2;
+    search_kernel = search_avx2;
+    debug("String kernels: AVX2");
+  }
+#endif
+}
+
+// ============================================================================
+// Forth words
+// ============================================================================
+
+// Validate a string argument once; negative lengths count as empty
+static const byte_t* string_span(context_t* ctx, forth_addr_t addr, cell_t u) {
+  return u > 0 ? addr_range_to_ptr(ctx, addr, (ucell_t)u) : NULL;
+}
+
+// COMPARE ( c-addr1 u1 c-addr2 u2 -- n )
+static void f_compare(context_t* ctx, word_t* self) {
+  (void)self;
+
+  cell_t u2 = data_pop(ctx);
+  forth_addr_t addr2 = (forth_addr_t)data_pop(ctx);
+  cell_t u1 = data_pop(ctx);
+  forth_addr_t addr1 = (forth_addr_t)data_pop(ctx);
+
+  if (u1 < 0) u1 = 0;
+  if (u2 < 0) u2 = 0;
+
+  size_t common = (size_t)(u1 < u2 ? u1 : u2);
+  const byte_t* s1 = string_span(ctx, addr1, u1);
+  const byte_t* s2 = string_span(ctx, addr2, u2);
+
+  size_t at = common > 0 && s1 && s2 ? mismatch_kernel(s1, s2, common) : common;
+
+  cell_t result;
+  if (at < common) {
+    result = s1[at] < s2[at] ? -1 : 1;
+  } else {
+    result = u1 == u2 ? 0 : (u1 < u2 ? -1 : 1);
+  }
+
+  data_push(ctx, result);
+}
+
+// SEARCH ( c-addr1 u1 c-addr2 u2 -- c-addr3 u3 flag )
+static void f_search(context_t* ctx, word_t* self) {
+  (void)self;
+
+  cell_t u2 = data_pop(ctx);
+  forth_addr_t addr2 = (forth_addr_t)data_pop(ctx);
+  cell_t u1 = data_pop(ctx);
+  forth_addr_t addr1 = (forth_addr_t)data_pop(ctx);
+
+  // An empty needle matches at the start
+  cell_t offset = u2 <= 0 ? 0 : -1;
+
+  if (u2 > 0 && u2 <= u1) {
+    const byte_t* hay = string_span(ctx, addr1, u1);
+    const byte_t* needle = string_span(ctx, addr2, u2);
+
+    if (hay && needle) {
+      const byte_t* found =
+          search_kernel(hay, (size_t)u1, needle, (size_t)u2);
+      if (found) offset = (cell_t)(found - hay);
+    }
+  }
+
+  if (offset >= 0) {
+    data_push(ctx, (cell_t)(addr1 + offset));
+    data_push(ctx, u1 - offset);
+    data_push(ctx, -1);
+  } else {
+    data_push(ctx, (cell_t)addr1);
+    data_push(ctx, u1);
+    data_push(ctx, 0);
+  }
+}
+
+// -TRAILING ( c-addr u1 -- c-addr u2 )
+static void f_dash_trailing(context_t* ctx, word_t* self) {
+  (void)self;
+
+  cell_t u = data_pop(ctx);
+  forth_addr_t addr = (forth_addr_t)data_peek(ctx);
+
+  const byte_t* s = string_span(ctx, addr, u);
+  data_push(ctx, s ? (cell_t)trim_kernel(s, (size_t)u) : 0);
+}
+
+// /STRING ( c-addr1 u1 n -- c-addr2 u2 )
+static void f_slash_string(context_t* ctx, word_t* self) {
+  (void)self;
+
+  cell_t n = data_pop(ctx);
+  cell_t u = data_pop(ctx);
+  forth_addr_t addr = (forth_addr_t)data_pop(ctx);
+
+  data_push(ctx, (cell_t)(addr + n));
+  data_push(ctx, u - n);
+}
+
+// BLANK ( c-addr u -- )
+static void f_blank(context_t* ctx, word_t* self) {
+  (void)self;
+
+  cell_t u = data_pop(ctx);
+  forth_addr_t addr = (forth_addr_t)data_pop(ctx);
+
+  if (u > 0) {
+    void* dest = addr_range_to_ptr(ctx, addr, (ucell_t)u);
+    if (dest) memset(dest, ' ', (size_t)u);
+  }
+}
+
+// SLITERAL ( c-addr u -- ) Compile a string that (S") pushes at runtime
+static void f_sliteral(context_t* ctx, word_t* self) {
+  (void)self;
+
+  if (*state_ptr == 0) {
+    error(ctx, "SLITERAL can only be used in compilation mode");
+    return;
+  }
+
+  cell_t u = data_pop(ctx);
+  forth_addr_t addr = (forth_addr_t)data_pop(ctx);
+  if (u < 0) u = 0;
+
+  // Same layout as a compiled S": (S") length characters
+  compile_word(ctx, find_word(ctx, "(S\")"));
+  compile_cell(ctx, u);
+
+  const byte_t* s = string_span(ctx, addr, u);
+  if (s) {
+    forth_addr_t dest = forth_allot(ctx, (size_t)u);
+    memmove(&forth_memory[dest], s, (size_t)u);
+  }
+  forth_align();
+
+  debug("SLITERAL compiled %d bytes", u);
+}
+
+void create_string_primitives(void) {
+  select_string_kernels();
+
+  create_primitive_word("COMPARE", f_compare);
+  create_primitive_word("SEARCH", f_search);
+  create_primitive_word("-TRAILING", f_dash_trailing);
+  create_primitive_word("/STRING", f_slash_string);
+  create_primitive_word("BLANK", f_blank);
+  create_immediate_primitive_word("SLITERAL", f_sliteral);
+
+  debug("String primitives created");
+}
+
+#endif  // FORTH_ENABLE_STRING
@@ -0,0 +1,123 @@
+#include "structure.h"
+
+#include "core.h"
+#include "debug.h"
+#include "dictionary.h"
+#include "error.h"
+#include "memory.h"
+#include "stack.h"
+#include "text.h"
+
+// Field word runtime ( addr1 -- addr2 )  Add the field offset
+void f_field_runtime(context_t* ctx, word_t* self) {
+  data_push(ctx, data_pop(ctx) + self->param.value);
+}
+
+// (+FIELD) ( addr1 -- addr2 )  Add the inline offset
+static void f_plus_field_runtime(context_t* ctx, word_t* self) {
+  (void)self;
+
+  cell_t offset = forth_fetch(ctx, ctx->ip);
+  ctx->ip += sizeof(cell_t);
+
+  data_push(ctx, data_pop(ctx) + offset);
+}
+
+// Compile a field access: the offset goes inline, and offset 0 is a no-op
+void compile_field(context_t* ctx, word_t* field) {
+  cell_t offset = field->param.value;
+  if (offset == 0) return;
+
+  compile_token(ctx, ptr_to_addr(ctx, find_word(ctx, "(+FIELD)")));
+  compile_token(ctx, (forth_addr_t)offset);
+
+  debug("Field %s compiled as (+FIELD) %d", field->name, offset);
+}
+
+// Create a field word at offset, leaving offset + size
+static void create_field(context_t* ctx, cell_t offset, cell_t size) {
+  char name_buffer[32];
+  char* name = parse_name(ctx, name_buffer, sizeof(name_buffer));
+  if (!name) {
+    error(ctx, "Missing field name");
+    return;
+  }
+
+  word_t* word = create_primitive_word(name, f_field_runtime);
+  word->param.value = offset;
+  word->param_type = PARAM_VALUE;
+
+  data_push(ctx, offset + size);
+}
+
+// BEGIN-STRUCTURE ( "<spaces>name" -- struct-sys 0 )
+// name ( -- +n ) pushes the structure size once END-STRUCTURE sets it
+static void f_begin_structure(context_t* ctx, word_t* self) {
+  (void)self;
+
+  char name_buffer[32];
+  char* name = parse_name(ctx, name_buffer, sizeof(name_buffer));
+  if (!name) {
+    error(ctx, "Missing name after 'BEGIN-STRUCTURE'");
+    return;
+  }
+
+  word_t* word = create_primitive_word(name, f_constant_runtime);
+  word->param.value = 0;
+  word->param_type = PARAM_VALUE;
+
+  data_push(ctx, (cell_t)ptr_to_addr(ctx, word));
+  data_push(ctx, 0);
+}
+
+// END-STRUCTURE ( struct-sys +n -- )
+static void f_end_structure(context_t* ctx, word_t* self) {
+  (void)self;
+
+  cell_t size = data_pop(ctx);
+  forth_addr_t xt = (forth_addr_t)data_pop(ctx);
+
+  word_t* word = addr_to_ptr(ctx, xt);
+  if (!word || word->cfunc != f_constant_runtime) {
+    error(ctx, "END-STRUCTURE without BEGIN-STRUCTURE");
+    return;
+  }
+
+  word->param.value = size;
+}
+
+// +FIELD ( n1 n2 "<spaces>name" -- n3 )
+static void f_plus_field(context_t* ctx, word_t* self) {
+  (void)self;
+
+  cell_t size = data_pop(ctx);
+  cell_t offset = data_pop(ctx);
+  create_field(ctx, offset, size);
+}
+
+// FIELD: ( n1 "<spaces>name" -- n2 )  Cell-aligned cell field
+static void f_field_colon(context_t* ctx, word_t* self) {
+  (void)self;
+
+  cell_t offset = (cell_t)align_up((ucell_t)data_pop(ctx), sizeof(cell_t));
+  create_field(ctx, offset, sizeof(cell_t));
+}
+
+// CFIELD: ( n1 "<spaces>name" -- n2 )  Character field
+static void f_cfield_colon(context_t* ctx, word_t* self) {
+  (void)self;
+
+  create_field(ctx, data_pop(ctx), 1);
+}
+
+void create_structure_primitives(void) {
+  create_operand_primitive_word("(+FIELD)", f_plus_field_runtime,
+                                WORD_FLAG_OPERAND_CELL);
+  create_primitive_word("BEGIN-STRUCTURE", f_begin_structure);
+  create_primitive_word("END-STRUCTURE", f_end_structure);
+  create_primitive_word("+FIELD", f_plus_field);
+  create_primitive_word("FIELD:", f_field_colon);
+  create_primitive_word("CFIELD:", f_cfield_colon);
+
+  debug("Structure primitives created");
+}
@@ -3,11 +3,20 @@
 #include <stdio.h>
 #include <string.h>
 
+#include "allocate.h"
+#include "aot.h"
+#include "core.h"
+#include "coverage.h"
 #include "dictionary.h"
+#include "error.h"
+#include "floating.h"
 #include "forth.h"
+#include "jit.h"
 #include "memory.h"
+#include "repl.h"
 #include "stack.h"
 #include "text.h"
+#include "verify.h"
 
 #ifdef FORTH_ENABLE_TESTS
 
@@ -44,9 +53,10 @@ test_stats_t test_stats = {0, 0, 0, NULL};
 
 // Complete system reset for test isolation
 void forth_reset(void) {
-  // Clear memory and reset HERE
+  // Clear memory and reset HERE (and the heap growing down from the top)
   here = 0;
   memset(forth_memory, 0, FORTH_MEMORY_SIZE);
+  forth_reset_high_memory();
 
   // Clear stacks
   context_init(&main_context, "MAIN", false);
@@ -59,7 +69,8 @@ void forth_reset(void) {
   // Rebuild primitive dictionary
   dictionary_init();
 
-  forth_reset_high_memory();
+  // Memory above the builtins is reused by the next test's definitions
+  coverage_forget(here);
 }
 
 // Execute Forth code and check results
@@ -198,6 +209,539 @@ static void test_division_comprehensive(void) {
   TEST_ASSERT_EQUAL(-10, 7 * q + r);  // 7 * (-1) + (-3) = -10 ✓
 }
 
+// Header address of a word, as it appears in compiled code
+static cell_t token_of(const char* name) {
+  return (cell_t)ptr_to_addr(&main_context, find_word(&main_context, name));
+}
+
+static void test_coverage_functions(void) {
+  bool was_enabled = coverage_enabled;
+
+  forth_reset();
+  coverage_enabled = true;
+  interpret_text(&main_context, ": COV-T 0= IF 1 ELSE 2 THEN ; 5 COV-T");
+  coverage_enabled = was_enabled;
+
+  word_t* word = find_word(&main_context, "COV-T");
+  TEST_ASSERT_NOT_NULL(word);
+  TEST_ASSERT_TRUE(coverage_marked(ptr_to_addr(&main_context, word)));
+  TEST_ASSERT_EQUAL(2, data_pop(&main_context));
+
+  // Body: 0= 0BRANCH else LIT 1 BRANCH then LIT 2 EXIT
+  forth_addr_t body = word->param.address;
+  forth_addr_t else_target = forth_fetch(&main_context, body + 8);
+  forth_addr_t then_target = forth_fetch(&main_context, body + 20);
+  TEST_ASSERT_TRUE(coverage_marked(else_target));   // 0BRANCH taken
+  TEST_ASSERT_TRUE(!coverage_marked(then_target));  // BRANCH never ran
+
+  // Compiled code walking skips inline operands
+  TEST_ASSERT_EQUAL(body + 4, next_token(&main_context, body));
+  TEST_ASSERT_EQUAL(body + 12, next_token(&main_context, body + 4));
+  TEST_ASSERT_EQUAL(here, definition_end(word));
+
+  // Words aren't inlined or folded away while coverage is collected, so
+  // they count when the code using them runs, and only then
+  coverage_enabled = true;
+  interpret_text(&main_context,
+                 ": COV-N SWAP DROP ; : COV-K 2 * ; "
+                 ": COV-U 5 COV-N 1+ ; : COV-V 3 COV-K 1+ ; 1 COV-U");
+  TEST_ASSERT_TRUE(!coverage_marked(token_of("COV-K")));
+  interpret_text(&main_context, "COV-V");
+
+  // A tail call marks the word it jumps into
+  interpret_text(&main_context, ": COV-J DUP DROP ; : COV-W COV-J ; 4 COV-W");
+  coverage_enabled = was_enabled;
+  TEST_ASSERT_EQUAL(4, data_pop(&main_context));
+  TEST_ASSERT_EQUAL(7, data_pop(&main_context));
+  TEST_ASSERT_EQUAL(6, data_pop(&main_context));
+  TEST_ASSERT_TRUE(coverage_marked(token_of("COV-N")));
+  TEST_ASSERT_TRUE(coverage_marked(token_of("COV-K")));
+  TEST_ASSERT_TRUE(coverage_marked(token_of("COV-J")));
+
+  forth_reset();
+}
+
+static void test_colon_frames(void) {
+  forth_reset();
+
+  // UP drops MID's return address, so its EXIT leaves MID as well
+  interpret_text(&main_context,
+                 ": UP R> DROP ; : MID UP 1 ; : TOP MID 2 ; TOP");
+  TEST_ASSERT_STACK_DEPTH(1);
+  TEST_ASSERT_EQUAL(2, data_pop(&main_context));
+
+  // Called from C, a word returns once its frame is gone, leaving ip 0
+  main_context.ip = 0;
+  execute_word(&main_context, find_word(&main_context, "TOP"));
+  TEST_ASSERT_EQUAL(2, data_pop(&main_context));
+  TEST_ASSERT_EQUAL(0, main_context.ip);
+  TEST_ASSERT_EQUAL(0, main_context.return_stack_ptr);
+
+  forth_reset();
+}
+
+static void test_inline_expansion(void) {
+  forth_reset();
+  interpret_text(&main_context,
+                 ": ADD3 3 + ; : T1 ADD3 ADD3 ; "
+                 ": ADD4 4 + ; NOINLINE : T2 ADD4 1 + ; "
+                 ": ADD5 1 + 2 + 2 + ; INLINE : T3 ADD5 ; 1 T1 1 T2 1 T3");
+  TEST_ASSERT_EQUAL(6, data_pop(&main_context));
+  TEST_ASSERT_EQUAL(6, data_pop(&main_context));
+  TEST_ASSERT_EQUAL(7, data_pop(&main_context));
+
+  // T1 is LIT 3 + LIT 3 + EXIT, with no call to ADD3 left
+  word_t* t1 = find_word(&main_context, "T1");
+  forth_addr_t body = t1->param.address;
+  TEST_ASSERT_EQUAL(token_of("LIT"), forth_fetch(&main_context, body));
+  TEST_ASSERT_EQUAL(3, forth_fetch(&main_context, body + 4));
+  TEST_ASSERT_EQUAL(token_of("EXIT"), forth_fetch(&main_context, body + 24));
+  for (forth_addr_t ip = body; ip < body + 24;
+       ip = next_token(&main_context, ip)) {
+    TEST_ASSERT_TRUE(forth_fetch(&main_context, ip) != token_of("ADD3"));
+  }
+
+  // NOINLINE keeps the call; INLINE lifts the length limit
+  word_t* t2 = find_word(&main_context, "T2");
+  TEST_ASSERT_EQUAL(token_of("ADD4"),
+                    forth_fetch(&main_context, t2->param.address));
+  word_t* t3 = find_word(&main_context, "T3");
+  TEST_ASSERT_TRUE(find_word(&main_context, "ADD5")->flags & WORD_FLAG_INLINE);
+  TEST_ASSERT_TRUE(forth_fetch(&main_context, t3->param.address) !=
+                   token_of("ADD5"));
+
+  // Return stack words are never copied into a caller
+  unsigned errors = error_count;
+  interpret_text(&main_context, ": RS >R R> ; INLINE");
+  TEST_ASSERT_EQUAL(errors + 1, error_count);
+  TEST_ASSERT_TRUE(!(find_word(&main_context, "RS")->flags & WORD_FLAG_INLINE));
+
+  forth_reset();
+}
+
+static void test_constant_folding(void) {
+  forth_reset();
+  interpret_text(&main_context,
+                 "5 CONSTANT FIVE : KB 1024 * ; "
+                 ": T1 10 CELLS BL 1+ + ; : T2 FIVE KB [ 4 8 * ] LITERAL - ; "
+                 ": T3 IF 1 ELSE 2 THEN 3 + ; : T4 1 BEGIN 2 + DUP 9 > UNTIL ; "
+                 "T1 T2 0 T3 -1 T3 T4");
+  TEST_ASSERT_EQUAL(11, data_pop(&main_context));
+  TEST_ASSERT_EQUAL(4, data_pop(&main_context));
+  TEST_ASSERT_EQUAL(5, data_pop(&main_context));
+  TEST_ASSERT_EQUAL(5088, data_pop(&main_context));
+  TEST_ASSERT_EQUAL(73, data_pop(&main_context));
+
+  // T1 and T2 are a single LIT each
+  forth_addr_t body = find_word(&main_context, "T1")->param.address;
+  TEST_ASSERT_EQUAL(token_of("LIT"), forth_fetch(&main_context, body));
+  TEST_ASSERT_EQUAL(73, forth_fetch(&main_context, body + 4));
+  TEST_ASSERT_EQUAL(token_of("EXIT"), forth_fetch(&main_context, body + 8));
+  body = find_word(&main_context, "T2")->param.address;
+  TEST_ASSERT_EQUAL(5088, forth_fetch(&main_context, body + 4));
+  TEST_ASSERT_EQUAL(token_of("EXIT"), forth_fetch(&main_context, body + 8));
+
+  // The literal after THEN is a branch target, so 3 + stays
+  body = find_word(&main_context, "T3")->param.address;
+  TEST_ASSERT_EQUAL(token_of("+"), forth_fetch(&main_context, body + 40));
+
+  // The literals a context has just compiled are its own to fold
+  context_t other;
+  context_init(&other, "OTHER", false);
+  interpret_text(&main_context, ": T5 1 2");
+  forth_addr_t end = here;
+  TEST_ASSERT_EQUAL(2, main_context.fold_pending_count);
+  TEST_ASSERT_TRUE(!compile_folded(&other, find_word(&main_context, "+")));
+  TEST_ASSERT_EQUAL(end, here);
+  interpret_text(&main_context, "+ ; T5");
+  TEST_ASSERT_EQUAL(3, data_pop(&main_context));
+  body = find_word(&main_context, "T5")->param.address;
+  TEST_ASSERT_EQUAL(3, forth_fetch(&main_context, body + 4));
+
+  forth_reset();
+}
+
+static void test_restart_point(void) {
+  forth_reset();
+
+  // The first error ends the word, as it would end a line in the REPL
+  interpret_text(&main_context, ": BAD 1 0 / 99 ; : GOOD 7 ;");
+  unsigned errors = error_count;
+  word_t* bad = find_word(&main_context, "BAD");
+  TEST_ASSERT_TRUE(!repl_execute(&main_context, bad));
+  TEST_ASSERT_EQUAL(errors + 1, error_count);
+  TEST_ASSERT_STACK_DEPTH(0);
+  TEST_ASSERT_EQUAL(0, main_context.return_stack_ptr);
+
+  word_t* good = find_word(&main_context, "GOOD");
+  TEST_ASSERT_TRUE(repl_execute(&main_context, good));
+  TEST_ASSERT_EQUAL(7, data_pop(&main_context));
+
+  forth_reset();
+}
+
+// Address of the first name token in word's body, or 0
+static forth_addr_t find_token(word_t* word, const char* name) {
+  for (forth_addr_t ip = word->param.address; ip < here;
+       ip = next_token(&main_context, ip)) {
+    if (forth_fetch(&main_context, ip) == token_of(name)) return ip;
+    if (forth_fetch(&main_context, ip) == token_of("EXIT")) break;
+  }
+  return 0;
+}
+
+static void test_stack_effects(void) {
+  forth_reset();
+  interpret_text(&main_context,
+                 ": MAC + * ; : P3 1 2 3 ; : SUM 0 10 0 DO I + LOOP ; "
+                 ": MAYBE DUP IF DUP THEN ; : PUT >R ; "
+                 "2 3 4 MAC SUM");
+  TEST_ASSERT_EQUAL(45, data_pop(&main_context));
+  TEST_ASSERT_EQUAL(14, data_pop(&main_context));
+
+  word_t* mac = find_word(&main_context, "MAC");
+  TEST_ASSERT_TRUE(mac->flags & WORD_FLAG_VERIFIED);
+  TEST_ASSERT_EQUAL(3, mac->stack_in);
+  TEST_ASSERT_EQUAL(1, mac->stack_out);
+  word_t* p3 = find_word(&main_context, "P3");
+  TEST_ASSERT_EQUAL(0, p3->stack_in);
+  TEST_ASSERT_EQUAL(3, p3->stack_peak);
+  TEST_ASSERT_TRUE(find_word(&main_context, "SUM")->flags & WORD_FLAG_VERIFIED);
+
+  // A callee's peak counts from where its inputs start, not from the
+  // caller's entry depth
+  interpret_text(&main_context,
+                 ": C8 + 1 2 3 4 5 6 7 8 [ HERE DROP ] "
+                 "DROP DROP DROP DROP DROP DROP DROP DROP ; NOINLINE "
+                 ": W8 C8 ; NOINLINE : V8 1 1 C8 DROP ;");
+  word_t* c8 = find_word(&main_context, "C8");
+  TEST_ASSERT_EQUAL(2, c8->stack_in);
+  TEST_ASSERT_EQUAL(c8->stack_peak,
+                    find_word(&main_context, "W8")->stack_peak);
+  TEST_ASSERT_EQUAL(c8->stack_peak + 2,
+                    find_word(&main_context, "V8")->stack_peak);
+
+  // W8 tail-calls C8, which then runs unchecked in OUTER's frame: it can
+  // fill the stack to the last cell, and one cell deeper OUTER is refused
+  interpret_text(&main_context, ": OUTER W8 99 ;");
+  word_t* outer = find_word(&main_context, "OUTER");
+  TEST_ASSERT_EQUAL(c8->stack_peak, outer->stack_peak);
+  while (data_depth(&main_context) < DATA_STACK_SIZE - outer->stack_peak) {
+    data_push(&main_context, 3);
+  }
+  interpret_text(&main_context, "OUTER");
+  TEST_ASSERT_EQUAL(DATA_STACK_SIZE - outer->stack_peak,
+                    data_depth(&main_context));
+  TEST_ASSERT_EQUAL(99, data_pop(&main_context));
+  TEST_ASSERT_EQUAL(6, data_pop(&main_context));
+  data_push(&main_context, 3);
+  data_push(&main_context, 3);
+  data_push(&main_context, 3);
+  TEST_ASSERT_TRUE(!execute_verified(&main_context, outer, 0));
+  main_context.data_stack_ptr = 0;
+
+  // Paths that disagree, and return stack left behind, stay unverified
+  TEST_ASSERT_TRUE(
+      !(find_word(&main_context, "MAYBE")->flags & WORD_FLAG_VERIFIED));
+  TEST_ASSERT_TRUE(
+      !(find_word(&main_context, "PUT")->flags & WORD_FLAG_VERIFIED));
+
+  // Field offsets compiled inline verify like any other primitive
+  interpret_text(&main_context,
+                 "BEGIN-STRUCTURE PT FIELD: P.X FIELD: P.Y END-STRUCTURE "
+                 ": GET-Y P.Y @ ;");
+  word_t* get_y = find_word(&main_context, "GET-Y");
+  TEST_ASSERT_TRUE(find_token(get_y, "(+FIELD)") != 0);
+  TEST_ASSERT_TRUE(get_y->flags & WORD_FLAG_VERIFIED);
+  TEST_ASSERT_EQUAL(1, get_y->stack_in);
+  TEST_ASSERT_EQUAL(1, get_y->stack_out);
+
+  // Too shallow an entry is left to the checked path
+  data_push(&main_context, 1);
+  TEST_ASSERT_TRUE(!execute_verified(&main_context, mac, 0));
+  TEST_ASSERT_EQUAL(1, data_pop(&main_context));
+
+  forth_reset();
+}
+
+static void test_case_tables(void) {
+  forth_reset();
+  interpret_text(&main_context,
+                 ": OP CASE 1 OF 10 ENDOF 2 OF 20 ENDOF 3 OF 30 ENDOF "
+                 "5 OF 50 ENDOF 0 SWAP ENDCASE ; "
+                 ": FEW CASE 1 OF 10 ENDOF 2 OF 20 ENDOF 0 SWAP ENDCASE ; "
+                 ": RUN 0 7 0 DO I OP + LOOP ;");
+
+  // Enough literal tests become a table, checked like any other branch
+  word_t* op = find_word(&main_context, "OP");
+  forth_addr_t table = find_token(op, "(SWITCH)");
+  TEST_ASSERT_TRUE(table != 0);
+  TEST_ASSERT_EQUAL(SWITCH_DENSE,
+                    forth_fetch(&main_context, table + 8 + SWITCH_KIND * 4));
+  TEST_ASSERT_EQUAL(5,
+                    forth_fetch(&main_context, table + 8 + SWITCH_COUNT * 4));
+  TEST_ASSERT_TRUE(op->flags & WORD_FLAG_VERIFIED);
+  TEST_ASSERT_EQUAL(1, op->stack_in);
+  TEST_ASSERT_EQUAL(1, op->stack_out);
+  TEST_ASSERT_EQUAL(token_of("BRANCH"),
+                    forth_fetch(&main_context, op->param.address));
+  TEST_ASSERT_EQUAL((cell_t)table,
+                    forth_fetch(&main_context, op->param.address + 4));
+
+  // Too few tests stay a chain, with nothing ahead of the first
+  word_t* few = find_word(&main_context, "FEW");
+  TEST_ASSERT_EQUAL(0, find_token(few, "(SWITCH)"));
+  TEST_ASSERT_EQUAL(token_of("LIT"),
+                    forth_fetch(&main_context, few->param.address));
+
+  interpret_text(&main_context, "RUN");
+  TEST_ASSERT_EQUAL(110, data_pop(&main_context));
+
+  forth_reset();
+}
+
+static void test_control_flow(void) {
+  forth_reset();
+
+  // Any number of LEAVEs, chained through their own operands. Each piece
+  // is a line of input; compilation carries on across them.
+  char line[64];
+  interpret_text(&main_context, ": T 0 100 0 DO");
+  for (int i = 40; i > 0; i--) {
+    snprintf(line, sizeof(line), "I %d = IF LEAVE THEN", 50 + i);
+    interpret_text(&main_context, line);
+  }
+  interpret_text(&main_context, "1+ LOOP ; T");
+  TEST_ASSERT_EQUAL(51, data_pop(&main_context));
+
+  // Nesting is bounded by the control-flow stack alone
+  interpret_text(&main_context, ": U 0");
+  for (int i = 0; i < CONTROL_STACK_SIZE; i++) {
+    interpret_text(&main_context, "1 IF");
+  }
+  interpret_text(&main_context, "1+");
+  for (int i = 0; i < CONTROL_STACK_SIZE; i++) {
+    interpret_text(&main_context, "THEN");
+  }
+  interpret_text(&main_context, "; U");
+  TEST_ASSERT_EQUAL(1, data_pop(&main_context));
+
+  // Structures must close in order, with the word that matches
+  static const char* unmatched[] = {
+      ": A 1 THEN ;",     ": B 5 0 DO IF LOOP ;", ": C IF ;",
+      ": D BEGIN UNTIL ELSE ;", ": E LEAVE ;", ": F CASE 1 ENDOF ENDCASE ;",
+  };
+  for (size_t i = 0; i < sizeof(unmatched) / sizeof(unmatched[0]); i++) {
+    unsigned errors = error_count;
+    interpret_text(&main_context, unmatched[i]);
+    TEST_ASSERT_TRUE(error_count > errors);
+    main_context.data_stack_ptr = 0;
+  }
+
+  // Nothing is left open for the next definition
+  interpret_text(&main_context, ": G 3 0 DO I 1 = IF LEAVE THEN LOOP 7 ; G");
+  TEST_ASSERT_EQUAL(7, data_pop(&main_context));
+
+  forth_reset();
+}
+
+#ifdef FORTH_ENABLE_FLOATING
+static void test_float_format(void) {
+  char out[FLOAT_FORMAT_SIZE];
+
+  float_format(-0.0, FLOAT_FIXED, out);
+  TEST_ASSERT_TRUE(strcmp(out, "-0.") == 0);
+  float_format(0.0, FLOAT_FIXED, out);
+  TEST_ASSERT_TRUE(strcmp(out, "0.") == 0);
+  float_format(-0.0, FLOAT_SCIENTIFIC, out);
+  TEST_ASSERT_TRUE(strcmp(out, "-0.E0") == 0);
+  float_format(-1.5, FLOAT_FIXED, out);
+  TEST_ASSERT_TRUE(strcmp(out, "-1.5") == 0);
+}
+
+static void test_float_stack_contexts(void) {
+  context_t other;
+  context_init(&other, "OTHER", true);
+
+  main_context.float_stack_ptr = 0;
+  float_push(&main_context, 1.5);
+  float_push(&other, 2.5);
+  float_push(&other, 3.5);
+
+  TEST_ASSERT_EQUAL(1, float_depth(&main_context));
+  TEST_ASSERT_EQUAL(2, float_depth(&other));
+  TEST_ASSERT_TRUE(float_pop(&other) == 3.5);
+  TEST_ASSERT_TRUE(float_peek(&main_context) == 1.5);
+  TEST_ASSERT_TRUE(float_pop(&main_context) == 1.5);
+  TEST_ASSERT_TRUE(float_pop(&other) == 2.5);
+  TEST_ASSERT_EQUAL(0, float_depth(&other));
+}
+#endif
+
+#ifdef FORTH_ENABLE_LOCALS
+static void test_locals_frames(void) {
+  forth_reset();
+  interpret_text(&main_context,
+                 ": IN {: a :} a 0= IF 0 EXIT THEN a ; "
+                 ": OUT {: a b :} a IN b IN + ; 0 5 OUT");
+
+  // Every frame is gone, including the one left through EXIT
+  TEST_ASSERT_EQUAL(5, data_pop(&main_context));
+  TEST_ASSERT_EQUAL(0, return_depth(&main_context));
+  TEST_ASSERT_EQUAL(0, main_context.locals_frame);
+}
+#endif
+
+#ifdef FORTH_ENABLE_ALLOCATE
+static void test_heap_merging(void) {
+  static forth_addr_t blocks[FORTH_MEMORY_SIZE / 16];
+  int count = 0;
+
+  // Fill the heap with small blocks of two sizes, then free them all
+  forth_reset();
+  forth_addr_t block;
+  while ((block = heap_allocate(count % 3 ? 20 : 100)) != 0) {
+    blocks[count++] = block;
+  }
+  TEST_ASSERT_TRUE(count > 100);
+  TEST_ASSERT_EQUAL(0, heap_allocate(4000));
+  cell_t iors = 0;
+  for (int i = 0; i < count; i++) iors |= heap_free(blocks[i]);
+  TEST_ASSERT_EQUAL(0, iors);
+
+  // The freed blocks merge back into ones large enough to reuse
+  TEST_ASSERT_TRUE(heap_stats.merges > 0);
+  block = heap_allocate(4000);
+  TEST_ASSERT_TRUE(block != 0);
+  TEST_ASSERT_EQUAL(0, heap_free(block));
+  TEST_ASSERT_EQUAL(IOR_FREE, heap_free(blocks[0]));
+
+  forth_reset();
+}
+#endif
+
+static void test_transient_contexts(void) {
+  context_t other;
+  context_init(&other, "OTHER", true);
+
+  forth_c_store(&main_context, PAD_ADDR, 'M');
+  forth_c_store(&other, PAD_ADDR, 'O');
+  TEST_ASSERT_EQUAL('M', forth_c_fetch(&main_context, PAD_ADDR));
+  TEST_ASSERT_EQUAL('O', forth_c_fetch(&other, PAD_ADDR));
+  forth_store(&main_context, WORD_BUFFER_ADDR, 1234);
+  forth_store(&other, WORD_BUFFER_ADDR, 5678);
+  TEST_ASSERT_EQUAL(1234, forth_fetch(&main_context, WORD_BUFFER_ADDR));
+  TEST_ASSERT_EQUAL(5678, forth_fetch(&other, WORD_BUFFER_ADDR));
+
+  // One block covering all regions, nothing past it
+  byte_t* pad = forth_span_ptr(&other, PAD_ADDR, TRANSIENT_SIZE);
+  TEST_ASSERT_TRUE(pad == other.pad_buffer);
+  TEST_ASSERT_TRUE(forth_span_ptr(&other, PICTURED_BUFFER_ADDR, 1) ==
+                   other.pictured_buffer);
+  TEST_ASSERT_TRUE(forth_span_ptr(&other, PAD_ADDR + 1, TRANSIENT_SIZE) ==
+                   NULL);
+  TEST_ASSERT_TRUE(forth_span_ptr(&other, PAD_ADDR + TRANSIENT_SIZE, 1) ==
+                   NULL);
+}
+
+#ifdef FORTH_ENABLE_JIT
+static void test_jit_compile(void) {
+  forth_reset();
+  interpret_text(&main_context, ": JT 0 SWAP 0 DO I + LOOP ; 10 JT");
+  TEST_ASSERT_EQUAL(45, data_pop(&main_context));
+
+  word_t* word = find_word(&main_context, "JT");
+  TEST_ASSERT_NOT_NULL(word);
+  TEST_ASSERT_TRUE(is_colon_definition(word));
+#if JIT_THRESHOLD == 0
+  TEST_ASSERT_TRUE(jit_compiled(word));
+  TEST_ASSERT_TRUE(jit_compiled(find_word(&main_context, "MAX")));
+#endif
+  TEST_ASSERT_TRUE(!jit_compiled(find_word(&main_context, "+")));
+
+  // Tokens are untouched, so tools still walk the body
+  TEST_ASSERT_EQUAL(here, definition_end(word));
+  TEST_ASSERT_EQUAL(0, return_depth(&main_context));
+
+#ifdef __linux__
+  // The code buffer is never writable and executable at once
+  FILE* maps = fopen("/proc/self/maps", "r");
+  if (maps) {
+    char line[512], perms[8];
+    bool writable_code = false;
+    while (fgets(line, sizeof(line), maps)) {
+      if (sscanf(line, "%*s %7s", perms) == 1 && perms[1] == 'w' &&
+          perms[2] == 'x') {
+        writable_code = true;
+      }
+    }
+    fclose(maps);
+    TEST_ASSERT_TRUE(!writable_code);
+  }
+#endif
+
+  forth_reset();
+}
+#endif
+
+#ifdef FORTH_ENABLE_AOT
+static void test_aot_output(void) {
+  forth_reset();
+  interpret_text(&main_context,
+                 "VARIABLE N : SQ DUP * ; NOINLINE "
+                 ": SUMSQ 0 SWAP 0 DO I SQ + LOOP ;");
+  word_t* sq = find_word(&main_context, "SQ");
+  word_t* sumsq = find_word(&main_context, "SUMSQ");
+
+  char text[8192];
+  FILE* file = tmpfile();
+  TEST_ASSERT_NOT_NULL(file);
+  if (!file) return;
+  TEST_ASSERT_TRUE(aot_write(&main_context, file, sumsq));
+  rewind(file);
+  size_t length = fread(text, 1, sizeof(text) - 1, file);
+  text[length] = '\0';
+  fclose(file);
+
+  // SQ is C with inline templates, SUMSQ calls it directly and loops with
+  // a goto
+  char expected[64];
+  snprintf(expected, sizeof(expected), "static void aot_%04x(",
+           (unsigned)ptr_to_addr(&main_context, sq));
+  TEST_ASSERT_TRUE(strstr(text, expected) != NULL);
+  snprintf(expected, sizeof(expected), "AOT_INVOKE_FN(aot_%04x,",
+           (unsigned)ptr_to_addr(&main_context, sq));
+  TEST_ASSERT_TRUE(strstr(text, expected) != NULL);
+  TEST_ASSERT_TRUE(strstr(text, "if (AOT_FITS(2, 0)) {") != NULL);
+  TEST_ASSERT_TRUE(strstr(text, "goto L") != NULL);
+  TEST_ASSERT_TRUE(strstr(text, "f_address},  /* N */") != NULL);
+
+  // Installing an image restores the words (threaded here) into a new system
+  forth_addr_t base = builtin_here;
+  forth_addr_t end = here;
+  static byte_t image[1024];
+  memcpy(image, &forth_memory[base], end - base);
+  aot_word_t words[3];
+  int count = 0;
+  for (word_t* word = dictionary_head; word != builtin_dictionary_head;
+       word = word->link) {
+    aot_word_t* saved = &words[2 - count++];
+    saved->header = ptr_to_addr(&main_context, word);
+    saved->link = ptr_to_addr(&main_context, word->link);
+    saved->cfunc = is_colon_definition(word) ? execute_colon : word->cfunc;
+  }
+  aot_program_t program = {base, end, image, words, count, 0};
+
+  forth_reset();
+  TEST_ASSERT_TRUE(aot_install(&main_context, &program));
+  interpret_text(&main_context, "4 SUMSQ 7 N ! N @");
+  TEST_ASSERT_EQUAL(7, data_pop(&main_context));
+  TEST_ASSERT_EQUAL(14, data_pop(&main_context));
+
+  forth_reset();
+}
+#endif
+
 // Main test runner
 void run_all_tests(void) {
   test_stats = (test_stats_t){0, 0, 0, NULL};
@@ -210,6 +754,31 @@ void run_all_tests(void) {
   TEST_FUNC("Dictionary Lookup", test_dictionary_functions);
   TEST_FUNC("Division Functions", test_division_functions);
   TEST_FUNC("Division Comprehensive", test_division_comprehensive);
+  TEST_FUNC("Coverage Marks", test_coverage_functions);
+  TEST_FUNC("Colon Frames", test_colon_frames);
+  TEST_FUNC("Restart Point", test_restart_point);
+  TEST_FUNC("Inline Expansion", test_inline_expansion);
+  TEST_FUNC("Constant Folding", test_constant_folding);
+  TEST_FUNC("Stack Effects", test_stack_effects);
+  TEST_FUNC("Case Tables", test_case_tables);
+  TEST_FUNC("Control Flow", test_control_flow);
+#ifdef FORTH_ENABLE_FLOATING
+  TEST_FUNC("Float Stack Contexts", test_float_stack_contexts);
+  TEST_FUNC("Float Format", test_float_format);
+#endif
+  TEST_FUNC("Transient Contexts", test_transient_contexts);
+#ifdef FORTH_ENABLE_ALLOCATE
+  TEST_FUNC("Heap Merging", test_heap_merging);
+#endif
+#ifdef FORTH_ENABLE_LOCALS
+  TEST_FUNC("Locals Frames", test_locals_frames);
+#endif
+#ifdef FORTH_ENABLE_JIT
+  TEST_FUNC("JIT Compile", test_jit_compile);
+#endif
+#ifdef FORTH_ENABLE_AOT
+  TEST_FUNC("AOT Output", test_aot_output);
+#endif
 
   // Forth code tests
   TEST_FORTH("Basic Addition", "10 20 +", 30, 1);
@@ -223,6 +792,327 @@ void run_all_tests(void) {
 
   TEST_FORTH("SM/REM Basic", "10 0 7 SM/REM", 1, 2);  // quotient on top
   TEST_FORTH("FM/MOD Basic", "10 0 7 FM/MOD", 1, 2);  // quotient on top
+  TEST_FORTH("/MOD symmetric", "-7 2 /MOD", -3, 2);
+  TEST_FORTH("MOD symmetric", "-7 2 MOD", -1, 1);
+  TEST_FORTH("*/ wide product", "1000000 1000000 3000000 */", 333333, 1);
+  TEST_FORTH("*/MOD", "7 3 2 */MOD", 10, 2);
+  // Truncated like / and MOD, whatever the signs
+  TEST_FORTH("*/ negative", "-7 1 2 */", -3, 1);
+  TEST_FORTH("*/ matches /", "-7 3 2 */ -21 2 / -", 0, 1);
+  TEST_FORTH("*/MOD negative", "-7 1 2 */MOD", -3, 2);
+  TEST_FORTH("*/MOD remainder", "7 -1 2 */MOD DROP -7 2 MOD -", 0, 1);
+  TEST_FORTH("*/MOD negative divisor", "7 3 -2 */MOD", -10, 2);
+  TEST_FORTH("UM*", "-1 2 UM*", 1, 2);  // 0x1FFFFFFFE, high cell on top
+  TEST_FORTH("UM/MOD", "0 1 2 UM/MOD", INT32_MIN, 2);
+  TEST_FORTH("UM/MOD by zero", "1 0 0 UM/MOD", 0, 2);
+  TEST_FORTH("S>D", "-5 S>D", -1, 2);
+
+  // Number conversion
+  TEST_FORTH("Hex prefix", "$ff", 255, 1);
+  TEST_FORTH("Decimal prefix", "HEX #-12 DECIMAL", -12, 1);
+  TEST_FORTH("Binary prefix", "%101", 5, 1);
+  TEST_FORTH("Character literal", "'A'", 65, 1);
+  TEST_FORTH("Unsigned single", "4294967295", -1, 1);
+  TEST_FORTH("Long decimal", "1234567890", 1234567890, 1);
+  TEST_FORTH("Double literal", "-5.", -1, 2);
+  TEST_FORTH("Compiled double literal", ": T 1234567890123. ; T", 287, 2);
+  TEST_FORTH(">NUMBER stops", "0 0 S\" 123abc\" >NUMBER", 3, 4);
+  TEST_FORTH(">NUMBER value", "0 0 S\" 1234567890\" >NUMBER 2DROP DROP",
+             1234567890, 1);
+
+  // Pictured numeric output
+  TEST_FORTH("#S zero", "0 0 <# #S #> NIP", 1, 1);
+  TEST_FORTH("#S digits", "12345 0 <# #S #> NIP", 5, 1);
+  TEST_FORTH("#S double", "-1 -1 <# #S #> NIP", 20, 1);
+  TEST_FORTH("#S hex", "HEX -1 0 <# #S #> NIP DECIMAL", 8, 1);
+  TEST_FORTH("# quotient", "1234 0 <# # DROP", 123, 1);
+  TEST_FORTH("#S leaves zero", "987 0 #S OR", 0, 1);
+  TEST_FORTH("SIGN HOLD", "42 0 <# #S -1 SIGN 36 HOLD #> NIP", 4, 1);
+  TEST_FORTH("HOLDS", "0 0 <# S\" ab\" HOLDS #S #> NIP", 3, 1);
+  TEST_FORTH("Pictured C@", "42 0 <# #S 45 HOLD #> DROP C@", 45, 1);
+  TEST_FORTH("Pictured last digit", "1234 0 <# #S #> + 1- C@", 52, 1);
+
+  // Transient regions
+  TEST_FORTH("PAD C! C@", "7 PAD 5 + C! PAD 5 + C@", 7, 1);
+  TEST_FORTH("FILL PAD", "PAD 1024 65 FILL PAD 1023 + C@", 65, 1);
+  TEST_FORTH("PAD ! @", "42 PAD ! PAD @", 42, 1);
+  TEST_FORTH("PAD 2! +! 2@", "1 2 PAD 2! 5 PAD +! PAD 2@ -", -6, 1);
+  TEST_FORTH("MOVE to PAD",
+             "HERE 1 ALLOT 9 OVER C! PAD 1 MOVE PAD C@", 9, 1);
+  TEST_FORTH("MOVE from pictured",
+             "123 0 <# #S #> PAD SWAP MOVE PAD 2 + C@", 51, 1);
+
+  // CREATE ... DOES>
+  TEST_FORTH("DOES> array",
+             ": ARRAY CREATE CELLS ALLOT DOES> SWAP CELLS + ; "
+             "4 ARRAY A 42 3 A ! 3 A @ 3 A 0 A -",
+             12, 2);
+  TEST_FORTH("DOES> constant", ": K CREATE , DOES> @ ; 7 K SEVEN SEVEN 1+", 8,
+             1);
+  TEST_FORTH("DOES> empty code", ": ADDR CREATE DOES> ; ADDR X X HERE =", -1,
+             1);
+  TEST_FORTH("DOES> with control flow",
+             ": SUMS CREATE , DOES> @ 0 SWAP 0 DO I + LOOP ; 5 SUMS S S", 10,
+             1);
+  TEST_FORTH("DOES> calling colon",
+             ": SQ DUP * ; : SQUARED CREATE , DOES> @ SQ ; 9 SQUARED N N", 81,
+             1);
+  TEST_FORTH("DOES> children independent",
+             ": K CREATE , DOES> @ ; 1 K ONE 2 K TWO ONE TWO +", 3, 1);
+
+  // Structures
+  TEST_FORTH("Structure size",
+             "BEGIN-STRUCTURE PT FIELD: P.X CFIELD: P.C FIELD: P.Y "
+             "END-STRUCTURE PT",
+             12, 1);
+  TEST_FORTH("+FIELD offsets", "0 4 +FIELD F.A 10 +FIELD F.B 100 F.B", 104,
+             2);
+  TEST_FORTH("Field interpreted",
+             "BEGIN-STRUCTURE PT FIELD: P.X FIELD: P.Y END-STRUCTURE "
+             "CREATE R PT ALLOT 7 R P.Y ! R CELL+ @",
+             7, 1);
+  TEST_FORTH("Field compiled",
+             "BEGIN-STRUCTURE PT FIELD: P.X FIELD: P.Y END-STRUCTURE "
+             "CREATE R PT ALLOT 5 R ! 6 R P.Y ! "
+             ": SUM DUP P.X @ SWAP P.Y @ + ; R SUM",
+             11, 1);
+  TEST_FORTH("Field compiles to one token",
+             "BEGIN-STRUCTURE PT FIELD: P.X FIELD: P.Y END-STRUCTURE "
+             "HERE : T P.X P.Y ; HERE SWAP - HERE : U ; HERE SWAP - -",
+             8, 1);
+
+#ifdef FORTH_ENABLE_LOCALS
+  // Locals
+  TEST_FORTH("{: order", ": T {: a b :} a b - ; 10 3 T", 7, 1);
+  TEST_FORTH("LOCALS| order", ": T LOCALS| a b | a b - ; 10 3 T", -7, 1);
+  TEST_FORTH("{: | uninitialized", ": T {: a | b :} b a + ; 5 T", 5, 1);
+  TEST_FORTH("TO local", ": T {: a | b -- c :} a 2 * TO b b a + ; 5 T", 15,
+             1);
+  TEST_FORTH("Locals in loop", ": T {: n :} 0 n 0 DO I + LOOP ; 5 T", 10, 1);
+  TEST_FORTH("Locals EXIT", ": T {: a :} a 0< IF 0 EXIT THEN a ; -3 T 4 T",
+             4, 2);
+  TEST_FORTH("Nested frames",
+             ": IN {: a b :} a b * ; : OUT {: a b :} a b IN a + b + ; 3 4 OUT",
+             19, 1);
+  TEST_FORTH("Locals shadow words", ": T {: DUP :} DUP DUP + ; 21 T", 42, 1);
+#endif
+
+#ifdef FORTH_ENABLE_DOUBLE
+  // Double-Number word set
+  TEST_FORTH("D+ carry", "-1 0 1 0 D+", 1, 2);
+  TEST_FORTH("D- borrow", "0 1 1 0 D-", 0, 2);
+  TEST_FORTH("D*", "3 0 -4 -1 D* D>S", -12, 1);
+  TEST_FORTH("DNEGATE", "5 0 DNEGATE D>S", -5, 1);
+  TEST_FORTH("D<", "-1 -1 0 0 D<", -1, 1);
+  TEST_FORTH("D=", "5 0 5 0 D=", -1, 1);
+  TEST_FORTH("M+ carry", "-1 0 1 M+ NIP", 1, 1);
+  TEST_FORTH("2CONSTANT", "1 2 2CONSTANT TWO TWO", 2, 2);
+  TEST_FORTH("2VARIABLE", "2VARIABLE DV 3 4 DV 2! DV 2@", 4, 2);
+#endif
+
+#ifdef FORTH_ENABLE_FLOATING
+  // Floating-point word set (results checked through F>S and flags)
+  TEST_FORTH("FSWAP", "1.0 2.0 FSWAP F- F>S", 1, 1);
+  TEST_FORTH("FOVER", "1.0 2.0 FOVER F+ F+ F>S", 4, 1);
+  TEST_FORTH("FROT", "1.0 2.0 3.0 FROT F>S FDROP FDROP", 1, 1);
+  TEST_FORTH("FDEPTH", "1.0 2.0 FDEPTH FDROP FDROP", 2, 1);
+  TEST_FORTH("FVARIABLE", "FVARIABLE FV 2.5 FV F! FV F@ FDUP F+ F>S", 5, 1);
+  TEST_FORTH("FCONSTANT", "3.0 FCONSTANT THREE THREE THREE F* F>S", 9, 1);
+  TEST_FORTH("FLOATS", "3 FLOATS FLOAT+", 32, 1);
+  TEST_FORTH("F<", "1.0 2.0 F<", -1, 1);
+  TEST_FORTH("F0=", "0.0 F0=", -1, 1);
+  TEST_FORTH("FMAX FMIN", "1.5 2.5 FMAX F>S 1.5 2.5 FMIN F>S", 1, 2);
+  TEST_FORTH("FLOOR", "-2.5 FLOOR F>S", -3, 1);
+  TEST_FORTH("FSQRT", "2.0 FSQRT FDUP F* 2.0 F- FABS 1.0E-12 F<", -1, 1);
+  TEST_FORTH("F**", "2.0 10.0 F** F>S", 1024, 1);
+  TEST_FORTH("FEXP FLN", "1.0 FEXP FLN FROUND F>S", 1, 1);
+  TEST_FORTH("FSIN FCOS", "0.0 FSIN F0= 0.0 FCOS F>S", 1, 2);
+  TEST_FORTH("D>F", "-1 -1 D>F F>S", -1, 1);
+  TEST_FORTH("F>D", "1.0E10 F>D", 2, 2);  // 0x2540BE400, high cell on top
+  TEST_FORTH("Compiled float literal", ": T 1.5 FDUP F+ F>S ; T", 3, 1);
+
+  // Float conversion: fast path, strtod fallback, REPRESENT and >FLOAT
+  TEST_FORTH("Float literal", "0.1 0.2 F+ 0.3 F- FABS 1.0E-15 F<", -1, 1);
+  TEST_FORTH("Long float literal",
+             "123456789012345678901234.0 1.23456789012345678E23 F/ FROUND F>S",
+             1, 1);
+  TEST_FORTH("Float literal underflow", "1.0E-400 F0=", -1, 1);
+  TEST_FORTH(">FLOAT", "S\" 1.5E3\" >FLOAT F>S", 1500, 2);
+  TEST_FORTH(">FLOAT D exponent", "S\" 15D2\" >FLOAT DROP F>S", 1500, 1);
+  TEST_FORTH(">FLOAT sign exponent", "S\" -15+2\" >FLOAT DROP F>S", -1500, 1);
+  TEST_FORTH(">FLOAT invalid", "S\" 1.5x\" >FLOAT", 0, 1);
+  TEST_FORTH(">FLOAT blanks", "HERE 3 32 FILL HERE 3 >FLOAT DROP F>S", 0, 1);
+  TEST_FORTH("REPRESENT exponent", "2.5E-3 HERE 5 REPRESENT 2DROP", -2, 1);
+  TEST_FORTH("REPRESENT rounds", "1.25 HERE 2 REPRESENT 2DROP DROP HERE 1+ C@",
+             '3', 1);
+  TEST_FORTH("REPRESENT pads", "0.5 HERE 3 REPRESENT 2DROP DROP HERE 2 + C@",
+             '0', 1);
+  TEST_FORTH("PRECISION", "PRECISION", 15, 1);
+  TEST_FORTH("-0.0E0 keeps its sign", "-0.0E0 HERE 5 REPRESENT DROP NIP", -1,
+             1);
+
+  // Float arrays (11 elements run through the vector loops and the tail)
+  TEST_FORTH("FSUM",
+             ": T 11 0 DO I S>F HERE 8 ALLOT F! LOOP ; HERE T 11 FSUM F>S", 55,
+             1);
+  TEST_FORTH("FDOT",
+             ": T 11 0 DO I S>F HERE 8 ALLOT F! LOOP ; HERE T DUP 11 FDOT F>S",
+             385, 1);
+  TEST_FORTH("FSCALE",
+             ": T 11 0 DO I S>F HERE 8 ALLOT F! LOOP ; "
+             "HERE T DUP 11 -2.0 FSCALE 10 FLOATS + F@ F>S",
+             -20, 1);
+  TEST_FORTH("FAXPY",
+             ": T 11 0 DO I S>F HERE 8 ALLOT F! LOOP ; HERE T HERE T "
+             "DUP >R 11 3.0 FAXPY R> 10 FLOATS + F@ F>S",
+             40, 1);
+  TEST_FORTH("FV+ FV*",
+             ": T 11 0 DO I S>F HERE 8 ALLOT F! LOOP ; HERE T "
+             "DUP DUP DUP 11 FV* DUP DUP DUP 11 FV+ 9 FLOATS + F@ F>S",
+             162, 1);
+  TEST_FORTH("FMATMUL",  // [1 2 3; 4 5 6] * [1 2; 3 4; 5 6] = [22 28; 49 64]
+             ": T 0 DO I 1+ S>F HERE 8 ALLOT F! LOOP ; HERE 6 T HERE 6 T "
+             "HERE 4 FLOATS ALLOT 2 3 2 FMATMUL HERE 1 FLOATS - F@ F>S",
+             64, 1);
+#endif
+
+  // Bulk memory and cell-array words
+  TEST_FORTH("CMOVE propagates",
+             "HERE 1 OVER C! DUP DUP 1+ 7 CMOVE 7 + C@", 1, 1);
+  TEST_FORTH("CMOVE> no propagation",
+             "HERE 1 OVER C! 2 OVER 1+ C! DUP DUP 1+ 1 CMOVE> 1+ C@", 1, 1);
+  TEST_FORTH("ERASE", "HERE -1 OVER ! DUP 4 ERASE @", 0, 1);
+  TEST_FORTH("CELLS-SUM", ": T 10 0 DO I 1+ , LOOP ; HERE T 10 CELLS-SUM", 55,
+             1);
+  TEST_FORTH("CELLS-MIN", ": T 9 0 DO I 5 - , LOOP ; HERE T 9 CELLS-MIN", -5,
+             1);
+  TEST_FORTH("CELLS-MAX", ": T 9 0 DO 4 I - , LOOP ; HERE T 9 CELLS-MAX", 4, 1);
+  TEST_FORTH("CELLS-DOT", ": T 6 0 DO I , LOOP ; HERE T DUP 6 CELLS-DOT", 55,
+             1);
+  TEST_FORTH("CELLS-SCALE",
+             ": T 7 0 DO I , LOOP ; HERE T DUP 7 -3 CELLS-SCALE 6 CELLS + @",
+             -18, 1);
+  TEST_FORTH("CELLS-PREFIX-SUM",
+             ": T 9 0 DO 1 , LOOP ; HERE T DUP 9 CELLS-PREFIX-SUM 8 CELLS + @",
+             9, 1);
+  TEST_FORTH("Many colon calls", ": T 0 300000 0 DO DUP DROP 1+ LOOP ; T",
+             300000, 1);
+  TEST_FORTH("Return address skip",
+             ": SKIP R> CELL+ >R ; : T SKIP DROP 5 ; 1 T +", 6, 1);
+  TEST_FORTH("LITERAL", ": T [ 6 7 * ] LITERAL ; T", 42, 1);
+  TEST_FORTH("Folded shuffle", ": T 1 2 SWAP - 3 DUP * + ; T", 10, 1);
+  TEST_FORTH("Fold after HERE", ": T 1 [ HERE DROP ] 2 + ; T", 3, 1);
+  TEST_FORTH("RECURSE", ": T DUP 1 > IF DUP 1- RECURSE * THEN ; 5 T", 120, 1);
+  TEST_FORTH("Tail recursion depth", ": T DUP IF 1- RECURSE THEN ; 100000 T",
+             0, 1);
+  TEST_FORTH("Tail call by name",
+             ": T DUP 0= IF EXIT THEN 1- T ; 50000 T", 0, 1);
+  TEST_FORTH("Tail call to another word",
+             ": T1 1+ ; NOINLINE : T2 DUP IF 2 * T1 THEN ; 5 T2 0 T2 +", 11,
+             1);
+  TEST_FORTH("No tail call into R>",
+             ": UP R> DROP ; : MID UP ; : TOP MID 99 ; TOP", 99, 1);
+  TEST_FORTH("No tail call through R>",
+             ": UP R> DROP ; : MID UP ; : MID2 MID ; : TOP MID2 98 ; TOP", 98,
+             1);
+  TEST_FORTH("CASE chain",
+             ": T CASE 1 OF 10 ENDOF 2 OF 20 ENDOF 0 SWAP ENDCASE ; "
+             "2 T 1 T + 7 T +",
+             30, 1);
+  TEST_FORTH("CASE computed OF",
+             ": T CASE 2 3 * OF 1 ENDOF 0 SWAP ENDCASE ; 7 T 10 * 6 T +", 1,
+             1);
+  TEST_FORTH("CASE runtime OF",
+             ": T CASE OVER OF 1 ENDOF 0 SWAP ENDCASE ; "
+             "5 4 T NIP 10 * 5 5 T NIP +",
+             1, 1);
+  TEST_FORTH("CASE dense table",
+             ": T CASE 0 OF 1 ENDOF 1 OF 2 ENDOF 2 OF 4 ENDOF 4 OF 8 ENDOF "
+             "1 OF 100 ENDOF DROP 16 0 ENDCASE ; "
+             "0 T 1 T + 2 T + 3 T + 4 T + 5 T + -1 T +",
+             63, 1);
+  TEST_FORTH("CASE sorted table",
+             ": T CASE 1000 OF 1 ENDOF -5 OF 2 ENDOF 77 OF 4 ENDOF "
+             "123456 OF 8 ENDOF 16 SWAP ENDCASE ; "
+             "1000 T -5 T + 77 T + 123456 T + 78 T +",
+             31, 1);
+  TEST_FORTH("Nested CASE",
+             ": T CASE 1 OF CASE 1 OF 11 ENDOF 2 OF 12 ENDOF 3 OF 13 ENDOF "
+             "4 OF 14 ENDOF 10 SWAP ENDCASE ENDOF 2 OF 20 ENDOF 0 SWAP ENDCASE ; "
+             "3 1 T 9 1 T + 2 T +",
+             43, 1);
+  TEST_FORTH("Nested loops", ": T 0 4 0 DO 3 0 DO I J * + LOOP LOOP ; T", 18,
+             1);
+  TEST_FORTH("?DO skips", ": T 0 5 5 ?DO 1+ LOOP ; T", 0, 1);
+  TEST_FORTH("?DO runs", ": T 0 5 0 ?DO I + LOOP ; T", 10, 1);
+  TEST_FORTH("?DO LEAVE",
+             ": T 0 10 0 ?DO I 5 = IF LEAVE THEN 1+ LOOP ; T", 5, 1);
+  TEST_FORTH("+LOOP step", ": T 0 10 0 DO 1+ 3 +LOOP ; T", 4, 1);
+  TEST_FORTH("+LOOP down", ": T 0 0 10 DO I + -1 +LOOP ; T", 55, 1);
+  TEST_FORTH("LOOP near the top",
+             ": T 0 2147483647 2147483640 DO 1+ LOOP ; T", 7, 1);
+  TEST_FORTH("I across zero", ": T 0 3 -3 DO I + LOOP ; T", -3, 1);
+  TEST_FORTH("Multiple WHILE",
+             ": T 0 BEGIN DUP 10 < WHILE DUP 5 <> WHILE 1+ REPEAT 100 + THEN ; "
+             "T",
+             105, 1);
+  TEST_FORTH("LEAVE in BEGIN",
+             ": T 0 100 0 DO I 50 = IF BEGIN LEAVE AGAIN THEN 1+ LOOP ; T", 50,
+             1);
+  TEST_FORTH("Ten nested DO",
+             ": T 0 2 0 DO 2 0 DO 2 0 DO 2 0 DO 2 0 DO 2 0 DO 2 0 DO 2 0 DO "
+             "2 0 DO 2 0 DO 1+ LOOP LOOP LOOP LOOP LOOP LOOP LOOP LOOP LOOP "
+             "LOOP ; T",
+             1024, 1);
+  TEST_FORTH("Compare and branch",
+             ": T 0 10 0 DO I 3 < IF 1+ THEN I 7 > 0= IF 10 + THEN LOOP ; T",
+             83, 1);
+
+#ifdef FORTH_ENABLE_STRING
+  // String word set (100-byte cases run through the vector loops)
+  TEST_FORTH("COMPARE equal", "S\" abc\" S\" abc\" COMPARE", 0, 1);
+  TEST_FORTH("COMPARE less", "S\" abc\" S\" abd\" COMPARE", -1, 1);
+  TEST_FORTH("COMPARE prefix", "S\" abcd\" S\" abc\" COMPARE", 1, 1);
+  TEST_FORTH("COMPARE long",
+             "HERE 200 97 FILL 98 HERE 150 + C! "
+             "HERE 100 HERE 100 + 100 COMPARE",
+             -1, 1);
+  TEST_FORTH("SEARCH found",
+             "S\" hello world\" S\" wor\" SEARCH >R NIP R> AND", 5, 1);
+  TEST_FORTH("SEARCH missing", "S\" hello\" S\" xyz\" SEARCH NIP NIP", 0, 1);
+  TEST_FORTH("SEARCH empty needle",
+             "S\" hello\" HERE 0 SEARCH DROP NIP", 5, 1);
+  TEST_FORTH("SEARCH long",
+             "HERE 100 97 FILL 98 HERE 70 + C! "
+             "HERE 100 HERE 70 + 1 SEARCH DROP NIP",
+             30, 1);
+  TEST_FORTH("-TRAILING", "S\" abc   \" -TRAILING NIP", 3, 1);
+  TEST_FORTH("-TRAILING long",
+             "HERE 100 BLANK 120 HERE 40 + C! HERE 100 -TRAILING NIP", 41, 1);
+  TEST_FORTH("/STRING", "S\" hello\" 2 /STRING SWAP C@", 108, 2);
+  TEST_FORTH("BLANK", "HERE 8 BLANK HERE 7 + C@", 32, 1);
+  TEST_FORTH("SLITERAL", ": T [ S\" xyz\" ] SLITERAL NIP ; T", 3, 1);
+#endif
+
+#ifdef FORTH_ENABLE_ALLOCATE
+  // Memory-Allocation word set
+  TEST_FORTH("ALLOCATE ior", "100 ALLOCATE SWAP DROP", 0, 1);
+  TEST_FORTH("FREE reuses block",
+             "20 ALLOCATE DROP DUP FREE DROP 20 ALLOCATE DROP =", -1, 1);
+  TEST_FORTH("RESIZE keeps contents",
+             "8 ALLOCATE DROP 42 OVER ! 500 RESIZE DROP @", 42, 1);
+  TEST_FORTH("FREE rejects HERE", "HERE FREE 0=", 0, 1);
+  TEST_FORTH("Double FREE", "16 ALLOCATE DROP DUP FREE DROP FREE 0=", 0, 1);
+  TEST_FORTH("ALLOCATE too large", "100000 ALLOCATE SWAP DROP 0=", 0, 1);
+  TEST_FORTH("FREE returns space to the dictionary",
+             "UNUSED 30000 ALLOCATE DROP 100 ALLOCATE DROP "
+             "SWAP FREE DROP FREE DROP UNUSED -",
+             0, 1);
+  TEST_FORTH("Dictionary stops at the heap",
+             "30000 ALLOCATE DROP CONSTANT BUF 123 BUF ! "
+             ": T UNUSED 4 / 1+ 0 DO 7 , LOOP ; T BUF @ BUF FREE +",
+             123, 1);
+#endif
 
   // Test SOURCE and >IN behavior
   test_stats.current_test_name = "Input Buffer Functions";
@@ -5,12 +5,16 @@
 #include <string.h>
 
 #include "core.h"
+#include "coverage.h"
 #include "debug.h"
 #include "dictionary.h"
 #include "error.h"
 #include "floating.h"
+#include "jit.h"
+#include "locals.h"
 #include "memory.h"
 #include "stack.h"
+#include "structure.h"
 #include "util.h"
 
 // Set the input buffer (ANS Forth compliant version)
@@ -91,47 +95,62 @@ char* parse_name(context_t* ctx, char* dest, size_t max_len) {
   return len > 0 ? dest : NULL;
 }
 
-// BASE-aware number parsing
-// Returns true if successful, false if not a number
-bool try_parse_number(const char* token, cell_t* result) {
-  if (!token || !result) return false;
+// BASE-aware number conversion (ANS 3.4.1.3): an optional #, $ or % prefix
+// selects decimal, hex or binary for this number; then an optional sign,
+// digits, and a trailing '.' for a double-cell number. 'c' is the character
+// code of c. Single-cell numbers may use the full unsigned range.
+number_kind_t parse_number(const char* token, int64_t* result) {
+  if (!token || !result) return NUMBER_NONE;
+
+  size_t length = strlen(token);
+  if (length == 3 && token[0] == '\'' && token[2] == '\'') {
+    *result = (byte_t)token[1];
+    return NUMBER_SINGLE;
+  }
 
-  cell_t base = *base_ptr;
+  unsigned base = (unsigned)*base_ptr;
   if (base < 2 || base > 36) {
     base = 10;  // Fall back to decimal for invalid base
   }
 
-  const char* ptr = token;
-  bool negative = false;
-  cell_t value = 0;
-
-  // Handle optional sign
-  if (*ptr == '-') {
-    negative = true;
-    ptr++;
-  } else if (*ptr == '+') {
-    ptr++;
+  size_t start = 0;
+  switch (token[0]) {
+    case '#':
+      base = 10;
+      start++;
+      break;
+    case '$':
+      base = 16;
+      start++;
+      break;
+    case '%':
+      base = 2;
+      start++;
+      break;
   }
 
-  // Must have at least one digit after sign
-  if (*ptr == '\0') return false;
+  bool negative = false;
+  if (token[start] == '-' || token[start] == '+') {
+    negative = token[start] == '-';
+    start++;
+  }
 
-  // Convert digits
-  while (*ptr) {
-    int digit = char_to_digit(*ptr, base);
-    if (digit < 0) return false;  // Invalid digit
+  bool is_double = length > start && token[length - 1] == '.';
+  size_t end = is_double ? length - 1 : length;
 
-    // Check for overflow before multiplying
-    if (value > (INT32_MAX - digit) / base) {
-      return false;  // Would overflow
-    }
+  // Must have at least one digit after prefix and sign
+  if (start >= end) return NUMBER_NONE;
 
-    value = value * base + digit;
-    ptr++;
-  }
+  uint64_t value = 0;
+  bool overflow = false;
+  size_t used =
+      accumulate_digits(token + start, end - start, base, &value, &overflow);
+  if (used != end - start || overflow) return NUMBER_NONE;
+  if (!is_double && value > UINT32_MAX) return NUMBER_NONE;
 
-  *result = negative ? -value : value;
-  return true;
+  if (negative) value = 0 - value;
+  *result = is_double ? (int64_t)value : (int64_t)(cell_t)(uint32_t)value;
+  return is_double ? NUMBER_DOUBLE : NUMBER_SINGLE;
 }
 
 // Helper function to set >IN (needed by parse_string)
@@ -189,12 +208,278 @@ void compile_token(context_t* ctx, forth_addr_t token) {
 
   // Align and store the token
   forth_align();
+  if (!forth_room(ctx, sizeof(cell_t))) return;
   forth_store(ctx, here, token);
   here += sizeof(cell_t);
 
   debug("Compiled token: %u at address %u", token, here - sizeof(cell_t));
 }
 
+// Words a copied body must not contain: they use the return stack, which
+// inside a caller would be the caller's frame, or run arbitrary code
+static const char* inline_barriers[] = {
+    ">R",      "R>",       "R@",         "I",       "J",   "(DO)", "UNLOOP",
+    "(DOES>)", "(LOCALS)", "(UNLOCALS)", "EXECUTE", "(TAIL)", NULL};
+
+static bool inline_safe(word_t* token) {
+  if (is_colon_definition(token) || token->cfunc == f_does_runtime ||
+      token->cfunc == f_does_inline_runtime ||
+      (token->flags & WORD_FLAG_BRANCH)) {
+    return false;
+  }
+  for (int i = 0; inline_barriers[i] != NULL; i++) {
+    if (strcmp(token->name, inline_barriers[i]) == 0) return false;
+  }
+  return true;
+}
+
+// Address of the final EXIT of a body that can be copied into a caller:
+// at most max_tokens primitives, no branches, nothing that touches the
+// return stack. 0 if the word doesn't qualify.
+forth_addr_t inline_body_end(context_t* ctx, word_t* word, int max_tokens) {
+  if (!is_colon_definition(word) || (word->flags & WORD_FLAG_NOINLINE)) {
+    return 0;
+  }
+
+  forth_addr_t ip = word->param.address;
+  for (int count = 0;; count++) {
+    if (ip + sizeof(cell_t) > here) return 0;
+    forth_addr_t xt = forth_fetch(ctx, ip);
+    if (xt > FORTH_MEMORY_SIZE - sizeof(word_t)) return 0;
+
+    word_t* token = addr_to_ptr(ctx, xt);
+    if (strcmp(token->name, "EXIT") == 0) return ip;
+    if (count == max_tokens || !inline_safe(token)) return 0;
+    ip = next_token(ctx, ip);
+  }
+}
+
+// Compile the body of word in place of a call to it, if it qualifies
+bool compile_inline(context_t* ctx, word_t* word) {
+  if (word == dictionary_head) return false;  // Still being defined
+#ifdef FORTH_ENABLE_TESTS
+  if (coverage_enabled) return false;  // The call marks word when it runs
+#endif
+
+#ifdef FORTH_ENABLE_JIT
+  // The native compiler has a better template for these
+  if (jit_has_template(word->name)) return false;
+#endif
+
+  int limit = (word->flags & WORD_FLAG_INLINE) ? INLINE_LIMIT_TOKENS
+                                               : INLINE_MAX_TOKENS;
+  forth_addr_t end = inline_body_end(ctx, word, limit);
+  if (!end) return false;
+
+  // Operands come along as they are; nothing in the body is ip-relative
+  for (forth_addr_t ip = word->param.address; ip < end; ip += sizeof(cell_t)) {
+    compile_token(ctx, forth_fetch(ctx, ip));
+  }
+
+  debug("Inlined %s (%u bytes)", word->name, end - word->param.address);
+  return true;
+}
+
+// Address of the last token compiled for word, or 0 if its body doesn't
+// decode as tokens all the way to HERE (data laid down with , for example)
+static forth_addr_t last_token(context_t* ctx, word_t* word) {
+  forth_addr_t last = 0;
+  for (forth_addr_t ip = word->param.address; ip < here;) {
+    forth_addr_t xt = forth_fetch(ctx, ip);
+    if (xt > FORTH_MEMORY_SIZE - sizeof(word_t)) return 0;
+    last = ip;
+    ip = next_token(ctx, ip);
+  }
+  return last;
+}
+
+// Words that can see past the top of the return stack, and EXECUTE, which
+// could run one of them
+static const char* return_stack_words[] = {">R", "R>", "R@", "EXECUTE", NULL};
+
+// Mark word WORD_FLAG_RETURN_STACK if its body up to end uses a return
+// stack word, calls a word marked so, or doesn't decode as tokens
+static void mark_return_stack_use(context_t* ctx, word_t* word,
+                                  forth_addr_t end) {
+  for (forth_addr_t ip = word->param.address; ip < end;
+       ip = next_token(ctx, ip)) {
+    forth_addr_t xt = forth_fetch(ctx, ip);
+    if (xt > FORTH_MEMORY_SIZE - sizeof(word_t)) {
+      word->flags |= WORD_FLAG_RETURN_STACK;
+      return;
+    }
+
+    word_t* token = addr_to_ptr(ctx, xt);
+    if (token->flags & WORD_FLAG_RETURN_STACK) {
+      word->flags |= WORD_FLAG_RETURN_STACK;
+      return;
+    }
+    for (int i = 0; return_stack_words[i] != NULL; i++) {
+      if (strcmp(token->name, return_stack_words[i]) == 0) {
+        word->flags |= WORD_FLAG_RETURN_STACK;
+        return;
+      }
+    }
+  }
+}
+
+void compile_tail_call(context_t* ctx, word_t* word) {
+  mark_return_stack_use(ctx, word, here);
+
+  forth_addr_t last = last_token(ctx, word);
+  if (!last || last + sizeof(cell_t) != here) return;
+
+  // Only threaded callees: a native one is a direct call already
+  forth_addr_t xt = forth_fetch(ctx, last);
+  word_t* callee = addr_to_ptr(ctx, xt);
+  if (callee->cfunc != execute_colon) return;
+  if (callee->flags & WORD_FLAG_RETURN_STACK) return;
+
+  // The jump takes two cells; branches to the EXIT (a THEN just before ;)
+  // move along with it
+  for (forth_addr_t ip = word->param.address; ip < last;
+       ip = next_token(ctx, ip)) {
+    word_t* token = addr_to_ptr(ctx, forth_fetch(ctx, ip));
+    if ((token->flags & WORD_FLAG_BRANCH) &&
+        (forth_addr_t)forth_fetch(ctx, ip + sizeof(cell_t)) == here) {
+      forth_store(ctx, ip + sizeof(cell_t), here + sizeof(cell_t));
+    }
+  }
+
+  // Self-recursion loops back to the start; anything else runs in our frame
+  here = last;
+  if (callee == word) {
+    compile_token(ctx, ptr_to_addr(ctx, find_word(ctx, "BRANCH")));
+    compile_token(ctx, word->param.address);
+  } else {
+    compile_token(ctx, ptr_to_addr(ctx, find_word(ctx, "(TAIL)")));
+    compile_token(ctx, xt);
+  }
+
+  debug("Tail call to %s", callee->name);
+}
+
+// Builtins without side effects, by name; a redefinition isn't one of
+// these. Division is left out so folding can't raise an error.
+static const struct {
+  const char* name;
+  int in, out;
+} pure_words[] = {
+    {"+", 2, 1},      {"-", 2, 1},      {"*", 2, 1},      {"AND", 2, 1},
+    {"OR", 2, 1},     {"XOR", 2, 1},    {"INVERT", 1, 1}, {"LSHIFT", 2, 1},
+    {"RSHIFT", 2, 1}, {"=", 2, 1},      {"<", 2, 1},      {"U<", 2, 1},
+    {"0=", 1, 1},     {"SWAP", 2, 2},   {"DROP", 1, 0},   {"ROT", 3, 3},
+    {"S>D", 1, 2},    {"M*", 2, 2},     {"UM*", 2, 2},    {"DUP", 1, 2},
+    {"OVER", 2, 3},   {"2DUP", 2, 4},   {"NIP", 2, 1},    {"TUCK", 2, 3},
+    {"2DROP", 2, 0},  {"2SWAP", 4, 4},  {"2OVER", 4, 6},  {"TRUE", 0, 1},
+    {"FALSE", 0, 1},  {"NEGATE", 1, 1}, {"1+", 1, 1},     {"1-", 1, 1},
+    {"0<", 1, 1},     {"0>", 1, 1},     {">", 2, 1},      {"NOT", 1, 1},
+    {"<>", 2, 1},     {"0<>", 1, 1},    {"<=", 2, 1},     {">=", 2, 1},
+    {"U>", 2, 1},     {"U<=", 2, 1},    {"U>=", 2, 1},    {"2*", 1, 1},
+    {"CELL+", 1, 1},  {"CELLS", 1, 1},  {"CHAR+", 1, 1},  {"CHARS", 1, 1},
+    {"BL", 0, 1},     {"ABS", 1, 1},    {"MIN", 2, 1},    {"MAX", 2, 1},
+    {"WITHIN", 3, 1}, {"SIGNUM", 1, 1},
+};
+
+#define PURE_COUNT (sizeof(pure_words) / sizeof(pure_words[0]))
+
+// Scratch stacks the folded words run on, set up afresh for each fold
+static context_t fold_context;
+
+// Data stack effect of a word that can run at compile time: a pure
+// builtin, a constant, or a colon definition of literals and such words
+static bool fold_effect(context_t* ctx, word_t* word, int* in, int* out,
+                        int nesting) {
+  if (ptr_to_addr(ctx, word) < builtin_here) {
+    for (size_t i = 0; i < PURE_COUNT; i++) {
+      if (strcmp(word->name, pure_words[i].name) == 0) {
+        *in = pure_words[i].in;
+        *out = pure_words[i].out;
+        return true;
+      }
+    }
+    return false;
+  }
+
+  if (word->cfunc == f_constant_runtime) {
+    *in = 0;
+    *out = 1;
+    return true;
+  }
+
+  if (nesting == 0 || word == dictionary_head ||
+      !is_colon_definition(word) || (word->flags & WORD_FLAG_NOINLINE)) {
+    return false;
+  }
+
+  int depth = 0, lowest = 0;
+  for (forth_addr_t ip = word->param.address;; ip = next_token(ctx, ip)) {
+    if (ip + sizeof(cell_t) > here) return false;
+    forth_addr_t xt = forth_fetch(ctx, ip);
+    if (xt > FORTH_MEMORY_SIZE - sizeof(word_t)) return false;
+
+    word_t* token = addr_to_ptr(ctx, xt);
+    if (strcmp(token->name, "EXIT") == 0) break;
+    if (strcmp(token->name, "LIT") == 0) {
+      depth++;
+      continue;
+    }
+
+    // A tail call is the callee's effect, then the EXIT after it
+    if (strcmp(token->name, "(TAIL)") == 0) {
+      token = addr_to_ptr(ctx, forth_fetch(ctx, ip + sizeof(cell_t)));
+    }
+
+    int token_in, token_out;
+    if (!fold_effect(ctx, token, &token_in, &token_out, nesting - 1)) {
+      return false;
+    }
+    depth -= token_in;
+    if (depth < lowest) lowest = depth;
+    depth += token_out;
+  }
+
+  *in = -lowest;
+  *out = depth - lowest;
+  return true;
+}
+
+// Run word now on the literals it would consume, if it is pure and they
+// were compiled just before it, and compile its results instead
+bool compile_folded(context_t* ctx, word_t* word) {
+  forth_addr_t* pending = ctx->fold_pending;
+  if (ctx->fold_pending_end != here) ctx->fold_pending_count = 0;
+#ifdef FORTH_ENABLE_TESTS
+  if (coverage_enabled) return false;  // The call marks word when it runs
+#endif
+
+  int in, out;
+  int count = ctx->fold_pending_count;
+  if (!fold_effect(ctx, word, &in, &out, FOLD_NESTING)) return false;
+  if (in > count || pending[count - in] < ctx->fold_barrier ||
+      out > FOLD_DEPTH) {
+    return false;
+  }
+
+  context_init(&fold_context, "FOLD", false);
+  for (int i = count - in; i < count; i++) {
+    data_push(&fold_context, forth_fetch(ctx, pending[i] + sizeof(cell_t)));
+  }
+  execute_word(&fold_context, word);
+  if (data_depth(&fold_context) != out) return false;
+
+  // Rewind over the consumed literals and lay down the results
+  if (in > 0) here = pending[count - in];
+  ctx->fold_pending_count = count - in;
+  ctx->fold_pending_end = here;
+  for (int i = 0; i < out; i++) {
+    compile_literal(ctx, fold_context.data_stack[i]);
+  }
+
+  debug("Folded %s: %d literals in, %d out", word->name, in, out);
+  return true;
+}
+
 // Compile a literal using LIT
 void compile_literal(context_t* ctx, cell_t value) {
   // Find LIT word address
@@ -202,9 +487,19 @@ void compile_literal(context_t* ctx, cell_t value) {
 
   debug("Found LIT word at address %u", ptr_to_addr(ctx, lit_word));
 
+  // Remember it for folding, continuing a run if it directly follows one
+  forth_addr_t* pending = ctx->fold_pending;
+  if (ctx->fold_pending_end != here) ctx->fold_pending_count = 0;
+  if (ctx->fold_pending_count == FOLD_DEPTH) {
+    memmove(pending, pending + 1, (FOLD_DEPTH - 1) * sizeof(pending[0]));
+    ctx->fold_pending_count--;
+  }
+  pending[ctx->fold_pending_count++] = here;
+
   // Compile LIT followed by the literal value
   compile_token(ctx, ptr_to_addr(ctx, lit_word));
   compile_token(ctx, (forth_addr_t)value);
+  ctx->fold_pending_end = here;
 
   debug("Compiled literal: %d", value);
 }
@@ -237,6 +532,11 @@ void interpret(context_t* ctx) {
 
     debug("  >IN=%d, parsed: '%s'", forth_fetch(ctx, to_in_addr), name);
 
+#ifdef FORTH_ENABLE_LOCALS
+    // Locals hide dictionary words of the same name while compiling
+    if (*state_ptr != 0 && compile_local(ctx, name)) continue;
+#endif
+
     // b) Search the dictionary name space
     word_t* word = search_word(name);
 
@@ -251,25 +551,50 @@ void interpret(context_t* ctx) {
         // b.1) if interpreting, perform interpretation semantics
         debug(" (interpreting), executing");
         execute_word(ctx, word);
+      } else if (word->cfunc == f_field_runtime) {
+        // Field accessors fold their offset into the definition
+        debug(" (compiling), folding field offset");
+        compile_field(ctx, word);
+      } else if (compile_folded(ctx, word)) {
+        debug(" (compiling), folded into literals");
+      } else if (compile_inline(ctx, word)) {
+        debug(" (compiling), inlined its body");
       } else {
         // b.2) if compiling, perform compilation semantics
         debug(" (compiling), compiling token");
+#ifdef FORTH_ENABLE_LOCALS
+        // An early EXIT has to drop the locals frame first
+        if (locals_active() && strcmp(word->name, "EXIT") == 0) {
+          compile_token(ctx, ptr_to_addr(ctx, find_word(ctx, "(UNLOCALS)")));
+        }
+#endif
         compile_token(ctx, ptr_to_addr(ctx, word));
       }
     } else {
       // c) Not found, attempt to convert string to number
-      cell_t number;
-      if (try_parse_number(name, &number)) {
-        debug(" -> number %d", number);
+      int64_t number;
+      number_kind_t kind = parse_number(name, &number);
+      if (kind == NUMBER_SINGLE) {
+        debug(" -> number %d", (cell_t)number);
 
         if (*state_ptr == 0) {
           // c.1) if interpreting, place number on data stack
           debug(" (interpreting), pushing to stack");
-          data_push(ctx, number);
+          data_push(ctx, (cell_t)number);
         } else {
           // c.2) if compiling, compile literal
           debug(" (compiling), compiling literal");
-          compile_literal(ctx, number);
+          compile_literal(ctx, (cell_t)number);
+        }
+      } else if (kind == NUMBER_DOUBLE) {
+        debug(" -> double number %lld", (long long)number);
+
+        if (*state_ptr == 0) {
+          data_push_double(ctx, number);
+        } else {
+          // Low cell first so the high cell ends up on top
+          compile_literal(ctx, (cell_t)(uint32_t)number);
+          compile_literal(ctx, (cell_t)(uint32_t)((uint64_t)number >> 32));
         }
       } else {
 #ifdef FORTH_ENABLE_FLOATING
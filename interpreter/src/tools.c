@@ -9,6 +9,7 @@
 #include "error.h"
 #include "memory.h"
 #include "stack.h"
+#include "structure.h"
 #include "text.h"
 #include "util.h"
 
@@ -101,6 +102,80 @@ static void f_words(context_t* ctx, word_t* self) {
   fflush(stdout);
 }
 
+// Print the tokens of a colon body (or DOES> code) up to its EXIT
+static void see_tokens(context_t* ctx, forth_addr_t ip) {
+  while (true) {
+    forth_addr_t token = forth_fetch(ctx, ip);
+    ip += sizeof(cell_t);
+
+    word_t* token_word = addr_to_ptr(ctx, token);
+
+    // Check for EXIT (end of definition)
+    if (strcmp(token_word->name, "EXIT") == 0) {
+      break;
+    }
+
+    // Handle special cases
+    if (strcmp(token_word->name, "LIT") == 0) {
+      // Next token is a literal value
+      cell_t literal = forth_fetch(ctx, ip);
+      ip += sizeof(cell_t);
+      printf("%d ", literal);
+    } else if (strcmp(token_word->name, "0BRANCH") == 0) {
+      forth_addr_t branch_addr = forth_fetch(ctx, ip);
+      ip += sizeof(cell_t);
+      printf("0BRANCH %u , ", branch_addr);
+    } else if (strcmp(token_word->name, "BRANCH") == 0) {
+      forth_addr_t branch_addr = forth_fetch(ctx, ip);
+      ip += sizeof(cell_t);
+      printf("BRANCH %u , ", branch_addr);
+    } else if (strcmp(token_word->name, "(.\")") == 0) {
+      cell_t length = forth_fetch(ctx, ip);
+      ip += sizeof(cell_t);
+      printf(".\" ");
+      for (int i = 0; i < length; i++) {
+        char ch = (char)forth_c_fetch(ctx, ip + i);
+        putchar(ch);
+      }
+      printf("\" ");
+      ip += length;
+      ip = align_up(ip, sizeof(cell_t));
+    } else if (strcmp(token_word->name, "(S\")") == 0) {
+      // Next is string length, then string data
+      cell_t length = forth_fetch(ctx, ip);
+      ip += sizeof(cell_t);
+      printf("S\" ");
+      for (int i = 0; i < length; i++) {
+        char ch = (char)forth_c_fetch(ctx, ip + i);
+        putchar(ch);
+      }
+      printf("\" ");
+      ip += length;
+      ip = align_up(ip, sizeof(cell_t));  // Align after string
+    } else if (strcmp(token_word->name, "(TAIL)") == 0) {
+      word_t* callee = addr_to_ptr(ctx, forth_fetch(ctx, ip));
+      ip += sizeof(cell_t);
+      printf("(TAIL) %s ", callee->name);
+    } else if (strcmp(token_word->name, "(SWITCH)") == 0) {
+      // Dispatch table: show how many targets it holds, then skip it
+      cell_t length = forth_fetch(ctx, ip);
+      cell_t count =
+          forth_fetch(ctx, ip + (1 + SWITCH_COUNT) * sizeof(cell_t));
+      printf("(SWITCH) %d , ", count);
+      ip = align_up(ip + sizeof(cell_t) + length, sizeof(cell_t));
+    } else if (strcmp(token_word->name, "(DOES>)") == 0) {
+      printf("DOES> ");
+    } else if (token_word->flags & WORD_FLAG_OPERAND_CELL) {
+      // Other words with one inline cell: show the cell after the name
+      printf("%s %d ", token_word->name, forth_fetch(ctx, ip));
+      ip += sizeof(cell_t);
+    } else {
+      // Regular word
+      printf("%s ", token_word->name);
+    }
+  }
+}
+
 // SEE ( "<spaces>name" -- ) Decompile word (simplified version)
 static void f_see(context_t* ctx, word_t* self) {
   (void)ctx;
@@ -122,70 +197,23 @@ static void f_see(context_t* ctx, word_t* self) {
   printf("SEE %s\n", word->name);
 
   // Identify word type and display accordingly
-  if (word->cfunc == execute_colon) {
+  if (is_colon_definition(word)) {
     // Colon definition - decompile tokens
     printf(": %s ", word->name);
 
-    forth_addr_t ip = word->param.address;
-    while (true) {
-      forth_addr_t token = forth_fetch(ctx, ip);
-      ip += sizeof(cell_t);
-
-      word_t* token_word = addr_to_ptr(ctx, token);
-
-      // Check for EXIT (end of definition)
-      if (strcmp(token_word->name, "EXIT") == 0) {
-        break;
-      }
-
-      // Handle special cases
-      if (strcmp(token_word->name, "LIT") == 0) {
-        // Next token is a literal value
-        cell_t literal = forth_fetch(ctx, ip);
-        ip += sizeof(cell_t);
-        printf("%d ", literal);
-      } else if (strcmp(token_word->name, "0BRANCH") == 0) {
-        forth_addr_t branch_addr = forth_fetch(ctx, ip);
-        ip += sizeof(cell_t);
-        printf("0BRANCH %u , ", branch_addr);
-      } else if (strcmp(token_word->name, "BRANCH") == 0) {
-        forth_addr_t branch_addr = forth_fetch(ctx, ip);
-        ip += sizeof(cell_t);
-        printf("BRANCH %u , ", branch_addr);
-      } else if (strcmp(token_word->name, "(.\")") == 0) {
-        cell_t length = forth_fetch(ctx, ip);
-        ip += sizeof(cell_t);
-        printf(".\" ");
-        for (int i = 0; i < length; i++) {
-          char ch = (char)forth_c_fetch(ctx, ip + i);
-          putchar(ch);
-        }
-        printf("\" ");
-        ip += length;
-        ip = align_up(ip, sizeof(cell_t));
-      } else if (strcmp(token_word->name, "(S\")") == 0) {
-        // Next is string length, then string data
-        cell_t length = forth_fetch(ctx, ip);
-        ip += sizeof(cell_t);
-        printf("S\" ");
-        for (int i = 0; i < length; i++) {
-          char ch = (char)forth_c_fetch(ctx, ip + i);
-          putchar(ch);
-        }
-        printf("\" ");
-        ip += length;
-        ip = align_up(ip, sizeof(cell_t));  // Align after string
-      } else {
-        // Regular word
-        printf("%s ", token_word->name);
-      }
-    }
+    see_tokens(ctx, word->param.address);
   } else if (word->cfunc == f_address) {
     printf("VARIABLE %s  \\ current value: %d", word->name, word->param.value);
   } else if (word->cfunc == f_constant_runtime) {
     printf("%d CONSTANT %s", word->param.value, word->name);
   } else if (word->cfunc == f_value_runtime) {
     printf("%d VALUE %s", word->param.value, word->name);
+  } else if (word->cfunc == f_field_runtime) {
+    printf("%d +FIELD %s", word->param.value, word->name);
+  } else if (word->param_type == PARAM_DOES) {
+    printf("CREATE %s  \\ data at address %u\nDOES> ", word->name,
+           data_field(word));
+    see_tokens(ctx, word->param.address);
   } else if (word->cfunc == f_param_field) {
     printf("CREATE %s  \\ data at address %u", word->name, word->param.address);
   } else {
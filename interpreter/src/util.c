@@ -3,6 +3,7 @@
 #include <stdbool.h>
 #include <stdint.h>
 #include <stdio.h>
+#include <string.h>
 
 #include "forth.h"
 
@@ -17,50 +18,154 @@ char digit_to_char(int digit) {
   return '?';  // Invalid digit
 }
 
+// Digit value + 1 of every character (either case), 0 for non-digits, so
+// "digit_values[c] - 1u" is a huge unsigned number for anything not a digit
+#define DIGIT_ROW(first)                                                    \
+  first + 1, first + 2, first + 3, first + 4, first + 5, first + 6,       \
+      first + 7, first + 8, first + 9, first + 10
+static const uint8_t digit_values[256] = {
+    ['0'] = DIGIT_ROW(0),
+    ['A'] = DIGIT_ROW(10), DIGIT_ROW(20), 31, 32, 33, 34, 35, 36,
+    ['a'] = DIGIT_ROW(10), DIGIT_ROW(20), 31, 32, 33, 34, 35, 36,
+};
+
 // Convert character to digit value in given base
 int char_to_digit(char c, int base) {
-  int digit = -1;
-
-  if (c >= '0' && c <= '9') {
-    digit = c - '0';
-  } else if (c >= 'A' && c <= 'Z') {
-    digit = c - 'A' + 10;
-  } else if (c >= 'a' && c <= 'z') {
-    digit = c - 'a' + 10;
+  unsigned digit = digit_values[(uint8_t)c] - 1u;
+  return digit < (unsigned)base ? (int)digit : -1;
+}
+
+// Eight ASCII digits in a little-endian word: every byte is 0x30..0x39
+static inline bool is_eight_digits(uint64_t v) {
+  return ((v & 0xF0F0F0F0F0F0F0F0u) |
+          (((v + 0x0606060606060606u) & 0xF0F0F0F0F0F0F0F0u) >> 4)) ==
+         0x3333333333333333u;
+}
+
+// Value of eight ASCII digits with three multiplies and no branches
+static inline uint32_t parse_eight_digits(uint64_t v) {
+  v -= 0x3030303030303030u;
+  v = v * 10 + (v >> 8);  // Pairs of digits
+  v = (((v & 0x000000FF000000FFu) * (100 + (1000000ull << 32))) +
+       (((v >> 16) & 0x000000FF000000FFu) * (1 + (10000ull << 32)))) >>
+      32;
+  return (uint32_t)v;
+}
+
+static inline bool host_is_little_endian(void) {
+  const uint16_t probe = 1;
+  return *(const uint8_t*)&probe == 1;
+}
+
+// Accumulate digits of base into *value, stopping at the first character
+// that is not one; returns the number of characters converted. The value
+// wraps modulo 2^64 and *overflow is set if it did.
+size_t accumulate_digits(const char* text, size_t length, unsigned base,
+                         uint64_t* value, bool* overflow) {
+  uint64_t v = *value;
+  bool wrapped = false;
+  size_t i = 0;
+
+  // Decimal fast path: eight digits per step
+  if (base == 10 && host_is_little_endian()) {
+    while (i + 8 <= length) {
+      uint64_t chunk;
+      memcpy(&chunk, text + i, sizeof(chunk));
+      if (!is_eight_digits(chunk)) break;
+
+      uint64_t scaled;
+      wrapped |= __builtin_mul_overflow(v, (uint64_t)100000000, &scaled);
+      wrapped |= __builtin_add_overflow(scaled, parse_eight_digits(chunk), &v);
+      i += 8;
+    }
+  }
+
+  for (; i < length; i++) {
+    unsigned digit = digit_values[(uint8_t)text[i]] - 1u;
+    if (digit >= base) break;
+
+    uint64_t scaled;
+    wrapped |= __builtin_mul_overflow(v, (uint64_t)base, &scaled);
+    wrapped |= __builtin_add_overflow(scaled, (uint64_t)digit, &v);
   }
 
-  return (digit >= 0 && digit < base) ? digit : -1;
+  *value = v;
+  if (wrapped) *overflow = true;
+  return i;
 }
 
-// Print number in specified base (2-36)
-void print_number_in_base(cell_t value, cell_t base) {
-  char buffer[33];  // Enough for 32-bit binary + sign + null
-  char* ptr = buffer + sizeof(buffer) - 1;
-  *ptr = '\0';
+// "00" "01" ... "99": decimal conversion emits two digits per division
+static const char digit_pairs[] =
+    "00010203040506070809101112131415161718192021222324252627282930313233343536"
+    "37383940414243444546474849505152535455565758596061626364656667686970717273"
+    "7475767778798081828384858687888990919293949596979899";
 
-  bool negative = false;
-  uint32_t uvalue;
+static char* format_unsigned32(uint32_t value, unsigned base, char* end) {
+  char* p = end;
 
-  // Handle sign for decimal output, treat as unsigned for other bases
-  if (base == 10 && value < 0) {
-    negative = true;
-    uvalue = (uint32_t)(-value);
-  } else {
-    uvalue = (uint32_t)value;
+  if (base == 10) {
+    while (value >= 100) {
+      uint32_t pair = value % 100;
+      value /= 100;
+      p -= 2;
+      memcpy(p, &digit_pairs[pair * 2], 2);
+    }
+    if (value >= 10) {
+      p -= 2;
+      memcpy(p, &digit_pairs[value * 2], 2);
+    } else {
+      *--p = (char)('0' + value);
+    }
+    return p;
   }
 
-  // Convert digits (reverse order)
   do {
-    --ptr;
-    *ptr = digit_to_char(uvalue % base);
-    uvalue /= base;
-  } while (uvalue > 0);
-
-  // Add sign if negative
-  if (negative) {
-    --ptr;
-    *ptr = '-';
+    *--p = digits[value % base];
+    value /= base;
+  } while (value > 0);
+  return p;
+}
+
+// Write the digits of value in base (2-36) so they end just before end;
+// returns the first digit. Values that fit a cell stay in 32-bit arithmetic
+// (64-bit division is a library call on the Pico).
+char* format_unsigned(uint64_t value, unsigned base, char* end) {
+  char* p = end;
+
+  while (value > UINT32_MAX) {
+    uint64_t quotient = value / base;
+    *--p = digits[value - quotient * base];
+    value = quotient;
   }
 
-  printf("%s", ptr);
+  return format_unsigned32((uint32_t)value, base, p);
+}
+
+// Print number in specified base (2-36)
+void print_number_in_base(cell_t value, cell_t base) {
+  char buffer[33];  // Enough for 32-bit binary + sign
+  char* end = buffer + sizeof(buffer);
+
+  // Handle sign for decimal output, treat as unsigned for other bases
+  bool negative = base == 10 && value < 0;
+  uint32_t uvalue = negative ? 0 - (uint32_t)value : (uint32_t)value;
+
+  char* p = format_unsigned32(uvalue, (unsigned)base, end);
+  if (negative) *--p = '-';
+
+  fwrite(p, 1, (size_t)(end - p), stdout);
+}
+
+// Print double-cell number in specified base (2-36), same sign rules as above
+void print_double_in_base(int64_t value, cell_t base) {
+  char buffer[65];  // Enough for 64-bit binary + sign
+  char* end = buffer + sizeof(buffer);
+
+  bool negative = base == 10 && value < 0;
+  uint64_t uvalue = negative ? 0 - (uint64_t)value : (uint64_t)value;
+
+  char* p = format_unsigned(uvalue, (unsigned)base, end);
+  if (negative) *--p = '-';
+
+  fwrite(p, 1, (size_t)(end - p), stdout);
 }
@@ -0,0 +1,500 @@
+#include "verify.h"
+
+#include <string.h>
+
+#include "core.h"
+#include "coverage.h"
+#include "debug.h"
+#include "dictionary.h"
+#include "memory.h"
+#include "stack.h"
+#include "structure.h"
+
+// How control leaves a token
+typedef enum {
+  FLOW_NEXT,    // Falls through
+  FLOW_JUMP,    // Goes to its branch target
+  FLOW_BRANCH,  // Either: 0BRANCH
+  FLOW_LOOP,    // Back to the target with the loop, or on without it
+  FLOW_SKIP,    // On into the loop, or to the target without it
+  FLOW_OF,      // On having dropped both, or to the target keeping one
+  FLOW_SWITCH,  // To a table target having dropped it, or to the default
+  FLOW_EXIT,    // Returns to the caller
+} flow_t;
+
+// Data stack cells taken and left, return stack cells needed (within this
+// frame) and added, and where control goes
+typedef struct {
+  int in, out;
+  int rneed, rdelta;
+  flow_t flow;
+} effect_t;
+
+// Builtins with a fixed effect, by name; a redefinition isn't one of these.
+// Colon definitions among the builtins verify themselves at ;.
+static const struct {
+  const char* name;
+  effect_t effect;
+} builtin_effects[] = {
+    {"LIT", {0, 1, 0, 0, FLOW_NEXT}},
+    {"EXIT", {0, 0, 0, 0, FLOW_EXIT}},
+    {"BRANCH", {0, 0, 0, 0, FLOW_JUMP}},
+    {"0BRANCH", {1, 0, 0, 0, FLOW_BRANCH}},
+    {"(OF)", {2, 1, 0, 0, FLOW_OF}},
+    {"(SWITCH)", {1, 1, 0, 0, FLOW_SWITCH}},
+    {"(DO)", {2, 0, 0, 2, FLOW_NEXT}},
+    {"(?DO)", {2, 0, 0, 2, FLOW_SKIP}},
+    {"(LOOP)", {0, 0, 2, -2, FLOW_LOOP}},
+    {"(+LOOP)", {1, 0, 2, -2, FLOW_LOOP}},
+    {"(LEAVE)", {0, 0, 2, -2, FLOW_JUMP}},
+    {"UNLOOP", {0, 0, 2, -2, FLOW_NEXT}},
+    {"I", {0, 1, 2, 0, FLOW_NEXT}},
+    {"J", {0, 1, 4, 0, FLOW_NEXT}},
+    {">R", {1, 0, 0, 1, FLOW_NEXT}},
+    {"R>", {0, 1, 1, -1, FLOW_NEXT}},
+    {"R@", {0, 1, 1, 0, FLOW_NEXT}},
+    {"+", {2, 1, 0, 0, FLOW_NEXT}},
+    {"-", {2, 1, 0, 0, FLOW_NEXT}},
+    {"*", {2, 1, 0, 0, FLOW_NEXT}},
+    {"/", {2, 1, 0, 0, FLOW_NEXT}},
+    {"*/", {3, 1, 0, 0, FLOW_NEXT}},
+    {"*/MOD", {3, 2, 0, 0, FLOW_NEXT}},
+    {"SM/REM", {3, 2, 0, 0, FLOW_NEXT}},
+    {"FM/MOD", {3, 2, 0, 0, FLOW_NEXT}},
+    {"UM/MOD", {3, 2, 0, 0, FLOW_NEXT}},
+    {"M*", {2, 2, 0, 0, FLOW_NEXT}},
+    {"UM*", {2, 2, 0, 0, FLOW_NEXT}},
+    {"S>D", {1, 2, 0, 0, FLOW_NEXT}},
+    {"AND", {2, 1, 0, 0, FLOW_NEXT}},
+    {"OR", {2, 1, 0, 0, FLOW_NEXT}},
+    {"XOR", {2, 1, 0, 0, FLOW_NEXT}},
+    {"INVERT", {1, 1, 0, 0, FLOW_NEXT}},
+    {"LSHIFT", {2, 1, 0, 0, FLOW_NEXT}},
+    {"RSHIFT", {2, 1, 0, 0, FLOW_NEXT}},
+    {"=", {2, 1, 0, 0, FLOW_NEXT}},
+    {"<", {2, 1, 0, 0, FLOW_NEXT}},
+    {"U<", {2, 1, 0, 0, FLOW_NEXT}},
+    {"0=", {1, 1, 0, 0, FLOW_NEXT}},
+    {"DROP", {1, 0, 0, 0, FLOW_NEXT}},
+    {"SWAP", {2, 2, 0, 0, FLOW_NEXT}},
+    {"ROT", {3, 3, 0, 0, FLOW_NEXT}},
+    {"@", {1, 1, 0, 0, FLOW_NEXT}},
+    {"!", {2, 0, 0, 0, FLOW_NEXT}},
+    {"C@", {1, 1, 0, 0, FLOW_NEXT}},
+    {"C!", {2, 0, 0, 0, FLOW_NEXT}},
+    {"HERE", {0, 1, 0, 0, FLOW_NEXT}},
+    {"ALLOT", {1, 0, 0, 0, FLOW_NEXT}},
+    {",", {1, 0, 0, 0, FLOW_NEXT}},
+    {"PAD", {0, 1, 0, 0, FLOW_NEXT}},
+    {"EMIT", {1, 0, 0, 0, FLOW_NEXT}},
+    {"KEY", {0, 1, 0, 0, FLOW_NEXT}},
+    {"TYPE", {2, 0, 0, 0, FLOW_NEXT}},
+    {".", {1, 0, 0, 0, FLOW_NEXT}},
+    {"MOVE", {3, 0, 0, 0, FLOW_NEXT}},
+    {"FILL", {3, 0, 0, 0, FLOW_NEXT}},
+    {"CMOVE", {3, 0, 0, 0, FLOW_NEXT}},
+    {"CMOVE>", {3, 0, 0, 0, FLOW_NEXT}},
+    {"ERASE", {2, 0, 0, 0, FLOW_NEXT}},
+    {"(TO)", {1, 0, 0, 0, FLOW_NEXT}},
+    {"(+FIELD)", {1, 1, 0, 0, FLOW_NEXT}},
+    {"(S\")", {0, 2, 0, 0, FLOW_NEXT}},
+    {"(.\")", {0, 0, 0, 0, FLOW_NEXT}},
+};
+
+#define EFFECT_COUNT (sizeof(builtin_effects) / sizeof(builtin_effects[0]))
+
+typedef struct {
+  forth_addr_t addr;
+  word_t* word;
+  cell_t operand;  // First inline cell
+  int target;      // Token index a branch goes to, -1 for none
+  bool landing;    // Some branch lands here
+  bool seen;       // Reached, with depth and rdepth on arrival
+  int depth, rdepth;
+} verify_token_t;
+
+static verify_token_t tokens[VERIFY_MAX_TOKENS];
+static int token_count;
+
+// Primitives execute_verified() does in place, found once the builtins exist
+typedef enum {
+  FAST_LIT,
+  FAST_EXIT,
+  FAST_BRANCH,
+  FAST_0BRANCH,
+  FAST_LOOP,
+  FAST_PLUS_LOOP,
+  FAST_I,
+  FAST_ADD,
+  FAST_SUB,
+  FAST_AND,
+  FAST_OR,
+  FAST_XOR,
+  FAST_EQ,
+  FAST_LT,
+  FAST_0EQ,
+  FAST_DROP,
+  FAST_SWAP,
+  FAST_ROT,
+  FAST_PICK,
+  FAST_COUNT
+} fast_op_t;
+
+static const char* fast_names[FAST_COUNT] = {
+    "LIT",  "EXIT", "BRANCH", "0BRANCH", "(LOOP)", "(+LOOP)", "I",
+    "+",    "-",    "AND",    "OR",      "XOR",    "=",       "<",
+    "0=",   "DROP", "SWAP",   "ROT",     "PICK",
+};
+
+static void (*fast[FAST_COUNT])(context_t* ctx, word_t* self);
+
+void verify_init(void) {
+  for (int i = 0; i < FAST_COUNT; i++) {
+    word_t* word = search_word(fast_names[i]);
+    fast[i] = word ? word->cfunc : NULL;
+  }
+}
+
+static bool is_builtin(context_t* ctx, word_t* word) {
+  // While the builtins are being defined, everything is one
+  return builtin_here == 0 || ptr_to_addr(ctx, word) < builtin_here;
+}
+
+static int token_index(forth_addr_t addr) {
+  int low = 0, high = token_count - 1;
+  while (low <= high) {
+    int mid = (low + high) / 2;
+    if (tokens[mid].addr == addr) return mid;
+    if (tokens[mid].addr < addr) {
+      low = mid + 1;
+    } else {
+      high = mid - 1;
+    }
+  }
+  return -1;
+}
+
+// Cell i of a (SWITCH) token's table
+static forth_addr_t switch_cell(context_t* ctx, verify_token_t* token, int i) {
+  return forth_fetch(ctx, token->addr + (2 + i) * sizeof(cell_t));
+}
+
+// Token index of target n of a (SWITCH), the default being target count
+static int switch_target(context_t* ctx, verify_token_t* token, int n) {
+  int count = (int)switch_cell(ctx, token, SWITCH_COUNT);
+  if (n == count) {
+    return token_index(switch_cell(ctx, token, SWITCH_DEFAULT));
+  }
+  if (switch_cell(ctx, token, SWITCH_KIND) == SWITCH_SORTED) n += count;
+  return token_index(switch_cell(ctx, token, SWITCH_HEADER + n));
+}
+
+static bool is_switch(context_t* ctx, verify_token_t* token) {
+  return strcmp(token->word->name, "(SWITCH)") == 0 &&
+         is_builtin(ctx, token->word);
+}
+
+// Split the body into tokens; every branch must land on one of them
+static bool decode_body(context_t* ctx, word_t* word) {
+  token_count = 0;
+
+  for (forth_addr_t ip = word->param.address; ip < here;) {
+    if (token_count == VERIFY_MAX_TOKENS) return false;
+    forth_addr_t xt = forth_fetch(ctx, ip);
+    if (xt > FORTH_MEMORY_SIZE - sizeof(word_t)) return false;
+    word_t* called = addr_to_ptr(ctx, xt);
+    if (called->name[sizeof(called->name) - 1] != '\0') return false;
+
+    verify_token_t* token = &tokens[token_count++];
+    token->addr = ip;
+    token->word = called;
+    token->operand = 0;
+    token->target = -1;
+    token->landing = false;
+    token->seen = false;
+
+    ip = next_token(ctx, ip);
+    if (ip > here) return false;
+    if (token->word->flags & WORD_FLAG_OPERAND_CELL) {
+      token->operand = forth_fetch(ctx, token->addr + sizeof(cell_t));
+    }
+  }
+
+  for (int i = 0; i < token_count; i++) {
+    if (!(tokens[i].word->flags & WORD_FLAG_BRANCH)) continue;
+    int target = token_index((forth_addr_t)tokens[i].operand);
+    if (target < 0) return false;
+    tokens[i].target = target;
+    tokens[target].landing = true;
+  }
+
+  for (int i = 0; i < token_count; i++) {
+    if (!is_switch(ctx, &tokens[i])) continue;
+    int count = (int)switch_cell(ctx, &tokens[i], SWITCH_COUNT);
+    for (int n = 0; n <= count; n++) {
+      int target = switch_target(ctx, &tokens[i], n);
+      if (target < 0) return false;
+      tokens[target].landing = true;
+    }
+  }
+
+  return token_count > 0;
+}
+
+// Effect of calling word, and how far above the cells it takes it reaches
+static bool call_effect(context_t* ctx, word_t* word, effect_t* effect,
+                        int* reach) {
+  *effect = (effect_t){0, 0, 0, 0, FLOW_NEXT};
+
+  if (is_colon_definition(word)) {
+    if (!(word->flags & WORD_FLAG_VERIFIED)) return false;
+    effect->in = word->stack_in;
+    effect->out = word->stack_out;
+    // Its peak counts from its entry depth, which still holds its inputs
+    *reach = word->stack_in + word->stack_peak;
+    return true;
+  }
+
+  if (word->cfunc == f_constant_runtime || word->cfunc == f_address ||
+      word->cfunc == f_value_runtime) {
+    effect->out = 1;
+  } else if (word->cfunc == f_field_runtime) {
+    effect->in = effect->out = 1;
+  } else if (!is_builtin(ctx, word)) {
+    return false;  // CREATE words among them: DOES> may still claim one
+  } else {
+    size_t i = 0;
+    while (i < EFFECT_COUNT && strcmp(word->name, builtin_effects[i].name)) i++;
+    if (i == EFFECT_COUNT) return false;
+    *effect = builtin_effects[i].effect;
+  }
+
+  *reach = effect->out > effect->in ? effect->out - effect->in : 0;
+  return true;
+}
+
+static bool token_effect(context_t* ctx, int i, effect_t* effect, int* reach) {
+  verify_token_t* token = &tokens[i];
+
+  // n PICK, with n compiled just before it, reads a known depth
+  if (strcmp(token->word->name, "PICK") == 0 &&
+      is_builtin(ctx, token->word)) {
+    if (i == 0 || token->landing || strcmp(tokens[i - 1].word->name, "LIT") ||
+        tokens[i - 1].operand < 0 || tokens[i - 1].operand > 255) {
+      return false;
+    }
+    int cells = tokens[i - 1].operand + 2;
+    *effect = (effect_t){cells, cells, 0, 0, FLOW_NEXT};
+    *reach = 0;
+    return true;
+  }
+
+  // (TAIL) is the callee followed by the EXIT it replaced. A threaded callee
+  // runs on in this word's unchecked loop, so its reach must count in ours.
+  if (strcmp(token->word->name, "(TAIL)") == 0 &&
+      is_builtin(ctx, token->word)) {
+    word_t* callee = addr_to_ptr(ctx, (forth_addr_t)token->operand);
+    if (!call_effect(ctx, callee, effect, reach)) return false;
+    effect->flow = FLOW_EXIT;
+    return true;
+  }
+
+  return call_effect(ctx, token->word, effect, reach);
+}
+
+// Arrive at token i; paths that meet must agree
+static bool arrive(int i, int depth, int rdepth, int* work, int* work_count) {
+  if (i >= token_count || rdepth < 0) return false;
+
+  verify_token_t* token = &tokens[i];
+  if (token->seen) return token->depth == depth && token->rdepth == rdepth;
+
+  token->seen = true;
+  token->depth = depth;
+  token->rdepth = rdepth;
+  work[(*work_count)++] = i;
+  return true;
+}
+
+bool verify_definition(context_t* ctx, word_t* word) {
+  static int work[VERIFY_MAX_TOKENS];
+  int work_count = 0;
+
+  if (!decode_body(ctx, word)) return false;
+
+  int lowest = 0, peak = 0, exit_depth = 0;
+  bool exits = false;
+  arrive(0, 0, 0, work, &work_count);
+
+  while (work_count > 0) {
+    int i = work[--work_count];
+    verify_token_t* token = &tokens[i];
+    int depth = token->depth, rdepth = token->rdepth;
+
+    effect_t effect;
+    int reach;
+    if (!token_effect(ctx, i, &effect, &reach)) return false;
+    if (rdepth < effect.rneed) return false;
+
+    if (depth - effect.in < lowest) lowest = depth - effect.in;
+    if (depth - effect.in + reach > peak) peak = depth - effect.in + reach;
+    if (depth > peak) peak = depth;
+    int next = depth - effect.in + effect.out;
+
+    bool ok = true;
+    switch (effect.flow) {
+      case FLOW_NEXT:
+        ok = arrive(i + 1, next, rdepth + effect.rdelta, work, &work_count);
+        break;
+      case FLOW_JUMP:
+        ok = arrive(token->target, next, rdepth + effect.rdelta, work,
+                    &work_count);
+        break;
+      case FLOW_BRANCH:
+        ok = arrive(i + 1, next, rdepth, work, &work_count) &&
+             arrive(token->target, next, rdepth, work, &work_count);
+        break;
+      case FLOW_LOOP:
+        ok = arrive(token->target, next, rdepth, work, &work_count) &&
+             arrive(i + 1, next, rdepth + effect.rdelta, work, &work_count);
+        break;
+      case FLOW_SKIP:
+        ok = arrive(i + 1, next, rdepth + effect.rdelta, work, &work_count) &&
+             arrive(token->target, next, rdepth, work, &work_count);
+        break;
+      case FLOW_OF:
+        ok = arrive(i + 1, next - 1, rdepth, work, &work_count) &&
+             arrive(token->target, next, rdepth, work, &work_count);
+        break;
+      case FLOW_SWITCH: {
+        // Holes in a dense table go to the default, which keeps the value
+        int count = (int)switch_cell(ctx, token, SWITCH_COUNT);
+        int otherwise = switch_target(ctx, token, count);
+        for (int n = 0; ok && n < count; n++) {
+          int target = switch_target(ctx, token, n);
+          if (target == otherwise) continue;
+          ok = arrive(target, next - 1, rdepth, work, &work_count);
+        }
+        ok = ok && arrive(otherwise, next, rdepth, work, &work_count);
+        break;
+      }
+      case FLOW_EXIT:
+        ok = rdepth == 0 && (!exits || next == exit_depth);
+        exits = true;
+        exit_depth = next;
+        break;
+    }
+    if (!ok) return false;
+  }
+
+  int in = -lowest, out = exit_depth - lowest;
+  if (!exits || in > 255 || out > 255 || peak > 255) return false;
+
+  word->stack_in = (uint8_t)in;
+  word->stack_out = (uint8_t)out;
+  word->stack_peak = (uint8_t)peak;
+  word->flags |= WORD_FLAG_VERIFIED;
+
+  debug("Verified %s: %d in, %d out, peak %d", word->name, in, out, peak);
+  return true;
+}
+
+bool execute_verified(context_t* ctx, word_t* word, int frame) {
+  if (!(word->flags & WORD_FLAG_VERIFIED) ||
+      ctx->data_stack_ptr < word->stack_in ||
+      ctx->data_stack_ptr > DATA_STACK_SIZE - word->stack_peak) {
+    return false;
+  }
+#ifdef FORTH_ENABLE_TESTS
+  if (coverage_enabled) return false;  // Branches mark their targets
+#endif
+
+  cell_t* ds = ctx->data_stack;
+  cell_t* rs = ctx->return_stack;
+
+  while (ctx->return_stack_ptr > frame) {
+    forth_addr_t ip = ctx->ip;
+    word_t* token = addr_to_ptr(NULL, forth_fetch(ctx, ip));
+    void (*cfunc)(context_t* ctx, word_t* self) = token->cfunc;
+    int sp = ctx->data_stack_ptr;
+    int rsp = ctx->return_stack_ptr;
+    ip += sizeof(cell_t);
+
+    if (cfunc == fast[FAST_LIT]) {
+      ds[sp++] = forth_fetch(ctx, ip);
+      ip += sizeof(cell_t);
+    } else if (cfunc == fast[FAST_0BRANCH]) {
+      ip = ds[--sp] ? ip + sizeof(cell_t) : (forth_addr_t)forth_fetch(ctx, ip);
+    } else if (cfunc == fast[FAST_BRANCH]) {
+      ip = (forth_addr_t)forth_fetch(ctx, ip);
+    } else if (cfunc == fast[FAST_EXIT]) {
+      ip = (forth_addr_t)rs[--ctx->return_stack_ptr];
+    } else if (cfunc == fast[FAST_LOOP]) {
+      if (rs[rsp - 1] == INT32_MAX) {  // Biased index overflows: done
+        ctx->return_stack_ptr = rsp - 2;
+        ip += sizeof(cell_t);
+      } else {
+        rs[rsp - 1]++;
+        ip = (forth_addr_t)forth_fetch(ctx, ip);
+      }
+    } else if (cfunc == fast[FAST_PLUS_LOOP]) {
+      cell_t step = ds[--sp];
+      cell_t index = (cell_t)((ucell_t)rs[rsp - 1] + (ucell_t)step);
+      if (((rs[rsp - 1] ^ index) & (step ^ index)) < 0) {
+        ctx->return_stack_ptr = rsp - 2;
+        ip += sizeof(cell_t);
+      } else {
+        rs[rsp - 1] = index;
+        ip = (forth_addr_t)forth_fetch(ctx, ip);
+      }
+    } else if (cfunc == fast[FAST_I]) {
+      ds[sp++] = (cell_t)((ucell_t)rs[rsp - 1] + (ucell_t)rs[rsp - 2]);
+    } else if (cfunc == fast[FAST_ADD]) {
+      ds[sp - 2] = (cell_t)((ucell_t)ds[sp - 2] + (ucell_t)ds[sp - 1]);
+      sp--;
+    } else if (cfunc == fast[FAST_SUB]) {
+      ds[sp - 2] = (cell_t)((ucell_t)ds[sp - 2] - (ucell_t)ds[sp - 1]);
+      sp--;
+    } else if (cfunc == fast[FAST_AND]) {
+      ds[sp - 2] &= ds[sp - 1];
+      sp--;
+    } else if (cfunc == fast[FAST_OR]) {
+      ds[sp - 2] |= ds[sp - 1];
+      sp--;
+    } else if (cfunc == fast[FAST_XOR]) {
+      ds[sp - 2] ^= ds[sp - 1];
+      sp--;
+    } else if (cfunc == fast[FAST_EQ]) {
+      ds[sp - 2] = ds[sp - 2] == ds[sp - 1] ? -1 : 0;
+      sp--;
+    } else if (cfunc == fast[FAST_LT]) {
+      ds[sp - 2] = ds[sp - 2] < ds[sp - 1] ? -1 : 0;
+      sp--;
+    } else if (cfunc == fast[FAST_0EQ]) {
+      ds[sp - 1] = ds[sp - 1] == 0 ? -1 : 0;
+    } else if (cfunc == fast[FAST_DROP]) {
+      sp--;
+    } else if (cfunc == fast[FAST_SWAP]) {
+      cell_t top = ds[sp - 1];
+      ds[sp - 1] = ds[sp - 2];
+      ds[sp - 2] = top;
+    } else if (cfunc == fast[FAST_ROT]) {
+      cell_t first = ds[sp - 3];
+      ds[sp - 3] = ds[sp - 2];
+      ds[sp - 2] = ds[sp - 1];
+      ds[sp - 1] = first;
+    } else if (cfunc == fast[FAST_PICK]) {
+      ds[sp - 1] = ds[sp - 2 - ds[sp - 1]];
+    } else {
+      // Everything else checks for itself
+      ctx->ip = ip;
+      execute_word(ctx, token);
+      continue;
+    }
+
+    ctx->data_stack_ptr = sp;
+    ctx->ip = ip;
+  }
+
+  return true;
+}
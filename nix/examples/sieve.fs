@@ -0,0 +1,31 @@
+\ Sieve of Eratosthenes, built into kisforth-sieve by kisforth-aot.
+\ MAIN counts the primes below SIZE and prints them with a checksum.
+
+8190 CONSTANT SIZE
+CREATE FLAGS SIZE ALLOT
+VARIABLE CHECKSUM
+
+\ COUNTER ( n "name" -- )  name: ( x -- x+n )
+: COUNTER CREATE , DOES> @ + ;
+10 COUNTER TEN+
+
+: CLEAR-FLAGS SIZE 0 DO 1 FLAGS I + C! LOOP ;
+
+\ STRIKE ( step start -- )  Clear every step-th flag from start
+: STRIKE
+  BEGIN DUP SIZE < WHILE 0 OVER FLAGS + C! OVER + REPEAT 2DROP ;
+
+\ PRIMES ( -- n )
+: PRIMES
+  CLEAR-FLAGS 0 CHECKSUM !
+  0 SIZE 2 DO
+    FLAGS I + C@ IF
+      I CHECKSUM @ + CHECKSUM !
+      I DUP DUP + STRIKE 1+
+    THEN
+  LOOP ;
+
+: MAIN
+  PRIMES . ." primes below " SIZE . CR
+  ." checksum " CHECKSUM @ . CR
+  ." 32 TEN+ = " 32 TEN+ . CR ;
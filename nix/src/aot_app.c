@@ -0,0 +1,29 @@
+#include <stdio.h>
+
+#include "aot.h"
+#include "dictionary.h"
+#include "error.h"
+#include "forth.h"
+#include "repl.h"
+#include "startup.h"
+
+// Startup for applications built by kisforth_add_aot_app(): rebuild the
+// builtins, restore the compiled program, then run its entry word (or the
+// REPL when it has none). The first error ends the entry word and the app.
+
+int main(void) {
+  forth_system_init();
+
+  if (!aot_install(&main_context, &aot_program)) return 1;
+
+  if (aot_program.entry) {
+    bool finished = repl_execute(&main_context, AOT_W(aot_program.entry));
+    fflush(stdout);
+    if (!finished) return 1;
+  } else {
+    print_startup_banner("Compiled Application");
+    repl();
+  }
+
+  return error_count > 0 ? 1 : 0;
+}
@@ -0,0 +1,88 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "aot.h"
+#include "core.h"
+#include "dictionary.h"
+#include "error.h"
+#include "forth.h"
+#include "memory.h"
+#include "startup.h"
+#include "text.h"
+
+// kisforth-aot [-e word] input.fs output.c
+//
+// Loads a Forth source file into a fresh system, then writes the words it
+// defined as C (see aot.h). With -e the application runs that word at
+// startup; otherwise it starts the REPL.
+
+static int usage(const char* program) {
+  fprintf(stderr, "usage: %s [-e word] input.fs output.c\n", program);
+  return 2;
+}
+
+int main(int argc, char* argv[]) {
+  const char* entry_name = NULL;
+  int arg = 1;
+
+  if (argc > 2 && strcmp(argv[1], "-e") == 0) {
+    entry_name = argv[2];
+    arg = 3;
+  }
+  if (argc - arg != 2) return usage(argv[0]);
+
+  FILE* in = fopen(argv[arg], "r");
+  if (!in) {
+    perror(argv[arg]);
+    return 1;
+  }
+
+  forth_system_init();
+
+  char line[INPUT_BUFFER_SIZE];
+  int line_number = 0;
+  while (fgets(line, sizeof(line), in)) {
+    line_number++;
+    size_t length = strcspn(line, "\r\n");
+    if (line[length] == '\0' && !feof(in)) {
+      fprintf(stderr, "%s:%d: line too long\n", argv[arg], line_number);
+      fclose(in);
+      return 1;
+    }
+    line[length] = '\0';
+    interpret_text(&main_context, line);
+  }
+  fclose(in);
+
+  if (error_count > 0) {
+    fprintf(stderr, "%s: %u error(s) while loading\n", argv[arg], error_count);
+    return 1;
+  }
+  if (*state_ptr != 0) {
+    fprintf(stderr, "%s: unterminated definition\n", argv[arg]);
+    return 1;
+  }
+
+  word_t* entry = NULL;
+  if (entry_name) {
+    entry = search_word(entry_name);
+    if (!entry) {
+      fprintf(stderr, "%s: entry word %s not found\n", argv[arg], entry_name);
+      return 1;
+    }
+  }
+
+  FILE* out = fopen(argv[arg + 1], "w");
+  if (!out) {
+    perror(argv[arg + 1]);
+    return 1;
+  }
+  bool ok = aot_write(&main_context, out, entry);
+  ok = fclose(out) == 0 && ok;
+  if (!ok) {
+    remove(argv[arg + 1]);
+    return 1;
+  }
+
+  return 0;
+}
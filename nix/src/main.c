@@ -13,6 +13,13 @@ int main(int argc, char* argv[]) {
     word_t* test_word = find_word(NULL, "TEST");
     printf("Running tests...\n\n");
     execute_word(&main_context, test_word);
+  } else if (argc > 1 && strcmp(argv[1], "coverage") == 0) {
+    word_t* coverage_word = find_word(NULL, "TEST-COVERAGE");
+    printf("Running tests with coverage...\n\n");
+    execute_word(&main_context, coverage_word);
+  } else if (argc > 1 && strcmp(argv[1], "bench") == 0) {
+    word_t* bench_word = find_word(NULL, "BENCH");
+    execute_word(&main_context, bench_word);
   } else {
     print_startup_banner("Nix Development");
     repl();
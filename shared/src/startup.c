@@ -4,7 +4,6 @@
 
 #include "debug.h"
 #include "dictionary.h"
-#include "floating.h"
 #include "memory.h"
 #include "version.h"
 
@@ -16,10 +15,6 @@ void forth_system_init(void) {
   debug_init();
 #endif
 
-#ifdef FORTH_ENABLE_FLOATING
-  float_stack_init();
-#endif
-
   input_system_init();
   dictionary_init();
 }
@@ -57,6 +52,24 @@ void print_extensions_list(void) {
   printf(" [TOOLS]");
 #endif
 
+#ifdef FORTH_ENABLE_ALLOCATE
+  printf(" [ALLOC]");
+#endif
+
+#ifdef FORTH_ENABLE_STRING
+  printf(" [STRING]");
+#endif
+
+#ifdef FORTH_ENABLE_DOUBLE
+  printf(" [DOUBLE]");
+#endif
+
+#if defined(JIT_SUBROUTINE_THREADED)
+  printf(" [STC]");
+#elif defined(FORTH_ENABLE_JIT)
+  printf(" [JIT]");
+#endif
+
 #ifdef FORTH_ENABLE_TESTS
   printf(" [TESTS]");
 #endif